@@ -0,0 +1,377 @@
+/**
+* @file adc_dma.c
+*
+* @brief Continuous (DMA) ADC acquisition. The ADC digital controller converts the configured channels
+*        back to back and the DMA fills the driver's pool; a reader task parses the conversion results into
+*        two ping-pong frame buffers which are handed to the consumer one complete frame at a time.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "adc_dma.h"
+#include <string.h>
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+//---------------------------------- MACROS -----------------------------------
+#define TAG "ADC DMA"
+
+#define ADC_DMA_READ_LEN        (256U)   // Bytes read from the driver pool at once
+#define ADC_DMA_POOL_SIZE       (4096U)  // Bytes of the driver's internal DMA result pool
+#define ADC_DMA_BUFFER_COUNT    (2U)
+#define ADC_DMA_NO_SLOT         (0xFFU)
+
+#define ADC_DMA_TASK_STACK_SIZE (3 * 1024)
+#define ADC_DMA_TASK_PRIORITY   (10U)
+#define ADC_DMA_TASK_CORE       (0)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Reader task. Waits for the conversion done notification and drains the driver pool.
+ *
+ * @param[in] pvParameters Unused parameter for task creation.
+ */
+static void _adc_dma_task(void *pvParameters);
+
+/**
+ * @brief Parses raw conversion results into the buffer currently being filled.
+ *
+ * Results are placed by their channel field, so a lost conversion only costs the scan it belonged to.
+ *
+ * @param[in] result Raw conversion results read from the driver.
+ * @param[in] length Length of `result` in bytes.
+ */
+static void _adc_dma_parse(const uint8_t *result, uint32_t length);
+
+/**
+ * @brief Converts the filled buffer to millivolts and hands it to the consumer if the other buffer is free.
+ *        Otherwise the frame is dropped and the same buffer is filled again.
+ */
+static void _adc_dma_frame_complete(void);
+
+/**
+ * @brief Conversion done callback, called from ISR context by the continuous driver.
+ */
+static bool IRAM_ATTR _adc_dma_conv_done_cb(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                            void *user_data);
+
+/**
+ * @brief Pool overflow callback, called from ISR context by the continuous driver.
+ */
+static bool IRAM_ATTR _adc_dma_pool_ovf_cb(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                           void *user_data);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static adc_continuous_handle_t adc_dma_handle = NULL;
+static TaskHandle_t adc_dma_task_handle = NULL;
+static QueueHandle_t adc_dma_frame_queue = NULL;
+
+static adc_dma_config_t adc_dma_config;
+static uint8_t channel_to_slot[ADC_DMA_MAX_CHANNELS];
+
+static uint16_t frame_buffer[ADC_DMA_BUFFER_COUNT][ADC_DMA_MAX_FRAME_SAMPLES];
+static volatile bool buffer_taken[ADC_DMA_BUFFER_COUNT] = {false, false};
+static uint64_t buffer_first_scan[ADC_DMA_BUFFER_COUNT];
+static uint32_t fill_buffer = 0;
+static uint32_t fill_scan = 0;
+static uint32_t fill_slot = 0;
+static uint64_t scan_counter = 0;
+static int32_t taken_buffer = -1;
+
+static adc_dma_stats_t adc_dma_stats;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+adc_err_t adc_dma_init(const adc_dma_config_t *config)
+{
+    if((NULL == config) || (0 == config->channel_count) || (ADC_DMA_MAX_CHANNELS < config->channel_count) ||
+       (0 == config->frame_scans) || (ADC_DMA_MAX_FRAME_SAMPLES < config->frame_scans * config->channel_count))
+    {
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    uint32_t sample_freq_hz = config->scan_rate_hz * config->channel_count;
+    if((SOC_ADC_SAMPLE_FREQ_THRES_LOW > sample_freq_hz) || (SOC_ADC_SAMPLE_FREQ_THRES_HIGH < sample_freq_hz))
+    {
+        ESP_LOGE(TAG, "Sample rate %d Hz is out of range!", (int)sample_freq_hz);
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    if(NULL != adc_dma_handle)
+    {
+        adc_dma_deinitialize();
+    }
+
+    adc_dma_config = *config;
+    memset(channel_to_slot, ADC_DMA_NO_SLOT, sizeof(channel_to_slot));
+
+    adc_digi_pattern_config_t adc_pattern[SOC_ADC_PATT_LEN_MAX] = {0};
+    for(uint32_t i = 0; i < config->channel_count; i++)
+    {
+        adc_pattern[i].atten = ADC_ATTENUATION;
+        adc_pattern[i].channel = config->channels[i] & 0x7;
+        adc_pattern[i].unit = ADC_TO_USE;
+        adc_pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        channel_to_slot[config->channels[i] & 0x7] = i;
+    }
+
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = ADC_DMA_POOL_SIZE,
+        .conv_frame_size = ADC_DMA_READ_LEN,
+    };
+    if(ESP_OK != adc_continuous_new_handle(&handle_config, &adc_dma_handle))
+    {
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    adc_continuous_config_t digi_config = {
+        .pattern_num = config->channel_count,
+        .adc_pattern = adc_pattern,
+        .sample_freq_hz = sample_freq_hz,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    if(ESP_OK != adc_continuous_config(adc_dma_handle, &digi_config))
+    {
+        adc_dma_deinitialize();
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    adc_continuous_evt_cbs_t callbacks = {
+        .on_conv_done = _adc_dma_conv_done_cb,
+        .on_pool_ovf = _adc_dma_pool_ovf_cb,
+    };
+    if(ESP_OK != adc_continuous_register_event_callbacks(adc_dma_handle, &callbacks, NULL))
+    {
+        adc_dma_deinitialize();
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    adc_dma_frame_queue = xQueueCreate(1, sizeof(uint32_t));
+    if(NULL == adc_dma_frame_queue)
+    {
+        adc_dma_deinitialize();
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    if(pdPASS != xTaskCreatePinnedToCore(_adc_dma_task, "ADC DMA reader", ADC_DMA_TASK_STACK_SIZE, NULL,
+                                         ADC_DMA_TASK_PRIORITY, &adc_dma_task_handle, ADC_DMA_TASK_CORE))
+    {
+        adc_dma_deinitialize();
+        return ADC_INITIALIZATION_FAIL;
+    }
+
+    return ADC_INITIALIZATION_SUCCESS;
+}
+
+adc_err_t adc_dma_start(void)
+{
+    if(NULL == adc_dma_handle)
+    {
+        return ADC_FAIL;
+    }
+
+    fill_scan = 0;
+    fill_slot = 0;
+    scan_counter = 0;
+    buffer_first_scan[fill_buffer] = 0;
+    memset(&adc_dma_stats, 0, sizeof(adc_dma_stats));
+    adc_dma_stats.start_time_us = esp_timer_get_time();
+
+    if(ESP_OK != adc_continuous_start(adc_dma_handle))
+    {
+        return ADC_FAIL;
+    }
+    return ADC_OK;
+}
+
+adc_err_t adc_dma_stop(void)
+{
+    if(NULL == adc_dma_handle)
+    {
+        return ADC_FAIL;
+    }
+
+    if(ESP_OK != adc_continuous_stop(adc_dma_handle))
+    {
+        return ADC_FAIL;
+    }
+    return ADC_OK;
+}
+
+bool adc_dma_frame_take(adc_dma_frame_t *frame, TickType_t timeout)
+{
+    uint32_t index = 0;
+
+    if((NULL == frame) || (NULL == adc_dma_frame_queue) ||
+       (pdTRUE != xQueueReceive(adc_dma_frame_queue, &index, timeout)))
+    {
+        return false;
+    }
+
+    taken_buffer = index;
+    frame->samples = frame_buffer[index];
+    frame->scan_count = adc_dma_config.frame_scans;
+    frame->timestamp_us = adc_dma_stats.start_time_us +
+                          (int64_t)(buffer_first_scan[index] * 1000000U / adc_dma_config.scan_rate_hz);
+    return true;
+}
+
+void adc_dma_frame_release(void)
+{
+    if(0 <= taken_buffer)
+    {
+        buffer_taken[taken_buffer] = false;
+        taken_buffer = -1;
+    }
+}
+
+void adc_dma_get_stats(adc_dma_stats_t *stats)
+{
+    if(NULL != stats)
+    {
+        *stats = adc_dma_stats;
+    }
+}
+
+adc_err_t adc_dma_deinitialize(void)
+{
+    adc_err_t err = ADC_OK;
+
+    if(NULL != adc_dma_task_handle)
+    {
+        vTaskDelete(adc_dma_task_handle);
+        adc_dma_task_handle = NULL;
+    }
+
+    if(NULL != adc_dma_handle)
+    {
+        adc_continuous_stop(adc_dma_handle);
+        if(ESP_OK != adc_continuous_deinit(adc_dma_handle))
+        {
+            err = ADC_FAIL;
+        }
+        adc_dma_handle = NULL;
+    }
+
+    if(NULL != adc_dma_frame_queue)
+    {
+        vQueueDelete(adc_dma_frame_queue);
+        adc_dma_frame_queue = NULL;
+    }
+
+    buffer_taken[0] = false;
+    buffer_taken[1] = false;
+    taken_buffer = -1;
+
+    return err;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _adc_dma_task(void *pvParameters)
+{
+    static uint8_t result[ADC_DMA_READ_LEN];
+    uint32_t length = 0;
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while(ESP_OK == adc_continuous_read(adc_dma_handle, result, ADC_DMA_READ_LEN, &length, 0))
+        {
+            _adc_dma_parse(result, length);
+        }
+    }
+}
+
+static void _adc_dma_parse(const uint8_t *result, uint32_t length)
+{
+    uint16_t *buffer = frame_buffer[fill_buffer];
+    uint32_t channel_count = adc_dma_config.channel_count;
+
+    for(uint32_t i = 0; i < length; i += SOC_ADC_DIGI_RESULT_BYTES)
+    {
+        const adc_digi_output_data_t *output = (const adc_digi_output_data_t *)&result[i];
+        uint32_t slot = channel_to_slot[output->type1.channel & 0x7];
+
+        if(slot != fill_slot)
+        {
+            /* A conversion was lost, drop the partial scan and wait for the first channel. */
+            fill_slot = 0;
+            if(0 != slot)
+            {
+                continue;
+            }
+        }
+
+        buffer[fill_scan * channel_count + slot] = output->type1.data;
+
+        if(++fill_slot == channel_count)
+        {
+            fill_slot = 0;
+            scan_counter++;
+            if(++fill_scan == adc_dma_config.frame_scans)
+            {
+                fill_scan = 0;
+                _adc_dma_frame_complete();
+                buffer = frame_buffer[fill_buffer];
+            }
+        }
+    }
+}
+
+static void _adc_dma_frame_complete(void)
+{
+    uint32_t sample_count = adc_dma_config.frame_scans * adc_dma_config.channel_count;
+    uint16_t *buffer = frame_buffer[fill_buffer];
+    uint32_t next_buffer = (fill_buffer + 1) % ADC_DMA_BUFFER_COUNT;
+
+    if(buffer_taken[next_buffer])
+    {
+        /* Consumer is still busy with the previous frame, overwrite this one. */
+        adc_dma_stats.frames_dropped++;
+        buffer_first_scan[fill_buffer] = scan_counter;
+        return;
+    }
+
+    adc_raw_to_voltage_batch(ADC_ATTENUATION, buffer, sample_count);
+
+    buffer_taken[fill_buffer] = true;
+    if(pdTRUE != xQueueSend(adc_dma_frame_queue, &fill_buffer, 0))
+    {
+        buffer_taken[fill_buffer] = false;
+        adc_dma_stats.frames_dropped++;
+        buffer_first_scan[fill_buffer] = scan_counter;
+        return;
+    }
+
+    adc_dma_stats.frames_delivered++;
+    adc_dma_stats.samples_delivered += sample_count;
+    fill_buffer = next_buffer;
+    buffer_first_scan[fill_buffer] = scan_counter;
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+static bool IRAM_ATTR _adc_dma_conv_done_cb(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                            void *user_data)
+{
+    BaseType_t must_yield = pdFALSE;
+    vTaskNotifyGiveFromISR(adc_dma_task_handle, &must_yield);
+
+    return (pdTRUE == must_yield);
+}
+
+static bool IRAM_ATTR _adc_dma_pool_ovf_cb(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                           void *user_data)
+{
+    adc_dma_stats.pool_overflows++;
+
+    return false;
+}
@@ -0,0 +1,125 @@
+/**
+* @file adc_dma.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __ADC_DMA_H__
+#define __ADC_DMA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "adc_driver.h"
+//---------------------------------- MACROS -----------------------------------
+#define ADC_DMA_MAX_CHANNELS      (8U)     // ADC1 has channels 0 - 7 on ESP32
+#define ADC_DMA_MAX_FRAME_SAMPLES (1024U)  // Samples (all channels together) in one ping-pong buffer
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    adc_channel_t channels[ADC_DMA_MAX_CHANNELS]; // Channels in the order they are converted
+    uint32_t      channel_count;
+    uint32_t      scan_rate_hz;                   // How many times per second every channel is sampled
+    uint32_t      frame_scans;                    // Scans (one sample of every channel) per frame
+} adc_dma_config_t;
+
+typedef struct
+{
+    const uint16_t *samples;      // Interleaved by scan: samples[scan * channel_count + k]
+    uint32_t        scan_count;
+    int64_t         timestamp_us; // Time of the first scan, counted in sample clock periods since start
+} adc_dma_frame_t;
+
+typedef struct
+{
+    uint32_t frames_delivered;
+    uint32_t frames_dropped;    // Frames overwritten because the consumer still held the other buffer
+    uint32_t pool_overflows;    // DMA pool overflows reported by the driver (samples lost before parsing)
+    uint64_t samples_delivered;
+    int64_t  start_time_us;
+} adc_dma_stats_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Initialize continuous (DMA) ADC acquisition.
+ *
+ * Configures the ADC digital controller to convert all given channels one after another at the given
+ * scan rate. Conversions are collected into two ping-pong frame buffers by a reader task; a complete frame
+ * is handed to the consumer with `adc_dma_frame_take()` while the reader keeps filling the other buffer.
+ *
+ * @note The continuous driver claims ADC1 while running, so `adc_oneshot_get_voltage()` must not be used
+ *       between `adc_dma_start()` and `adc_dma_stop()`.
+ *
+ * @param[in] config Channel list, scan rate and frame length.
+ *
+ * @return
+ *    - `ADC_INITIALIZATION_SUCCESS`: Initialization successful.
+ *    - `ADC_INITIALIZATION_FAIL`: Invalid configuration or driver initialization failed.
+ */
+adc_err_t adc_dma_init(const adc_dma_config_t *config);
+
+/**
+ * @brief Start DMA conversions and reset the statistics.
+ *
+ * @return
+ *    - `ADC_OK`: Conversions started.
+ *    - `ADC_FAIL`: Driver not initialized or failed to start.
+ */
+adc_err_t adc_dma_start(void);
+
+/**
+ * @brief Stop DMA conversions. A frame held by the consumer stays valid until it is released.
+ *
+ * @return
+ *    - `ADC_OK`: Conversions stopped.
+ *    - `ADC_FAIL`: Driver not initialized or failed to stop.
+ */
+adc_err_t adc_dma_stop(void);
+
+/**
+ * @brief Wait for the next complete frame.
+ *
+ * Samples are in millivolts, interleaved by scan: `samples[scan * channel_count + k]` is the sample of
+ * `config->channels[k]` in the given scan. All channels of a scan share the scan's timestamp. The buffer
+ * belongs to the caller until `adc_dma_frame_release()`.
+ *
+ * @param[out] frame Filled with the frame samples, scan count and timestamp.
+ * @param[in] timeout Ticks to wait for a frame.
+ *
+ * @return true if a frame was received, false on timeout.
+ */
+bool adc_dma_frame_take(adc_dma_frame_t *frame, TickType_t timeout);
+
+/**
+ * @brief Return the frame obtained with `adc_dma_frame_take()` to the reader task.
+ */
+void adc_dma_frame_release(void);
+
+/**
+ * @brief Get acquisition statistics (delivered/dropped frames and delivered samples) since the last start.
+ *
+ * @param[out] stats Statistics snapshot.
+ */
+void adc_dma_get_stats(adc_dma_stats_t *stats);
+
+/**
+ * @brief Stop conversions and release the continuous ADC driver.
+ *
+ * @return
+ *    - `ADC_OK`: Deinitialization successful.
+ *    - `ADC_FAIL`: Deinitialization failed.
+ */
+adc_err_t adc_dma_deinitialize(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ADC_DMA_H__
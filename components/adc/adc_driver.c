@@ -18,9 +18,13 @@
 #include "esp_adc/adc_cali.h"
 #include "esp_adc/adc_cali_scheme.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 //---------------------------------- MACROS -----------------------------------
 #define ADC_CALIBRATION_OFFSET (130U)
+#define ADC_LUT_SIZE           (ADC_RAW_MAX + 1U)
+
+#define TAG "ADC"
 //-------------------------------- DATA TYPES ---------------------------------
 
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
@@ -53,6 +57,31 @@ static bool _adc_calibration_init(adc_unit_t unit, adc_atten_t atten, adc_cali_h
  */
 static adc_err_t _adc_calibration_deinit(adc_cali_handle_t handle);
 
+/**
+ * @brief Build the raw-to-millivolt table of an attenuation.
+ *
+ * Every raw value is run through the calibration scheme once, with the calibration offset applied, so the
+ * sampling path only does a table lookup. Without calibration the table maps every raw value to itself.
+ *
+ * @param[in] unit The ADC unit.
+ * @param[in] atten The attenuation to build the table for.
+ *
+ * @return
+ *    - `true`: Table built.
+ *    - `false`: Out of memory or calibration failed.
+ */
+static bool _adc_lut_build(adc_unit_t unit, adc_atten_t atten);
+
+/**
+ * @brief Convert a raw reading with the calibration scheme, used to build the tables.
+ *
+ * @param[in] handle Calibration handle, `NULL` if calibration is disabled.
+ * @param[in] adc_raw_data Raw 12-bit ADC reading.
+ *
+ * @return The voltage in millivolts.
+ */
+static uint32_t _adc_calibrate(adc_cali_handle_t handle, int adc_raw_data);
+
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 
 //------------------------------- GLOBAL DATA ---------------------------------
@@ -61,6 +90,9 @@ static adc_cali_handle_t adc1_cali_handle    = NULL;
 
 static bool adc_calibration_enabled = false;
 
+/* Raw-to-millivolt tables, one per attenuation. adc_initialize() builds the one of ADC_ATTENUATION. */
+static uint16_t *adc_lut[SOC_ADC_ATTEN_NUM] = {NULL};
+
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 adc_err_t adc_initialize(adc_unit_t adc_unit, bool adc_want_calibration)
 {
@@ -78,7 +110,7 @@ adc_err_t adc_initialize(adc_unit_t adc_unit, bool adc_want_calibration)
 
     adc_oneshot_chan_cfg_t config = {
         .bitwidth = ADC_BITWIDTH_DEFAULT,
-        .atten = ADC_ATTEN_DB_11,
+        .atten = ADC_ATTENUATION,
     };
 
     /* This is the place for adding channels to use. */
@@ -97,7 +129,12 @@ adc_err_t adc_initialize(adc_unit_t adc_unit, bool adc_want_calibration)
 
     if(true == adc_want_calibration)
     {
-        adc_calibration_enabled = _adc_calibration_init(ADC_TO_USE, ADC_ATTEN_DB_11, &adc1_cali_handle);;
+        adc_calibration_enabled = _adc_calibration_init(ADC_TO_USE, ADC_ATTENUATION, &adc1_cali_handle);;
+    }
+
+    if(!_adc_lut_build(ADC_TO_USE, ADC_ATTENUATION))
+    {
+        ESP_LOGW(TAG, "Calibration table not built, converting every sample!");
     }
 
     return ADC_INITIALIZATION_SUCCESS;
@@ -106,15 +143,50 @@ adc_err_t adc_initialize(adc_unit_t adc_unit, bool adc_want_calibration)
 uint32_t adc_oneshot_get_voltage(adc_channel_t channel)
 {
     int adc_raw_data = 0;
-    int voltage = 0;
     ESP_ERROR_CHECK(adc_oneshot_read(adc1_handle, channel, &adc_raw_data));
-    if(adc_calibration_enabled)
+
+    return adc_raw_to_voltage(adc_raw_data);
+}
+
+uint32_t adc_raw_to_voltage(int adc_raw_data)
+{
+    const uint16_t *lut = adc_lut[ADC_ATTENUATION];
+
+    if(NULL == lut)
     {
-        ESP_ERROR_CHECK(adc_cali_raw_to_voltage(adc1_cali_handle, adc_raw_data, &voltage));
-        voltage = voltage - ADC_CALIBRATION_OFFSET;
+        return _adc_calibrate(adc_calibration_enabled ? adc1_cali_handle : NULL, adc_raw_data);
     }
 
-    return (uint32_t)voltage;
+    return lut[adc_raw_data & ADC_RAW_MAX];
+}
+
+adc_err_t adc_raw_to_voltage_batch(adc_atten_t atten, uint16_t *samples, uint32_t count)
+{
+    if((NULL == samples) || (SOC_ADC_ATTEN_NUM <= atten))
+    {
+        return ADC_FAIL;
+    }
+
+    const uint16_t *lut = adc_lut[atten];
+    if(NULL == lut)
+    {
+        /* Without its table only the attenuation of adc_initialize() has a calibration to convert with. */
+        if(ADC_ATTENUATION != atten)
+        {
+            return ADC_FAIL;
+        }
+        for(uint32_t i = 0; i < count; i++)
+        {
+            samples[i] = (uint16_t)adc_raw_to_voltage(samples[i]);
+        }
+        return ADC_OK;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        samples[i] = lut[samples[i] & ADC_RAW_MAX];
+    }
+    return ADC_OK;
 }
 
 adc_err_t adc_deinitialize(adc_unit_t adc_unit)
@@ -127,6 +199,12 @@ adc_err_t adc_deinitialize(adc_unit_t adc_unit)
             _adc_calibration_deinit(adc1_cali_handle);
         }
     }
+
+    for(uint32_t i = 0; i < SOC_ADC_ATTEN_NUM; i++)
+    {
+        free(adc_lut[i]);
+        adc_lut[i] = NULL;
+    }
     return ADC_OK;
 }
 
@@ -164,6 +242,63 @@ static adc_err_t _adc_calibration_deinit(adc_cali_handle_t handle)
     return ADC_OK;
 }
 
+static bool _adc_lut_build(adc_unit_t unit, adc_atten_t atten)
+{
+    adc_cali_handle_t handle = NULL;
+
+    if(NULL == adc_lut[atten])
+    {
+        adc_lut[atten] = malloc(ADC_LUT_SIZE * sizeof(uint16_t));
+        if(NULL == adc_lut[atten])
+        {
+            return false;
+        }
+    }
+
+    /* The attenuation used by adc_initialize() reuses its handle, others get a temporary one. */
+    bool temporary_handle = false;
+    if(adc_calibration_enabled)
+    {
+        if(ADC_ATTENUATION == atten)
+        {
+            handle = adc1_cali_handle;
+        }
+        else
+        {
+            temporary_handle = _adc_calibration_init(unit, atten, &handle);
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    for(uint32_t raw = 0; raw < ADC_LUT_SIZE; raw++)
+    {
+        adc_lut[atten][raw] = (uint16_t)_adc_calibrate(handle, raw);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    /* Cost of the per-sample calibration the table replaces. */
+    ESP_LOGI(TAG, "Calibration table built in %d us, %d ns per calibrated sample", (int)elapsed_us,
+             (int)(elapsed_us * 1000 / ADC_LUT_SIZE));
+
+    if(temporary_handle)
+    {
+        _adc_calibration_deinit(handle);
+    }
+    return true;
+}
+
+static uint32_t _adc_calibrate(adc_cali_handle_t handle, int adc_raw_data)
+{
+    int voltage = adc_raw_data;
+    if(NULL != handle)
+    {
+        ESP_ERROR_CHECK(adc_cali_raw_to_voltage(handle, adc_raw_data, &voltage));
+        voltage = (ADC_CALIBRATION_OFFSET < voltage) ? (voltage - ADC_CALIBRATION_OFFSET) : 0;
+    }
+
+    return (uint32_t)voltage;
+}
+
 //---------------------------- INTERRUPT HANDLERS -----------------------------
 
 
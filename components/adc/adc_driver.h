@@ -22,6 +22,9 @@ extern "C" {
 
 #define ADC_CALIBRATION_ENABLE  true
 #define ADC_CALIBRATION_DISABLE false
+
+#define ADC_ATTENUATION ADC_ATTEN_DB_11 // Attenuation of all configured channels (one-shot and continuous)
+#define ADC_RAW_MAX     (4095U)         // 12-bit readings
 //-------------------------------- DATA TYPES ---------------------------------
 typedef enum
 {
@@ -57,6 +60,34 @@ adc_err_t adc_initialize(adc_unit_t adc_unit, bool adc_want_calibration);
  */
 uint32_t adc_oneshot_get_voltage(adc_channel_t channel);
 
+/**
+ * @brief Convert a raw ADC reading to millivolts.
+ *
+ * Looks the reading up in the raw-to-millivolt table of `ADC_ATTENUATION` built in `adc_initialize()`. Works for
+ * readings obtained in either one-shot or continuous (DMA) mode.
+ *
+ * @param[in] adc_raw_data Raw 12-bit ADC reading.
+ *
+ * @return
+ *    - The voltage in millivolts (the raw value if calibration is disabled).
+ */
+uint32_t adc_raw_to_voltage(int adc_raw_data);
+
+/**
+ * @brief Convert a buffer of raw ADC readings to millivolts in place.
+ *
+ * One table lookup per sample, meant for whole DMA frames.
+ *
+ * @param[in] atten Attenuation the readings were taken with.
+ * @param[in,out] samples Raw 12-bit readings, replaced by millivolts.
+ * @param[in] count Number of samples.
+ *
+ * @return
+ *    - `ADC_OK`: Samples converted.
+ *    - `ADC_FAIL`: No calibration for this attenuation, the samples are left raw.
+ */
+adc_err_t adc_raw_to_voltage_batch(adc_atten_t atten, uint16_t *samples, uint32_t count);
+
 /**
  * @brief Deinitialize the ADC unit.
  *
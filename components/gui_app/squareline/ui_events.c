@@ -6,8 +6,8 @@
 //--------------------------------- INCLUDES ----------------------------------
 #include "ui.h"
 #include "waveform_generator.h"
+#include "waveform_sine.h"
 #include "ui_app.h"
-#include <math.h>
 #include "oscilloscope.h"
 #include "esp_log.h"
 #include "user_interface.h"
@@ -21,6 +21,10 @@ typedef struct {
     uint32_t      frequency;
     uint32_t      amplitude_mv;
     uint32_t      duty_cycle_percentage;
+    waveform_modulation_t       modulation;
+    waveform_modulation_shape_t modulation_shape;
+    uint32_t                    modulation_rate;
+    uint32_t                    modulation_depth_percentage;
 } waveform_generator_t;
 
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
@@ -31,11 +35,14 @@ void _display_wavewform_switch(lv_obj_t *ui_Label, waveform_generator_t waveform
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 static waveform_generator_t local_waveform_generator_state = {.waveform = WAVEFORM_SINE, .frequency = 3000, .amplitude_mv = 2500, .duty_cycle_percentage = 50};
 
-/* Default presets. */
+/* Default presets. Only preset 4 is modulated: loading it turns modulation on, loading any other turns it off,
+   and saving over a preset copies the modulation of the current state with the rest. */
 static waveform_generator_t waveform_preset_1 = {.waveform = WAVEFORM_SINE, .frequency = 1000, .amplitude_mv = 3000, .duty_cycle_percentage = 50};
 static waveform_generator_t waveform_preset_2 = {.waveform = WAVEFORM_SQUARE, .frequency = 2000, .amplitude_mv = 1000, .duty_cycle_percentage = 40};
 static waveform_generator_t waveform_preset_3 = {.waveform = WAVEFORM_TRIANGLE, .frequency = 5000, .amplitude_mv = 1500, .duty_cycle_percentage = 50};
-static waveform_generator_t waveform_preset_4 = {.waveform = WAVEFORM_SAWTOOTH, .frequency = 5000, .amplitude_mv = 1500, .duty_cycle_percentage = 50};
+static waveform_generator_t waveform_preset_4 = {.waveform = WAVEFORM_SAWTOOTH, .frequency = 5000, .amplitude_mv = 1500, .duty_cycle_percentage = 50,
+												 .modulation = WAVEFORM_MODULATION_AM, .modulation_shape = WAVEFORM_MODULATION_SHAPE_SINE,
+												 .modulation_rate = 5, .modulation_depth_percentage = 50};
 
 //------------------------------- GLOBAL DATA ---------------------------------
 lv_chart_series_t * ui_Chart1_series_1;
@@ -72,6 +79,13 @@ void startGenerating(lv_event_t * e)
 	waveform_generator_set_frequency(DAC_CHANNEL_TO_USE, (uint32_t)lv_slider_get_value(ui_Slider_frequency));
 	waveform_generator_set_amplitude_mv(DAC_CHANNEL_TO_USE, (uint32_t)lv_slider_get_value(ui_Slider_amplitude));
 	waveform_generator_set_duty_cycle_percenatge(DAC_CHANNEL_TO_USE, (uint32_t)lv_slider_get_value(ui_Slider_duty_cycle));
+	if(WAVEFORM_MODULATION_OFF != local_waveform_generator_state.modulation)
+	{
+		waveform_generator_set_modulation_source(DAC_CHANNEL_TO_USE, local_waveform_generator_state.modulation_shape,
+												 local_waveform_generator_state.modulation_rate);
+	}
+	waveform_generator_set_modulation(DAC_CHANNEL_TO_USE, local_waveform_generator_state.modulation,
+									  local_waveform_generator_state.modulation_depth_percentage);
 
 	local_waveform_generator_state.frequency = (uint32_t)lv_slider_get_value(ui_Slider_frequency);
 	local_waveform_generator_state.amplitude_mv = (uint32_t)lv_slider_get_value(ui_Slider_amplitude);
@@ -99,13 +113,15 @@ void drawWaveform(lv_event_t * e)
 	static lv_coord_t ui_Chart1_series_1_array[200] = {};
 
 	uint32_t square_duration = (uint32_t)(OUTPUT_POINT_NUM * ((float)local_waveform_generator_state.duty_cycle_percentage / 100.0f));
+	uint32_t sine_step = waveform_sine_phase(1, OUTPUT_POINT_NUM);
 
 	for(uint8_t i = 0; i < OUTPUT_POINT_NUM; i++)
 	{
 		switch(local_waveform_generator_state.waveform)
 		{
 			case WAVEFORM_SINE:
-				ui_Chart1_series_1_array[i] = (int)(local_waveform_generator_state.amplitude_mv * (sin(i *  CONST_PERIOD_2_PI / OUTPUT_POINT_NUM) + 1) / 2);
+				ui_Chart1_series_1_array[i] = local_waveform_generator_state.amplitude_mv *
+											  (uint32_t)(waveform_sine_q15(i * sine_step) + WAVEFORM_SINE_MAX) / (2 * WAVEFORM_SINE_MAX);
 				break;
 			case WAVEFORM_TRIANGLE:
 				ui_Chart1_series_1_array[i] = ((OUTPUT_POINT_NUM / 2)< i) ? (2 * local_waveform_generator_state.amplitude_mv *(OUTPUT_POINT_NUM - i) / OUTPUT_POINT_NUM) :
@@ -133,19 +149,22 @@ void _erase_screen()
 
 void _display_wavewform_switch(lv_obj_t *ui_Label, waveform_generator_t waveform_preset)
 {
+	static const char *const modulation_names[WAVEFORM_MODULATION_COUNT] = {"", " AM", " FM", " PWM"};
+	const char *modulation = (WAVEFORM_MODULATION_COUNT > waveform_preset.modulation) ? modulation_names[waveform_preset.modulation] : "";
+
 	switch(waveform_preset.waveform)
 	{
 		case WAVEFORM_SINE:
-			lv_label_set_text(ui_Label, "Waveform: Sine");
+			lv_label_set_text_fmt(ui_Label, "Waveform: Sine%s", modulation);
 			break;
 		case WAVEFORM_TRIANGLE:
-			lv_label_set_text(ui_Label, "Waveform: Triangle");
+			lv_label_set_text_fmt(ui_Label, "Waveform: Triangle%s", modulation);
 			break;
 		case WAVEFORM_SAWTOOTH:
-			lv_label_set_text(ui_Label, "Waveform: Sawtooth");
+			lv_label_set_text_fmt(ui_Label, "Waveform: Sawtooth%s", modulation);
 			break;
 		case WAVEFORM_SQUARE:
-			lv_label_set_text(ui_Label, "Waveform: Square");
+			lv_label_set_text_fmt(ui_Label, "Waveform: Square%s", modulation);
 			break;
 		default: break;
 	}
@@ -10,6 +10,8 @@
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "my_mqtt.h"
+#include "waveform_generator.h"
+#include "waveform_awg.h"
 #include "esp_log.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,8 +28,22 @@
  */
 static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
 
+/**
+ * @brief Handles a fragment of a message on the arbitrary waveform topics. Large images arrive in
+ *        several fragments, only the first one carries the topic.
+ */
+static void _mqtt_awg_data(esp_mqtt_event_handle_t event);
+
+/**
+ * @brief Parses a decimal number that makes up the whole string.
+ * 
+ * @return uint32_t The number, UINT32_MAX if the string is not one.
+ */
+static uint32_t _mqtt_number(const char *text);
+
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 static esp_mqtt_client_handle_t mqtt_client = NULL;
+static uint32_t awg_upload_slot = WAVEFORM_AWG_SLOTS;   // Slot of the image being received, none if invalid
 
 //------------------------------- GLOBAL DATA ---------------------------------
 
@@ -79,6 +95,7 @@ static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, int32
     switch (event->event_id) {
         case MQTT_EVENT_CONNECTED:
             ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
+            esp_mqtt_client_subscribe(mqtt_client, MQTT_AWG_TOPIC "#", 1);
             break;
         case MQTT_EVENT_DISCONNECTED:
             ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
@@ -88,6 +105,7 @@ static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, int32
             break;
         case MQTT_EVENT_DATA:
             ESP_LOGI(TAG, "MQTT_EVENT_DATA received");
+            _mqtt_awg_data(event);
             break;
         case MQTT_EVENT_ERROR:
             ESP_LOGE(TAG, "MQTT_EVENT_ERROR");
@@ -98,4 +116,59 @@ static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, int32
     }
 }
 
+static void _mqtt_awg_data(esp_mqtt_event_handle_t event)
+{
+    const size_t prefix_length = strlen(MQTT_AWG_TOPIC);
+    char value[8];
+
+    if(0 == event->current_data_offset)
+    {
+        awg_upload_slot = WAVEFORM_AWG_SLOTS;
+        if((event->topic_len <= prefix_length) || (0 != strncmp(event->topic, MQTT_AWG_TOPIC, prefix_length)))
+        {
+            return;
+        }
+
+        if((event->topic_len == strlen(MQTT_AWG_SELECT_TOPIC)) &&
+           (0 == strncmp(event->topic, MQTT_AWG_SELECT_TOPIC, event->topic_len)))
+        {
+            int length = (event->data_len < (int)sizeof(value)) ? event->data_len : ((int)sizeof(value) - 1);
+            memcpy(value, event->data, length);
+            value[length] = '\0';
+            uint32_t slot = _mqtt_number(value);
+            if(WAVEFORM_AWG_SLOTS > slot)
+            {
+                waveform_generator_set_arbitrary(DAC_CHANNEL_TO_USE, slot);
+            }
+            return;
+        }
+
+        int length = event->topic_len - prefix_length;
+        if(length >= (int)sizeof(value))
+        {
+            return;
+        }
+        memcpy(value, &event->topic[prefix_length], length);
+        value[length] = '\0';
+        awg_upload_slot = _mqtt_number(value);
+    }
+
+    if(WAVEFORM_AWG_SLOTS <= awg_upload_slot)
+    {
+        return;
+    }
+    if(ESP_OK != waveform_awg_receive(awg_upload_slot, event->current_data_offset, (const uint8_t *)event->data,
+                                      event->data_len, event->total_data_len))
+    {
+        awg_upload_slot = WAVEFORM_AWG_SLOTS;
+    }
+}
+
+static uint32_t _mqtt_number(const char *text)
+{
+    char *end = NULL;
+    unsigned long number = strtoul(text, &end, 10);
+    return ((end == text) || ('\0' != *end)) ? UINT32_MAX : (uint32_t)number;
+}
+
 //---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -22,6 +22,8 @@ extern "C" {
 //---------------------------------- MACROS -----------------------------------
 #define MQTT_BROKER_URI "mqtt://80.208.225.96:1883"
 #define MQTT_TOPIC "/blesa/final_task"
+#define MQTT_AWG_TOPIC        "/blesa/awg/"        // <slot>: binary waveform image, see waveform_awg.h
+#define MQTT_AWG_SELECT_TOPIC "/blesa/awg/select"  // Slot number as text: output that waveform
 
 //-------------------------------- DATA TYPES ---------------------------------
 
@@ -1,7 +1,7 @@
 /**
 * @file oscilloscope.c
 *
-* @brief 
+* @brief
 *
 * COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
 * All rights reserved.
@@ -11,105 +11,626 @@
 #include "oscilloscope.h"
 #include "esp_timer.h"
 #include "adc_driver.h"
+#include "adc_dma.h"
+#include "oscilloscope_decimation.h"
+#include "oscilloscope_triple_buffer.h"
+#include "oscilloscope_spectrum.h"
+#include "oscilloscope_measure.h"
+#include "oscilloscope_ets.h"
+#include "oscilloscope_record.h"
+#include "oscilloscope_segment.h"
+#include "oscilloscope_screenshot_store.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "led.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
 
 //---------------------------------- MACROS -----------------------------------
 #define POINTS_PER_FRAME (200U)
+#define OSCILLOSCOPE_DEEP_CAPTURE_POINTS (1000U)  // Peak detect: 5 samples per display column
+#define OSCILLOSCOPE_CAPTURE_BUFFER_POINTS (OSCILLOSCOPE_SPECTRUM_MAX_POINTS)  // Largest capture, spectrum view
 #define DEFAULT_SAMPLING_RATE_CH1 (1000U)  // 1000 us = 1 ms
 #define DEFAULT_SAMPLING_RATE_CH2 (100U)   // 100 us = 0.1 ms
-#define OSCILLOSCOPE_SCREEN_REFRESH_RATE (1500000U)  // = 0.67 Hz
+#define DEFAULT_SAMPLING_RATE_CH3 (100U)   // 100 us = 0.1 ms
+#define OSCILLOSCOPE_RENDER_PERIOD_MS (40U)           // 25 fps when frames are ready
+#define OSCILLOSCOPE_AUTO_TRIGGER_TIMEOUT_US (100000U) // Auto sweep forces a frame after frame time + 100 ms
+#define OSCILLOSCOPE_STATS_PERIOD_US (1000000U)        // fps/latency label refresh
+#define OSCILLOSCOPE_STATS_LOG_PERIOD (5U)             // Log fps/latency every 5 label refreshes
+#define OSCILLOSCOPE_SCREENSHOT_POLL_MS (50U)          // Check for a loaded screenshot
+#define OSCILLOSCOPE_DMA_TASK_STACK     (5 * 1024)     // Whole sample pipeline, double filter design and logs
+#define OSCILLOSCOPE_MATH_COLOR         (0xFF40FF)
+#define OSCILLOSCOPE_XY_POINTS          (512U)         // XY points per frame after the screen cell reduction
+#define OSCILLOSCOPE_PERSISTENCE_MEMORY (LV_CANVAS_BUF_SIZE_INDEXED_8BIT(OSCILLOSCOPE_PERSISTENCE_MAX_WIDTH, \
+                                                                 OSCILLOSCOPE_PERSISTENCE_MAX_HEIGHT))  // Bytes
+#define OSCILLOSCOPE_XY_POINT_SIZE      (2)            // px
+#define OSCILLOSCOPE_XY_COLOR           (0x20F080)
+
+#define OSCILLOSCOPE_ROLL_THRESHOLD_US (1000000U)      // Roll when a frame takes 1 s or more to fill
+#define OSCILLOSCOPE_ROLL_STREAM_POINTS (64U)          // Per channel, power of 2
 #define OSCILLOSCOPE_ZOOM_INCREMENT (100U)
 #define OSCILLOSCOPE_MINIMUM_SAMPLING_RATE (20U)
 #define OSCILLOSCOPE_RATE_THRESHOLD (110U)
 
 #define OSCILLOSCOPE_MAX_VOLTAGE (3300U)
 #define OSCILLOSCOPE_MIN_VOLTAGE (0U)
+
+/* Acquisition backend: 1 - continuous (DMA) ADC, 0 - one-shot reads from a single esp_timer. */
+#define OSCILLOSCOPE_USE_DMA_ACQUISITION (1)
+#define OSCILLOSCOPE_DMA_SCAN_PERIOD     (10U)   // 10 us between two scans of all enabled channels
+#define OSCILLOSCOPE_DMA_FRAME_SCANS     (256U)
+#define OSCILLOSCOPE_DMA_TIMEOUT_MS      (100U)
+
+#define OSCILLOSCOPE_AUTOSET_PERIODS          (3U)    // Periods on the screen after autoset
+#define OSCILLOSCOPE_AUTOSET_MIN_AMPLITUDE_MV (100U)  // Smaller swings are treated as DC
+#define OSCILLOSCOPE_AUTOSET_MIN_PERIOD       (4U)    // Samples, shorter periods are noise
+#define OSCILLOSCOPE_AUTOSET_MARGIN_DIV       (10U)   // Vertical margin, 10 % of the swing
+#define OSCILLOSCOPE_AUTOSET_RANGE_STEP_MV    (100U)
+#define OSCILLOSCOPE_AUTOSET_MIN_RANGE_MV     (200U)
+
+#define OSCILLOSCOPE_DEFAULT_AVERAGE_FRAMES (16U)
+#define OSCILLOSCOPE_ETS_MAX_ACQUISITIONS   (64U)  // Frame is shown with interpolated gaps after this many
+
+#define OSCILLOSCOPE_DEFAULT_TRIGGER_LEVEL      (1650U)  // mV, middle of the ADC range
+#define OSCILLOSCOPE_DEFAULT_TRIGGER_HYSTERESIS (50U)    // mV
+#define OSCILLOSCOPE_DEFAULT_PRE_TRIGGER        (50U)    // % of the frame
+
+#define TAG "OSCILLOSCOPE"
 //-------------------------------- DATA TYPES ---------------------------------
 typedef struct oscilloscope
 {
-    lv_coord_t measurement_data[POINTS_PER_FRAME];
+    uint16_t capture[OSCILLOSCOPE_CAPTURE_BUFFER_POINTS]; // Circular capture buffer written by the sampler
     lv_chart_series_t *ui_Chart_series;
-    uint32_t index;
-    esp_timer_handle_t sample_timer;
+    lv_chart_series_t *ui_Chart_series_min;         // Lower edge of the envelope, shown in peak detect
+    uint32_t color;
+    adc_channel_t adc_channel;
+    bool enabled;
+    uint32_t index;           // Next write position in the capture buffer
+    uint32_t filled;          // Samples in the capture buffer, saturates at capture_points
+    uint32_t post_trigger;    // Samples still to capture after the trigger
     uint32_t sampling_rate;
-    uint32_t min_voltage;
-    uint32_t max_voltage;
+    uint32_t decimation;
+    uint32_t decimation_counter;
+    uint32_t oversample_sum;  // High resolution: sum of the samples of the current column
+    volatile bool acquiring;
+    oscilloscope_measure_levels_t levels;  // Measurement reference levels, from the previous frame
+    oscilloscope_measurements_t measurements;  // Of the last published frame
+    uint32_t autoset_step;                 // Index into autoset_timebases
+    oscilloscope_filter_t filter;          // On the kept samples, state carried from frame to frame
+    uint32_t filter_rate_hz;               // Rate the filter was designed for, 0 when off
 } oscilloscope_channel_t;
 
+/* Display frame handed from the sampler to the renderer through the triple buffer. */
+typedef struct
+{
+    lv_coord_t column_max[OSCILLOSCOPE_CHANNEL_COUNT][POINTS_PER_FRAME];
+    lv_coord_t column_min[OSCILLOSCOPE_CHANNEL_COUNT][POINTS_PER_FRAME];
+    oscilloscope_measurements_t measurements[OSCILLOSCOPE_CHANNEL_COUNT];
+    bool enabled[OSCILLOSCOPE_CHANNEL_COUNT];
+    bool envelope;                  // Peak detect frame, column_min is drawn as the lower edge
+    lv_coord_t column_math[POINTS_PER_FRAME];
+    oscilloscope_math_t math;       // Operation of column_math, off if the inputs were not aligned
+    uint32_t math_column_ns;        // For the scale of the math trace
+    bool xy;                        // XY frame, only the XY points are drawn
+    lv_coord_t xy_x[OSCILLOSCOPE_XY_POINTS];
+    lv_coord_t xy_y[OSCILLOSCOPE_XY_POINTS];
+    uint32_t xy_count;
+    int64_t trigger_timestamp_us;
+    int64_t publish_timestamp_us;   // For the render latency
+} oscilloscope_frame_t;
+
+typedef enum
+{
+    CAPTURE_ARMED,      // Filling the pre-trigger part and waiting for the trigger
+    CAPTURE_TRIGGERED,  // Filling the post-trigger part
+    CAPTURE_COMPLETE    // Frame complete, single sweep is waiting for the next start
+} oscilloscope_capture_state_t;
+
+/* One scheduler tick: every enabled channel sampled in the same pass, sharing one timestamp. */
+typedef struct
+{
+    int64_t  timestamp_us;
+    uint16_t voltage[OSCILLOSCOPE_CHANNEL_COUNT];
+} oscilloscope_sample_set_t;
+
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
- * @brief Timer callback for sampling channel 1 ADC data.
+ * @brief Timer callback of the single sampling scheduler (one-shot backend).
  *
- * This function is called periodically to sample voltage from ADC channel 1.
- * It stores the sampled voltage into the measurement data array, updates the
- * maximum and minimum voltage values, and stops the timer when the buffer is full.
+ * This function is called once per scheduler tick. It reads every enabled channel
+ * into one sample set with a shared timestamp and passes it to the scheduler. The
+ * timer is stopped when all enabled channels have a full frame.
  *
  * @param[in] arg Unused argument passed by the timer.
  */
-void _oscilloscope_sample_timer_callback_ch1(void* arg);
+void _oscilloscope_sample_timer_callback(void* arg);
 
 /**
- * @brief Timer callback for sampling channel 2 ADC data.
+ * @brief Task consuming frames from the continuous (DMA) ADC driver.
  *
- * This function is called periodically to sample voltage from ADC channel 2.
- * It stores the sampled voltage into the measurement data array, updates the
- * maximum and minimum voltage values, and stops the timer when the buffer is full.
+ * Every frame holds the enabled channels interleaved by scan, taken each OSCILLOSCOPE_DMA_SCAN_PERIOD us.
+ * Each scan is passed to the scheduler as one sample set.
  *
- * @param[in] arg Unused argument passed by the timer.
+ * @param[in] pvParameters Unused parameter for task creation.
  */
-void _oscilloscope_sample_timer_callback_ch2(void* arg);
+static void _oscilloscope_dma_task(void *pvParameters);
 
 /**
- * @brief Timer callback to notify the oscilloscope screen task.
+ * @brief Passes one scheduler tick to all enabled channels.
  *
- * This function is used to stop the screen refresh timer and notify the oscilloscope
- * drawing task to update the waveform on the screen.
+ * Every channel keeps every n-th sample set (n = its decimation), so channels with the same timebase are
+ * sampled in the same tick and channels with different timebases stay phase aligned to the frame start.
  *
- * @param[in] arg Unused argument passed by the timer.
+ * When all enabled channels have a full frame, the frame is published to the renderer and the next frame is
+ * armed right away, so acquisition never waits for drawing.
+ *
+ * @param[in] set Samples of all enabled channels taken in the same tick.
+ *
+ * @return true if all enabled channels have a full frame.
  */
-void _oscilloscope_timer_for_screen(void* arg);
+static bool _oscilloscope_process_sample_set(const oscilloscope_sample_set_t *set);
 
 /**
- * @brief Draws the waveform for both channels on the oscilloscope.
+ * @brief Stores one sample into the channel's circular capture buffer.
+ *
+ * After the trigger, acquisition of the channel stops when the post-trigger part is captured and is
+ * resumed when the complete frame is published.
  *
- * This function updates the LVGL chart by setting the external Y array
- * for both channel 1 and channel 2 measurement data. It also updates
- * the displayed peak-to-peak voltage for both channels.
+ * @param[in] channel Channel to store the sample to.
+ * @param[in] voltage Sample in millivolts.
  */
-void _draw_waveform(void);
+static void _oscilloscope_store_sample(oscilloscope_channel_t *channel, uint32_t voltage);
 
 /**
- * @brief Task for drawing the waveform periodically.
+ * @brief Decimate the samples of a channel to its capture rate.
  *
- * This task waits for a notification, then draws the waveform, resets
- * the min/max voltage values, and restarts the sampling timers for both
- * channels. It also periodically starts the screen refresh timer.
+ * Keeps one sample of every `decimation` scheduler ticks, or in high resolution the mean of all of them.
  *
- * @param[in] pvParameters Unused parameter for task creation.
+ * @param[in] channel Channel the sample belongs to.
+ * @param[in] voltage Sample of this tick.
+ * @param[out] kept Sample to store, valid if true is returned.
+ *
+ * @return true if a sample is to be stored in this tick.
+ */
+static bool _oscilloscope_decimate(oscilloscope_channel_t *channel, uint16_t voltage, uint16_t *kept);
+
+/**
+ * @brief Starts the post-trigger part of the frame on all channels.
+ *
+ * @param[in] timestamp_us Time of the trigger sample.
+ * @param[in] phase_ns Time from the trigger level crossing to the trigger sample.
+ */
+static void _oscilloscope_trigger_fire(int64_t timestamp_us, uint32_t phase_ns);
+
+/**
+ * @brief Time by which the trigger level crossing precedes the trigger sample, interpolated between samples.
+ *
+ * @param[in] previous Source sample before the trigger sample.
+ * @param[in] voltage Trigger sample.
+ *
+ * @return Time in nanoseconds, 0 if the samples do not cross the level.
+ */
+static uint32_t _oscilloscope_trigger_phase(uint16_t previous, uint16_t voltage);
+
+/**
+ * @brief Add the complete captures to the equivalent-time frames.
+ *
+ * @return true if the frames are ready to be published.
+ */
+static bool _oscilloscope_ets_collect(void);
+
+/**
+ * @brief Start new equivalent-time frames on all channels.
+ */
+static void _oscilloscope_ets_reset(void);
+
+/**
+ * @brief Time covered by one display column of a channel.
+ *
+ * @param[in] channel Channel.
+ *
+ * @return Column time in nanoseconds, the timebase divided by OSCILLOSCOPE_ETS_FACTOR in equivalent time.
+ */
+static uint32_t _oscilloscope_column_ns(const oscilloscope_channel_t *channel);
+
+/**
+ * @brief Refresh the time/div labels of CH1 and CH2.
+ */
+static void _oscilloscope_timebase_label_update(void);
+
+/**
+ * @brief Clear the deep-memory record for the current sample periods. Called by the sampler.
+ */
+static void _oscilloscope_record_reset(void);
+
+/**
+ * @brief Draw the zoomed and panned view of the record. Called by the GUI task while stopped.
+ */
+static void _oscilloscope_record_display(void);
+
+/**
+ * @brief Store the complete capture as the next segment and re-arm the trigger in the same tick.
+ *        Called by the sampler only.
+ *
+ * @return true if the sequence is complete.
+ */
+static bool _oscilloscope_segment_next(void);
+
+/**
+ * @brief Draw one stored segment, or all of them overlaid on the persistence image. Called by the GUI task
+ *        while stopped.
+ *
+ * @param[in] segment Segment index, OSCILLOSCOPE_SEGMENT_OVERLAY for all.
+ */
+static void _oscilloscope_segment_display(uint32_t segment);
+
+/**
+ * @brief Reduces the complete capture buffers into the back display frame, oldest sample first,
+ *        and publishes it to the renderer.
+ *
+ * Every display column holds the minimum and maximum of its samples. In normal acquisition a column has one
+ * sample, in peak detect it has OSCILLOSCOPE_DEEP_CAPTURE_POINTS / POINTS_PER_FRAME samples.
+ */
+static void _oscilloscope_publish_frame(void);
+
+/**
+ * @brief Computes the capture length, scheduler tick and per-channel decimation from the channel timebases.
+ *
+ * With the DMA backend the tick is fixed to OSCILLOSCOPE_DMA_SCAN_PERIOD. With the one-shot backend the tick
+ * is the shortest sample period of all enabled channels. In peak detect channels are sampled faster so the
+ * deep capture covers the same time as a normal frame, as far as the tick allows.
+ */
+static void _oscilloscope_update_schedule(void);
+
+/**
+ * @brief Resets decimation and buffer indexes of all enabled channels, arms the trigger and resumes acquisition.
+ */
+static void _oscilloscope_restart_acquisition(void);
+
+/**
+ * @brief Changes the timebase of a channel and updates its ms/div label.
+ *
+ * @param[in] channel Channel to zoom.
+ * @param[in] zoom Zoom direction.
+ */
+static void _oscilloscope_channel_zoom(oscilloscope_channel_id_t channel, oscilloscope_zoom_t zoom);
+
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+/**
+ * @brief (Re)configures the DMA driver to scan all enabled channels.
+ *
+ * @return true if successful.
+ */
+static bool _oscilloscope_dma_configure(void);
+
+/**
+ * @brief Rebuilds the DMA driver for a changed channel set and resumes a running acquisition. Called by the
+ *        DMA task only, between frames, since it is the one waiting on the driver's frame queue.
+ */
+static void _oscilloscope_dma_reconfigure(void);
+#endif
+
+/**
+ * @brief Draws a display frame of all enabled channels on the oscilloscope.
+ *
+ * This function updates the LVGL chart by setting the external Y array of every
+ * channel to the frame, without copying. The frame is not written by the sampler
+ * until the renderer acquires the next one. It also updates the displayed
+ * peak-to-peak voltage for channel 1 and channel 2.
+ *
+ * @param[in] frame Frame to draw.
+ */
+void _draw_waveform(const oscilloscope_frame_t *frame);
+
+/**
+ * @brief Render loop of the oscilloscope, an LVGL timer running in the GUI task.
+ *
+ * Every OSCILLOSCOPE_RENDER_PERIOD_MS it draws the newest published frame, if there is one. Slow timebases
+ * simply publish less often and are drawn as soon as they are complete. If no frame was published for the
+ * frame time plus OSCILLOSCOPE_AUTO_TRIGGER_TIMEOUT_US, in auto sweep it forces the trigger so a frame is
+ * displayed even without a trigger event. It also keeps the fps and latency statistics.
+ *
+ * @param[in] timer LVGL timer.
+ */
+static void _oscilloscope_render_timer_callback(lv_timer_t *timer);
+
+/**
+ * @brief Show a loaded screenshot once the store has read it, then pause. An LVGL timer in the GUI task.
+ *
+ * @param[in] timer LVGL timer.
+ */
+static void _oscilloscope_screenshot_timer_callback(lv_timer_t *timer);
+
+/**
+ * @brief Copy a screenshot to the screenshot chart, with its vertical range and channels.
+ *
+ * @param[in] screenshot Screenshot to show.
+ */
+static void _oscilloscope_screenshot_display(const oscilloscope_screenshot_t *screenshot);
+
+/**
+ * @brief Compute the math trace of a frame, if the selected operation has time aligned inputs.
+ *
+ * @param[in,out] frame Frame with all channel columns in place.
+ */
+static void _oscilloscope_math_update(oscilloscope_frame_t *frame);
+
+/**
+ * @brief Point the XY series at the points of a frame. The chart must be in the XY view.
+ *
+ * @param[in] frame Frame to draw.
+ */
+static void _oscilloscope_xy_render(const oscilloscope_frame_t *frame);
+
+/**
+ * @brief Fade the persistence buffer and add the hits of the captures of a complete frame. Called by the
+ *        sampler only.
+ */
+static void _oscilloscope_persistence_update(void);
+
+/**
+ * @brief Show the persistence canvas in place of the channel traces, or the traces again. Called by the
+ *        renderer only.
+ *
+ * @param[in] show true to show the persistence canvas.
+ */
+static void _oscilloscope_persistence_display(bool show);
+
+/**
+ * @brief Allocate the persistence image the first time persistence or the segment overlay needs it and give
+ *        it to the canvas. Called by the renderer only, the memory is kept from then on.
+ *
+ * @return true if the image exists.
+ */
+static bool _oscilloscope_persistence_allocate(void);
+
+/**
+ * @brief Show the math operation and its scale, cleared when the trace is off.
+ *
+ * @param[in] frame Drawn frame.
+ */
+static void _oscilloscope_math_label_update(const oscilloscope_frame_t *frame);
+
+/**
+ * @brief Queues a sample for the roll display. Called by the sampler only.
+ *
+ * @param[in] channel Channel of the sample.
+ * @param[in] voltage Sample in millivolts.
+ */
+static void _oscilloscope_roll_push(oscilloscope_channel_id_t channel, uint16_t voltage);
+
+/**
+ * @brief Switches the chart between the roll display and triggered frames.
+ *
+ * In roll mode every series points at its roll buffer, which LVGL draws starting from the series' start
+ * point, so appending a sample at the right edge moves the start point instead of shifting the data.
+ *
+ * @param[in] roll true to switch to roll display.
+ */
+static void _oscilloscope_roll_display(bool roll);
+
+/**
+ * @brief Appends the samples queued by the sampler to the right edge of the roll display.
+ */
+static void _oscilloscope_roll_render(void);
+
+/**
+ * @brief Updates the fps/latency label and periodically logs the statistics.
+ *
+ * @param[in] now_us Current time.
+ */
+static void _oscilloscope_update_render_stats(int64_t now_us);
+
+/**
+ * @brief Hand the complete captures to the spectrum task.
+ */
+static void _oscilloscope_publish_spectrum(void);
+
+/**
+ * @brief Switch the chart between the voltage and the spectrum scale. Called by the renderer only.
+ *
+ * @param[in] view View to show.
+ */
+static void _oscilloscope_view_display(oscilloscope_view_t view);
+
+/**
+ * @brief Draw the newest spectrum, if any, and show the peak frequencies. Called by the renderer only.
+ *
+ * @return true if a new spectrum was drawn.
+ */
+static bool _oscilloscope_spectrum_render(void);
+
+/**
+ * @brief Start autoset from the fastest coarse timebase. Called by the sampler.
+ */
+static void _oscilloscope_autoset_begin(void);
+
+/**
+ * @brief Evaluate an autoset frame and select the next timebases. Called by the sampler after a frame is published.
+ *
+ * Frames alternate between finding the reference levels at a timebase and measuring the period with them.
+ */
+static void _oscilloscope_autoset_step(void);
+
+/**
+ * @brief Compute the vertical range and the trigger level from the autoset measurements and end autoset.
+ */
+static void _oscilloscope_autoset_finish(void);
+
+/**
+ * @brief Round a timebase to the nearest one reachable with the zoom buttons.
+ *
+ * @param[in] sampling_rate Timebase in microseconds per display column.
+ *
+ * @return Rounded timebase.
+ */
+static uint32_t _oscilloscope_timebase_round(uint32_t sampling_rate);
+
+/**
+ * @brief Show the selected measurements of CH1 and CH2 below the chart. Called by the renderer only.
+ *
+ * @param[in] frame Frame to show the measurements of.
  */
-void _draw_waveform_task(void * pvParameters);
+static void _oscilloscope_measurement_panel_render(const oscilloscope_frame_t *frame);
 
 /**
- * @brief Resets the maximum and minimum voltage values for both channels.
+ * @brief Format one measurement with its unit.
+ *
+ * @param[out] buffer Output text.
+ * @param[in] size Size of the output buffer.
+ * @param[in] item Measurement to format.
+ * @param[in] measurements Measurements of the channel.
  *
- * This function resets the maximum and minimum voltage values to their
- * initial states for both channel 1 and channel 2.
+ * @return Number of characters written, as snprintf.
  */
-void _reset_max_and_min_voltage(void);
+static int _oscilloscope_measurement_format(char *buffer, size_t size, oscilloscope_measurement_t item,
+                                            const oscilloscope_measurements_t *measurements);
 
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 static bool started = false;
-static oscilloscope_channel_t channel1 = {.measurement_data = {}, .index = 0, .sampling_rate = DEFAULT_SAMPLING_RATE_CH1,
-                                          .min_voltage = OSCILLOSCOPE_MAX_VOLTAGE, .max_voltage = OSCILLOSCOPE_MIN_VOLTAGE};
-static oscilloscope_channel_t channel2 = {.measurement_data = {}, .index = 0, .sampling_rate = DEFAULT_SAMPLING_RATE_CH2,
-                                          .min_voltage = OSCILLOSCOPE_MAX_VOLTAGE, .max_voltage = OSCILLOSCOPE_MIN_VOLTAGE};
+static volatile bool running = false; // Acquisition running, the record is browsed while stopped
+static bool record_browsable = false;
+static oscilloscope_record_view_t record_view;
+static oscilloscope_channel_t channels[OSCILLOSCOPE_CHANNEL_COUNT] = {
+    [OSCILLOSCOPE_CH1] = {.color = 0x20F080, .adc_channel = ADC_CHANNEL_3, .enabled = true, // ACC_IRQ1
+                          .index = 0, .sampling_rate = DEFAULT_SAMPLING_RATE_CH1},
+    [OSCILLOSCOPE_CH2] = {.color = 0xFFF800, .adc_channel = ADC_CHANNEL_6, .enabled = true, // JOY_X
+                          .index = 0, .sampling_rate = DEFAULT_SAMPLING_RATE_CH2},
+    [OSCILLOSCOPE_CH3] = {.color = 0x40A0FF, .adc_channel = ADC_CHANNEL_7, .enabled = false, // JOY_Y
+                          .index = 0, .sampling_rate = DEFAULT_SAMPLING_RATE_CH3},
+};
+
+static esp_timer_handle_t oscilloscope_sample_timer;
+static lv_timer_t *oscilloscope_render_timer = NULL;
+static lv_timer_t *oscilloscope_screenshot_timer = NULL;
+static lv_obj_t *oscilloscope_stats_label = NULL;
+static lv_obj_t *oscilloscope_math_label = NULL;
+static lv_chart_series_t *math_series = NULL;
+static lv_chart_series_t *xy_series = NULL;
+static volatile oscilloscope_math_t math_operation = OSCILLOSCOPE_MATH_OFF;
+static oscilloscope_filter_config_t filter_config[OSCILLOSCOPE_CHANNEL_COUNT];
+
+/* Persistence: the sampler writes the intensity, the renderer shows it as the image of the canvas. */
+static volatile oscilloscope_persistence_t persistence_mode = OSCILLOSCOPE_PERSISTENCE_OFF;
+static volatile bool persistence_clear = false;
+static bool persistence_displayed = false;
+static lv_obj_t *persistence_canvas = NULL;
+static oscilloscope_persistence_buffer_t persistence;
+/* Segmented memory, 0 or 1 segments is off. */
+static volatile uint32_t segments_requested = 0;
+static bool segments_active = false;     // Sampler: the acquisition is a sequence of segments
+static bool segments_browsable = false;  // GUI: stopped with stored segments
+static uint32_t segment_selected = 0;    // GUI: shown when leaving the overlay
+
+static uint8_t *persistence_memory = NULL;  // Palette and intensity image, allocated on first use
+static uint32_t persistence_width = 0;
+static uint32_t persistence_height = 0;
+static volatile bool filter_dirty[OSCILLOSCOPE_CHANNEL_COUNT];
+static oscilloscope_math_t math_label_operation = OSCILLOSCOPE_MATH_OFF;
+static oscilloscope_math_t math_label_requested = OSCILLOSCOPE_MATH_OFF;
+static uint32_t math_label_column_ns = 0;
+static lv_coord_t math_input[2][POINTS_PER_FRAME];  // Sampler: one sample per column of an envelope frame
+static uint32_t scheduler_tick = OSCILLOSCOPE_DMA_SCAN_PERIOD;
+static uint32_t frame_duration_us = 0;
+static oscilloscope_acquisition_t acquisition_mode = OSCILLOSCOPE_ACQUISITION_NORMAL;
+static uint32_t capture_points = POINTS_PER_FRAME;
+static uint32_t average_weight = OSCILLOSCOPE_DEFAULT_AVERAGE_FRAMES;
+static uint32_t average_frames = 0;             // Frames in the accumulators, touched by the sampler only
+static volatile bool accumulation_reset = false;
+static int32_t average_accumulator[OSCILLOSCOPE_CHANNEL_COUNT][POINTS_PER_FRAME];
+static volatile oscilloscope_view_t view = OSCILLOSCOPE_VIEW_TIME;
+static oscilloscope_view_t capture_view = OSCILLOSCOPE_VIEW_TIME;  // View of the frame being captured
+static oscilloscope_view_t view_displayed = OSCILLOSCOPE_VIEW_TIME;
+
+static oscilloscope_trigger_config_t trigger_config = {
+    .source = OSCILLOSCOPE_CH1,
+    .type = OSCILLOSCOPE_TRIGGER_RISING,
+    .sweep = OSCILLOSCOPE_SWEEP_AUTO,
+    .level = OSCILLOSCOPE_DEFAULT_TRIGGER_LEVEL,
+    .hysteresis = OSCILLOSCOPE_DEFAULT_TRIGGER_HYSTERESIS,
+    .pre_trigger_percent = OSCILLOSCOPE_DEFAULT_PRE_TRIGGER,
+    .holdoff_us = 0,
+};
+static oscilloscope_trigger_t trigger;
+static oscilloscope_channel_id_t trigger_source = OSCILLOSCOPE_CH1;
+static uint32_t pre_trigger_points = 0;
+static int64_t holdoff_end_us = 0;
+static volatile oscilloscope_capture_state_t capture_state = CAPTURE_ARMED;
+static volatile bool trigger_force = false;
+static int64_t trigger_timestamp_us = 0;
+static uint32_t trigger_phase_ns = 0;
+static uint16_t trigger_previous = 0;  // Last source sample seen by the trigger
+
+/* Equivalent time: frames being assembled from triggered acquisitions. */
+static bool ets_active = false;
+static oscilloscope_ets_t ets[OSCILLOSCOPE_CHANNEL_COUNT];
+static uint32_t ets_acquisitions = 0;
+
+static oscilloscope_frame_t frames[OSCILLOSCOPE_TRIPLE_BUFFER_SLOTS];
+static oscilloscope_triple_buffer_t frame_buffer;
+static const oscilloscope_frame_t *displayed_frame = NULL;
+
+/* Roll mode: per channel single-producer single-consumer stream from the sampler to the renderer. */
+static bool roll_enabled = true;
+static volatile bool roll_active = false;
+static volatile bool schedule_pending = false;
+static bool roll_displayed = false;
+static uint16_t roll_stream[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_ROLL_STREAM_POINTS];
+static atomic_uint roll_stream_head[OSCILLOSCOPE_CHANNEL_COUNT];
+static atomic_uint roll_stream_tail[OSCILLOSCOPE_CHANNEL_COUNT];
+static lv_coord_t roll_data[OSCILLOSCOPE_CHANNEL_COUNT][POINTS_PER_FRAME];
+
+/* Render statistics, touched by the GUI task only. */
+static int64_t last_render_us = 0;
+static int64_t stats_window_start_us = 0;
+static uint32_t stats_frames = 0;
+static int64_t stats_latency_us = 0;
+static uint32_t stats_windows = 0;
 
-static esp_timer_handle_t oscilloscope_screen_timer;
+/* Cost of the sampling path (scheduler, trigger and stores), measured on the DMA consumer. */
+static int64_t sampler_time_us = 0;
+static uint64_t sampler_sets = 0;
 
-TaskHandle_t oscilloscope_draw_task_handle = NULL;
+static TaskHandle_t oscilloscope_dma_task_handle = NULL;
+
+/* Autoset: coarse timebases, fastest first, all reachable with the zoom buttons. */
+static const uint32_t autoset_timebases[] = {OSCILLOSCOPE_MINIMUM_SAMPLING_RATE, 210U, 1010U};
+static volatile bool autoset_requested = false;
+static bool autoset_active = false;
+static bool autoset_measure_frame = false;
+static uint32_t autoset_pending = 0;      // Channels still searching, one bit per channel
+static oscilloscope_measurements_t autoset_result[OSCILLOSCOPE_CHANNEL_COUNT];
+static volatile bool autoset_done = false; // Range and labels to be applied by the renderer
+static lv_coord_t chart_min_mv = OSCILLOSCOPE_MIN_VOLTAGE;
+static lv_coord_t chart_max_mv = OSCILLOSCOPE_MAX_VOLTAGE;
+
+/* Measurement panel, selected items of every channel. */
+static oscilloscope_measurement_t panel_items[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_MEASUREMENT_PANEL_ITEMS] = {
+    [OSCILLOSCOPE_CH1] = {OSCILLOSCOPE_MEASUREMENT_VPP, OSCILLOSCOPE_MEASUREMENT_FREQUENCY},
+    [OSCILLOSCOPE_CH2] = {OSCILLOSCOPE_MEASUREMENT_VPP, OSCILLOSCOPE_MEASUREMENT_FREQUENCY},
+};
+static uint32_t panel_item_count[OSCILLOSCOPE_CHANNEL_COUNT] = {
+    [OSCILLOSCOPE_CH1] = 2,
+    [OSCILLOSCOPE_CH2] = 2,
+};
+
+/* Screenshots, touched by the GUI task only. The chart shows its own copy, never live data. */
+static oscilloscope_screenshot_t screenshot_capture;
+static lv_coord_t screenshot_data[OSCILLOSCOPE_CHANNEL_COUNT][POINTS_PER_FRAME];
+
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+/* Position of every channel in a DMA scan, OSCILLOSCOPE_CHANNEL_COUNT if the channel is not scanned. */
+static uint32_t dma_slot[OSCILLOSCOPE_CHANNEL_COUNT];
+static uint32_t dma_channel_count = 0;
+static volatile bool dma_configured = false;
+static volatile bool dma_reconfigure = false;     // Channel set changed, requested by the GUI task
+static SemaphoreHandle_t dma_driver_mutex = NULL; // Driver init/start/stop and `running`, GUI and DMA task
+#endif
 
 //------------------------------- GLOBAL DATA ---------------------------------
 lv_chart_series_t *screenshot_series1;
@@ -117,233 +638,1972 @@ lv_chart_series_t *screenshot_series2;
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 void oscilloscope_init()
 {
-    /* Create ESP timer for measurements of channel 1. */
-    esp_timer_create_args_t timer_args1_ch1 = {
-    .callback = &_oscilloscope_sample_timer_callback_ch1,
-    .arg = NULL,
-    .name = "Oscilloscope sample timer ch1"
-    };
-
-    /* Create ESP timer for measurements of channel 2. */
-    esp_timer_create_args_t timer_args1_ch2 = {
-    .callback = &_oscilloscope_sample_timer_callback_ch2,
-    .arg = NULL,
-    .name = "Oscilloscope sample timer ch2"
-    };
-
-    /* Create ESP timer for screen. */
-    esp_timer_create_args_t timer_args_screen = {
-    .callback = &_oscilloscope_timer_for_screen,
+    /* Create ESP timer of the sampling scheduler. */
+    esp_timer_create_args_t timer_args_sample = {
+    .callback = &_oscilloscope_sample_timer_callback,
     .arg = NULL,
     .name = "Oscilloscope sample timer"
     };
 
-    if(pdTRUE != xTaskCreate(_draw_waveform_task, "Draw waveform", 2 * 1024, (void*)0, 5, &oscilloscope_draw_task_handle))
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+    dma_driver_mutex = xSemaphoreCreateMutex();
+    if(NULL == dma_driver_mutex)
+    {
+        return;
+    }
+    if(pdTRUE != xTaskCreate(_oscilloscope_dma_task, "Oscilloscope DMA", OSCILLOSCOPE_DMA_TASK_STACK, (void*)0, 6,
+                             &oscilloscope_dma_task_handle))
     {
         return;
     }
+#endif
 
-    esp_timer_create(&timer_args1_ch1, &channel1.sample_timer);
-    esp_timer_create(&timer_args1_ch2, &channel2.sample_timer);
-    esp_timer_create(&timer_args_screen, &oscilloscope_screen_timer);
+    oscilloscope_triple_buffer_init(&frame_buffer);
+    if(!oscilloscope_spectrum_init())
+    {
+        ESP_LOGE(TAG, "Spectrum task creation failed!");
+    }
+    if(!oscilloscope_record_init())
+    {
+        ESP_LOGE(TAG, "Record allocation failed!");
+    }
+    if(!oscilloscope_screenshot_store_init())
+    {
+        ESP_LOGE(TAG, "Screenshot store task creation failed!");
+    }
+    esp_timer_create(&timer_args_sample, &oscilloscope_sample_timer);
 }
 
 void oscilloscope_start(void)
 {
     if(!started)
     {
-        channel1.ui_Chart_series = lv_chart_add_series(ui_OscilloscopeChart, lv_color_hex(0x20F080), LV_CHART_AXIS_PRIMARY_Y);
-        channel2.ui_Chart_series = lv_chart_add_series(ui_OscilloscopeChart, lv_color_hex(0xFFF800), LV_CHART_AXIS_PRIMARY_Y);
+        for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+        {
+            channels[i].ui_Chart_series = lv_chart_add_series(ui_OscilloscopeChart, lv_color_hex(channels[i].color),
+                                                              LV_CHART_AXIS_PRIMARY_Y);
+            channels[i].ui_Chart_series_min = lv_chart_add_series(ui_OscilloscopeChart, lv_color_hex(channels[i].color),
+                                                                  LV_CHART_AXIS_PRIMARY_Y);
+            lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series, !channels[i].enabled);
+            lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, true);
+        }
 
         screenshot_series1 = lv_chart_add_series(ui_OscilloscopeChart2, lv_color_hex(0x20F080), LV_CHART_AXIS_PRIMARY_Y);
         screenshot_series2 = lv_chart_add_series(ui_OscilloscopeChart2, lv_color_hex(0xFFF800), LV_CHART_AXIS_PRIMARY_Y);
-        
+        oscilloscope_screenshot_timer = lv_timer_create(_oscilloscope_screenshot_timer_callback,
+                                                        OSCILLOSCOPE_SCREENSHOT_POLL_MS, NULL);
+        lv_timer_pause(oscilloscope_screenshot_timer);
+
+        oscilloscope_stats_label = lv_label_create(ui_Oscilloscope_display);
+        lv_obj_set_width(oscilloscope_stats_label, LV_SIZE_CONTENT);
+        lv_obj_set_height(oscilloscope_stats_label, LV_SIZE_CONTENT);
+        lv_obj_set_x(oscilloscope_stats_label, 110);
+        lv_obj_set_y(oscilloscope_stats_label, -85);
+        lv_obj_set_align(oscilloscope_stats_label, LV_ALIGN_CENTER);
+        lv_obj_set_style_text_font(oscilloscope_stats_label, &lv_font_montserrat_10, LV_PART_MAIN | LV_STATE_DEFAULT);
+        lv_label_set_text(oscilloscope_stats_label, "");
+
+        math_series = lv_chart_add_series(ui_OscilloscopeChart, lv_color_hex(OSCILLOSCOPE_MATH_COLOR),
+                                          LV_CHART_AXIS_PRIMARY_Y);
+        lv_chart_hide_series(ui_OscilloscopeChart, math_series, true);
+
+        /* Given its own X array right away, a series without one must never be drawn as a scatter. */
+        xy_series = lv_chart_add_series(ui_OscilloscopeChart, lv_color_hex(OSCILLOSCOPE_XY_COLOR),
+                                        LV_CHART_AXIS_PRIMARY_Y);
+        lv_chart_set_ext_x_array(ui_OscilloscopeChart, xy_series, frames[0].xy_x);
+        lv_chart_set_ext_y_array(ui_OscilloscopeChart, xy_series, frames[0].xy_y);
+        lv_chart_hide_series(ui_OscilloscopeChart, xy_series, true);
+
+        oscilloscope_math_label = lv_label_create(ui_Oscilloscope_display);
+        lv_obj_set_width(oscilloscope_math_label, LV_SIZE_CONTENT);
+        lv_obj_set_height(oscilloscope_math_label, LV_SIZE_CONTENT);
+        lv_obj_set_x(oscilloscope_math_label, -80);
+        lv_obj_set_y(oscilloscope_math_label, -85);
+        lv_obj_set_align(oscilloscope_math_label, LV_ALIGN_CENTER);
+        lv_obj_set_style_text_font(oscilloscope_math_label, &lv_font_montserrat_10, LV_PART_MAIN | LV_STATE_DEFAULT);
+        lv_obj_set_style_text_color(oscilloscope_math_label, lv_color_hex(OSCILLOSCOPE_MATH_COLOR),
+                                    LV_PART_MAIN | LV_STATE_DEFAULT);
+        lv_label_set_text(oscilloscope_math_label, "");
+
+        /* Covers the plot area of the chart, above the grid; zero intensity is transparent. */
+        lv_obj_update_layout(ui_OscilloscopeChart);
+        uint32_t width = (uint32_t)lv_obj_get_content_width(ui_OscilloscopeChart);
+        uint32_t height = (uint32_t)lv_obj_get_content_height(ui_OscilloscopeChart);
+        persistence_width = (OSCILLOSCOPE_PERSISTENCE_MAX_WIDTH < width) ? OSCILLOSCOPE_PERSISTENCE_MAX_WIDTH : width;
+        persistence_height = (OSCILLOSCOPE_PERSISTENCE_MAX_HEIGHT < height) ? OSCILLOSCOPE_PERSISTENCE_MAX_HEIGHT :
+                                                                              height;
+        persistence_canvas = lv_canvas_create(ui_OscilloscopeChart);
+        lv_obj_set_pos(persistence_canvas, 0, 0);
+        lv_obj_add_flag(persistence_canvas, LV_OBJ_FLAG_HIDDEN);
+
+        oscilloscope_render_timer = lv_timer_create(_oscilloscope_render_timer_callback, OSCILLOSCOPE_RENDER_PERIOD_MS,
+                                                    NULL);
+
         started = true;
     }
-        /* Start all timers. */
-        esp_timer_start_periodic(channel1.sample_timer, channel1.sampling_rate);
-        esp_timer_start_periodic(channel1.sample_timer, channel2.sampling_rate);
-        esp_timer_start_periodic(oscilloscope_screen_timer, OSCILLOSCOPE_SCREEN_REFRESH_RATE);
-        led_pattern_run(LED_GREEN, LED_PATTERN_SLOWBLINK, 0);
+    /* Start acquisition and the render loop. */
+    _oscilloscope_update_schedule();
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+    xSemaphoreTake(dma_driver_mutex, portMAX_DELAY);
+    if(!dma_configured && !_oscilloscope_dma_configure())
+    {
+        xSemaphoreGive(dma_driver_mutex);
+        ESP_LOGE(TAG, "DMA acquisition initialization failed!");
+        return;
+    }
+    _oscilloscope_restart_acquisition();
+    adc_dma_start();
+    running = true;
+    xSemaphoreGive(dma_driver_mutex);
+#else
+    _oscilloscope_restart_acquisition();
+    esp_timer_start_periodic(oscilloscope_sample_timer, scheduler_tick);
+    running = true;
+#endif
+    last_render_us = esp_timer_get_time();
+    stats_window_start_us = last_render_us;
+    stats_frames = 0;
+    stats_latency_us = 0;
+    lv_timer_resume(oscilloscope_render_timer);
+    led_pattern_run(LED_GREEN, LED_PATTERN_SLOWBLINK, 0);
 
-        lv_label_set_text_fmt(ui_CH1msdiv_label, "%d ms/div", (int)(channel1.sampling_rate / 20.0f));
-        lv_label_set_text_fmt(ui_CH2msdiv_label, "%d ms/div", (int)(channel2.sampling_rate / 20.0f));
+    _oscilloscope_timebase_label_update();
 }
 
 void oscilloscope_stop(void)
 {
-    /* Stop all timers. */
-    esp_timer_stop(channel1.sample_timer);
-    esp_timer_stop(channel2.sample_timer);
-    esp_timer_stop(oscilloscope_screen_timer);
+    /* Stop acquisition, the sample timer and the render loop. */
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+    adc_dma_stats_t stats;
+    xSemaphoreTake(dma_driver_mutex, portMAX_DELAY);
+    adc_dma_stop();
+    running = false;
+    xSemaphoreGive(dma_driver_mutex);
+    adc_dma_get_stats(&stats);
+
+    int64_t elapsed_us = esp_timer_get_time() - stats.start_time_us;
+    ESP_LOGI(TAG, "DMA: %u frames, %u dropped, %u pool overflows, %d kS/s", (unsigned)stats.frames_delivered,
+             (unsigned)stats.frames_dropped, (unsigned)stats.pool_overflows,
+             (0 < elapsed_us) ? (int)(stats.samples_delivered * 1000 / elapsed_us) : 0);
+    ESP_LOGI(TAG, "Sampler: %d ns per sample set", (0 < sampler_sets) ? (int)(sampler_time_us * 1000 / sampler_sets) : 0);
+    ESP_LOGI(TAG, "DMA task: %u of %u stack bytes never used",
+             (unsigned)uxTaskGetStackHighWaterMark(oscilloscope_dma_task_handle), (unsigned)OSCILLOSCOPE_DMA_TASK_STACK);
+#endif
+    esp_timer_stop(oscilloscope_sample_timer);
+    if(NULL != oscilloscope_render_timer)
+    {
+        lv_timer_pause(oscilloscope_render_timer);
+    }
+    running = false;
+    record_browsable = oscilloscope_record_view_reset();
+    segments_browsable = segments_active && started && (0 != oscilloscope_segment_count());
+    if(segments_browsable)
+    {
+        segment_selected = 0;
+        _oscilloscope_segment_display(OSCILLOSCOPE_SEGMENT_OVERLAY);
+    }
     led_pattern_run(LED_GREEN, LED_PATTERN_KEEP_ON, 0);
 }
 
-void oscilloscope_screenshot(void)
+void oscilloscope_channel_enable(oscilloscope_channel_id_t channel, bool enable)
 {
-    // Ensure that both chart series are initialized
-    if (channel1.ui_Chart_series == NULL || channel2.ui_Chart_series == NULL) {
-        return; // Exit if the series are not initialized
+    if((OSCILLOSCOPE_CHANNEL_COUNT <= channel) || (channels[channel].enabled == enable))
+    {
+        return;
     }
 
-    // Copy the y-values from the original chart series to the new series
-    for (uint16_t i = 0; i < POINTS_PER_FRAME; i++) {
-        screenshot_series1->y_points[i] = channel1.ui_Chart_series->y_points[i];
-        screenshot_series2->y_points[i] = channel2.ui_Chart_series->y_points[i];
+    channels[channel].enabled = enable;
+    accumulation_reset = true;
+    if(NULL != channels[channel].ui_Chart_series)
+    {
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[channel].ui_Chart_series,
+                             !enable || (OSCILLOSCOPE_VIEW_XY == view_displayed) || persistence_displayed);
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[channel].ui_Chart_series_min,
+                             !enable || (OSCILLOSCOPE_ACQUISITION_PEAK_DETECT != acquisition_mode) ||
+                             (OSCILLOSCOPE_VIEW_XY == view_displayed));
     }
-}
 
-void oscilloscope_display_screenshot(void)
-{
-    lv_chart_set_ext_y_array(ui_OscilloscopeChart2, screenshot_series1, channel1.measurement_data);
-    lv_chart_set_ext_y_array(ui_OscilloscopeChart2, screenshot_series2, channel2.measurement_data);
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+    /* The scan pattern changes. The DMA task rebuilds the driver between frames, a running scope keeps going. */
+    dma_reconfigure = true;
+#endif
 }
 
-void oscilloscopeCH1_zoom(oscilloscope_zoom_t zoom)
+void oscilloscope_screenshot(void)
 {
-    switch(zoom)
+    if(!started)
     {
-    case OSCILLOSCOPE_ZOOM_IN:
-    if(channel1.sampling_rate > OSCILLOSCOPE_MINIMUM_SAMPLING_RATE)
+        return;
+    }
+
+    /* Whatever the chart shows: frames, roll or a stopped record. */
+    screenshot_capture.channel_mask = 0;
+    screenshot_capture.acquisition = (uint8_t)acquisition_mode;
+    screenshot_capture.chart_min_mv = chart_min_mv;
+    screenshot_capture.chart_max_mv = chart_max_mv;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
     {
-        if(channel1.sampling_rate <= OSCILLOSCOPE_RATE_THRESHOLD)
+        screenshot_capture.sampling_rate[i] = channels[i].sampling_rate;
+        screenshot_capture.column_ns[i] = _oscilloscope_column_ns(&channels[i]);
+        if(channels[i].enabled)
         {
-            channel1.sampling_rate -= OSCILLOSCOPE_ZOOM_INCREMENT / 10;
-            break;
+            screenshot_capture.channel_mask |= 1U << i;
         }
-        channel1.sampling_rate -= OSCILLOSCOPE_ZOOM_INCREMENT;
-    }
-    break;
-    case OSCILLOSCOPE_ZOOM_OUT:
-        if(channel1.sampling_rate < OSCILLOSCOPE_RATE_THRESHOLD)
+
+        for(uint32_t n = 0; n < POINTS_PER_FRAME; n++)
         {
-            channel1.sampling_rate += OSCILLOSCOPE_ZOOM_INCREMENT / 10;
-            break;
+            screenshot_capture.column[i][n] = channels[i].enabled ? channels[i].ui_Chart_series->y_points[n]
+                                                                  : LV_CHART_POINT_NONE;
         }
-        channel1.sampling_rate += OSCILLOSCOPE_ZOOM_INCREMENT;
-    break;
-    default: break;
     }
 
-    lv_label_set_text_fmt(ui_CH1msdiv_label, "%d ms/div", (int)(channel1.sampling_rate / 20.0f));
+    _oscilloscope_screenshot_display(&screenshot_capture);
+    if(!oscilloscope_screenshot_store_save(&screenshot_capture))
+    {
+        ESP_LOGW(TAG, "Screenshot not saved, store busy or not mounted");
+    }
 }
 
-void oscilloscopeCH2_zoom(oscilloscope_zoom_t zoom)
+void oscilloscope_display_screenshot(void)
 {
-    switch(zoom)
-    {
-    case OSCILLOSCOPE_ZOOM_IN:
-    if(channel2.sampling_rate > OSCILLOSCOPE_MINIMUM_SAMPLING_RATE)
+    oscilloscope_screenshot_show(0);
+}
+
+void oscilloscope_screenshot_show(uint32_t age)
+{
+    /* Shown by the timer once read, the chart keeps the current screenshot until then. */
+    if((NULL != oscilloscope_screenshot_timer) && oscilloscope_screenshot_store_load(age))
     {
-        if(channel2.sampling_rate <= OSCILLOSCOPE_RATE_THRESHOLD)
-        {
-            channel2.sampling_rate -= OSCILLOSCOPE_ZOOM_INCREMENT / 10;
-            break;
-        }
-        channel2.sampling_rate -= OSCILLOSCOPE_ZOOM_INCREMENT;
-    }
-    break;
-    case OSCILLOSCOPE_ZOOM_OUT:
-        if(channel2.sampling_rate < OSCILLOSCOPE_RATE_THRESHOLD)
-        {
-            channel2.sampling_rate += OSCILLOSCOPE_ZOOM_INCREMENT / 10;
-            break;
-        }
-        channel2.sampling_rate += OSCILLOSCOPE_ZOOM_INCREMENT;
-    break;
-    default: break;
+        lv_timer_resume(oscilloscope_screenshot_timer);
     }
-    lv_label_set_text_fmt(ui_CH2msdiv_label, "%d ms/div", (int)(channel2.sampling_rate / 20.0f));
+}
+
+void oscilloscope_acquisition_set(oscilloscope_acquisition_t mode)
+{
+    acquisition_mode = mode;
+    accumulation_reset = true;
+    _oscilloscope_timebase_label_update();
+}
+
+void oscilloscope_average_set(uint32_t frames)
+{
+    if((2U > frames) || (OSCILLOSCOPE_AVERAGE_MAX_FRAMES < frames))
+    {
+        return;
+    }
+
+    average_weight = frames;
+    accumulation_reset = true;
+}
+
+void oscilloscope_roll_enable(bool enable)
+{
+    roll_enabled = enable;
+    schedule_pending = true;
+}
+
+void oscilloscope_trigger_set(const oscilloscope_trigger_config_t *config)
+{
+    if((NULL == config) || (OSCILLOSCOPE_CHANNEL_COUNT <= config->source) || (100U < config->pre_trigger_percent))
+    {
+        return;
+    }
+
+    trigger_config = *config;
+    accumulation_reset = true;
+}
+
+void oscilloscope_trigger_get(oscilloscope_trigger_config_t *config)
+{
+    if(NULL != config)
+    {
+        *config = trigger_config;
+    }
+}
+
+void oscilloscope_math_set(oscilloscope_math_t operation)
+{
+    math_operation = operation;
+}
+
+void oscilloscope_filter_set(oscilloscope_channel_id_t channel, const oscilloscope_filter_config_t *config)
+{
+    if((OSCILLOSCOPE_CHANNEL_COUNT <= channel) || (NULL == config))
+    {
+        return;
+    }
+
+    /* Designed by the sampler on its next schedule update. */
+    filter_config[channel] = *config;
+    filter_dirty[channel] = true;
+    schedule_pending = true;
+}
+
+void oscilloscope_persistence_set(oscilloscope_persistence_t mode)
+{
+    persistence_mode = mode;
+    persistence_clear = true;
+}
+
+void oscilloscope_segments_set(uint32_t count)
+{
+    if((1U < count) && !oscilloscope_segment_init())
+    {
+        ESP_LOGE(TAG, "Segment memory allocation failed!");
+        return;
+    }
+    segments_requested = (OSCILLOSCOPE_SEGMENT_MAX < count) ? OSCILLOSCOPE_SEGMENT_MAX : count;
+    schedule_pending = true;
+}
+
+void oscilloscope_segment_show(uint32_t segment)
+{
+    if(running || !segments_browsable ||
+       ((OSCILLOSCOPE_SEGMENT_OVERLAY != segment) && (segment >= oscilloscope_segment_count())))
+    {
+        return;
+    }
+    _oscilloscope_segment_display(segment);
+}
+
+void oscilloscope_view_set(oscilloscope_view_t new_view)
+{
+    view = new_view;
+    schedule_pending = true;
+}
+
+void oscilloscope_fft_window_set(oscilloscope_fft_window_t window)
+{
+    oscilloscope_spectrum_window_set(window);
+}
+
+bool oscilloscope_fft_points_set(uint32_t points)
+{
+    if(!oscilloscope_spectrum_points_set(points))
+    {
+        return false;
+    }
+    schedule_pending = true;
+    return true;
+}
+
+void oscilloscope_autoset(void)
+{
+    view = OSCILLOSCOPE_VIEW_TIME;
+    autoset_requested = true;
+}
+
+void oscilloscope_measurement_panel_set(oscilloscope_channel_id_t channel, const oscilloscope_measurement_t *items,
+                                        uint32_t count)
+{
+    if((OSCILLOSCOPE_CHANNEL_COUNT <= channel) || ((NULL == items) && (0 != count)) ||
+       (OSCILLOSCOPE_MEASUREMENT_PANEL_ITEMS < count))
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        panel_items[channel][i] = items[i];
+    }
+    panel_item_count[channel] = count;
+}
+
+void oscilloscopeCH1_zoom(oscilloscope_zoom_t zoom)
+{
+    if(!running && segments_browsable)
+    {
+        /* Stopped after a sequence: CH1 - overlays all segments, CH1 + shows one. */
+        _oscilloscope_segment_display((OSCILLOSCOPE_ZOOM_OUT == zoom) ? OSCILLOSCOPE_SEGMENT_OVERLAY : segment_selected);
+        return;
+    }
+
+    if(!running && record_browsable)
+    {
+        /* Stopped: CH1 +/- zoom through the record. */
+        oscilloscope_record_zoom(zoom);
+        _oscilloscope_record_display();
+        return;
+    }
+
+    _oscilloscope_channel_zoom(OSCILLOSCOPE_CH1, zoom);
+    _oscilloscope_timebase_label_update();
+}
+
+void oscilloscopeCH2_zoom(oscilloscope_zoom_t zoom)
+{
+    if(!running && segments_browsable)
+    {
+        /* Stopped after a sequence: CH2 + steps to the next segment, CH2 - to the previous one. */
+        uint32_t count = oscilloscope_segment_count();
+        segment_selected = (segment_selected + ((OSCILLOSCOPE_ZOOM_IN == zoom) ? 1U : (count - 1U))) % count;
+        _oscilloscope_segment_display(segment_selected);
+        return;
+    }
+
+    if(!running && record_browsable)
+    {
+        /* Stopped: CH2 + pans towards the newest samples, CH2 - towards the oldest. */
+        oscilloscope_record_pan(OSCILLOSCOPE_ZOOM_IN == zoom);
+        _oscilloscope_record_display();
+        return;
+    }
+
+    _oscilloscope_channel_zoom(OSCILLOSCOPE_CH2, zoom);
+    _oscilloscope_timebase_label_update();
 }
 
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
-void _oscilloscope_sample_timer_callback_ch1(void* arg)
+void _oscilloscope_sample_timer_callback(void* arg)
+{
+    oscilloscope_sample_set_t set = {.timestamp_us = esp_timer_get_time()};
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(channels[i].acquiring)
+        {
+            set.voltage[i] = adc_oneshot_get_voltage(channels[i].adc_channel);
+        }
+    }
+
+    uint32_t tick = scheduler_tick;
+    if(_oscilloscope_process_sample_set(&set) && (CAPTURE_COMPLETE == capture_state))
+    {
+        /* Single sweep done. */
+        esp_timer_stop(oscilloscope_sample_timer);
+    }
+    else if(tick != scheduler_tick)
+    {
+        /* Timebase changed with zoom, acquisition or roll mode. */
+        esp_timer_restart(oscilloscope_sample_timer, scheduler_tick);
+    }
+}
+
+static void _oscilloscope_dma_task(void *pvParameters)
+{
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+    adc_dma_frame_t frame;
+    oscilloscope_sample_set_t set = {0};
+
+    for(;;)
+    {
+        if(dma_reconfigure)
+        {
+            _oscilloscope_dma_reconfigure();
+        }
+
+        if(!dma_configured)
+        {
+            /* Driver is configured on the first start. */
+            vTaskDelay(pdMS_TO_TICKS(OSCILLOSCOPE_DMA_TIMEOUT_MS));
+            continue;
+        }
+
+        if(!adc_dma_frame_take(&frame, pdMS_TO_TICKS(OSCILLOSCOPE_DMA_TIMEOUT_MS)))
+        {
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        uint32_t s = 0;
+        const uint16_t *scan = frame.samples;
+        for(; s < frame.scan_count; s++, scan += dma_channel_count)
+        {
+            set.timestamp_us = frame.timestamp_us + (int64_t)s * OSCILLOSCOPE_DMA_SCAN_PERIOD;
+            for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+            {
+                if(OSCILLOSCOPE_CHANNEL_COUNT != dma_slot[i])
+                {
+                    set.voltage[i] = scan[dma_slot[i]];
+                }
+            }
+
+            if(_oscilloscope_process_sample_set(&set) && (CAPTURE_COMPLETE == capture_state))
+            {
+                /* Single sweep or segment sequence done, as the sample timer stops. The rest of the frame and
+                   the frames still queued are dropped. A start in the meantime has re-armed the capture. */
+                xSemaphoreTake(dma_driver_mutex, portMAX_DELAY);
+                if(CAPTURE_COMPLETE == capture_state)
+                {
+                    adc_dma_stop();
+                }
+                xSemaphoreGive(dma_driver_mutex);
+                s++;
+                break;
+            }
+        }
+        sampler_time_us += esp_timer_get_time() - start_us;
+        sampler_sets += s;
+
+        adc_dma_frame_release();
+    }
+#else
+    vTaskDelete(NULL);
+#endif
+}
+
+static bool _oscilloscope_process_sample_set(const oscilloscope_sample_set_t *set)
+{
+    bool frame_complete = false;
+    bool acquired = false;      // At least one channel took this set
+    bool finished = true;       // Every channel that took it has its post-trigger part
+    oscilloscope_channel_t *source = &channels[trigger_source];
+
+    if(CAPTURE_COMPLETE == capture_state)
+    {
+        /* Waits for the next start, the samplers stop on completion but may still deliver some sets. */
+        return false;
+    }
+
+    if(autoset_requested)
+    {
+        /* Drop the frame in progress, the first autoset frame starts now. */
+        autoset_requested = false;
+        _oscilloscope_autoset_begin();
+        _oscilloscope_update_schedule();
+        _oscilloscope_restart_acquisition();
+        return false;
+    }
+
+    if(roll_active)
+    {
+        if(schedule_pending)
+        {
+            /* Timebase changed, may leave roll mode. */
+            _oscilloscope_update_schedule();
+            _oscilloscope_restart_acquisition();
+            return false;
+        }
+
+        /* No trigger and no frames, every kept sample goes straight to the display. */
+        for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+        {
+            oscilloscope_channel_t *channel = &channels[i];
+            if(!channel->acquiring)
+            {
+                continue;
+            }
+
+            uint16_t kept;
+            if(_oscilloscope_decimate(channel, set->voltage[i], &kept))
+            {
+                kept = oscilloscope_filter_sample(&channel->filter, kept);
+                _oscilloscope_roll_push((oscilloscope_channel_id_t)i, kept);
+                oscilloscope_record_push((oscilloscope_channel_id_t)i, kept);
+            }
+        }
+        return false;
+    }
+
+    /* The trigger runs on the samples the source channel keeps. */
+    if((CAPTURE_ARMED == capture_state) && source->acquiring && (0 == source->decimation_counter))
+    {
+        uint16_t voltage = set->voltage[trigger_source];
+        bool crossed = oscilloscope_trigger_process(&trigger, voltage);
+        if((crossed || trigger_force) && (source->filled >= pre_trigger_points) &&
+           (set->timestamp_us >= holdoff_end_us))
+        {
+            _oscilloscope_trigger_fire(set->timestamp_us,
+                                       crossed ? _oscilloscope_trigger_phase(trigger_previous, voltage) : 0);
+        }
+        trigger_previous = voltage;
+    }
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        oscilloscope_channel_t *channel = &channels[i];
+        if(!channel->acquiring)
+        {
+            continue;
+        }
+
+        uint16_t kept;
+        if(_oscilloscope_decimate(channel, set->voltage[i], &kept))
+        {
+            kept = oscilloscope_filter_sample(&channel->filter, kept);
+            _oscilloscope_store_sample(channel, kept);
+            oscilloscope_record_push((oscilloscope_channel_id_t)i, kept);
+        }
+
+        acquired = true;
+        finished = finished && !channel->acquiring;
+    }
+
+    frame_complete = acquired && finished;
+    if(frame_complete)
+    {
+        if(segments_active && !_oscilloscope_segment_next())
+        {
+            /* Re-armed, the sequence goes on without a frame. */
+            return false;
+        }
+
+        bool published = true;
+        if(OSCILLOSCOPE_VIEW_SPECTRUM == capture_view)
+        {
+            _oscilloscope_publish_spectrum();
+        }
+        else if(ets_active && !_oscilloscope_ets_collect())
+        {
+            /* Equivalent-time frame still has gaps, acquire again. */
+            published = false;
+        }
+        else
+        {
+            _oscilloscope_publish_frame();
+        }
+
+        if(autoset_active)
+        {
+            _oscilloscope_autoset_step();
+        }
+
+        if(published && ((OSCILLOSCOPE_SWEEP_SINGLE == trigger_config.sweep) || segments_active) && !autoset_active)
+        {
+            capture_state = CAPTURE_COMPLETE;
+        }
+        else
+        {
+            /* Timebases may have changed with zoom. */
+            _oscilloscope_update_schedule();
+            _oscilloscope_restart_acquisition();
+        }
+    }
+
+    return frame_complete;
+}
+
+static void _oscilloscope_store_sample(oscilloscope_channel_t *channel, uint32_t voltage)
 {
-    uint32_t voltage = adc_oneshot_get_voltage(ADC_CHANNEL_3);
-    channel1.measurement_data[channel1.index++] = voltage;
+    channel->capture[channel->index] = voltage;
+    if(capture_points == ++channel->index)
+    {
+        channel->index = 0;
+    }
 
-    if(voltage > channel1.max_voltage)
+    if(capture_points > channel->filled)
     {
-        channel1.max_voltage = voltage;
+        channel->filled++;
     }
 
-    if(voltage < channel1.min_voltage)
+    if((CAPTURE_TRIGGERED == capture_state) && (0 == --channel->post_trigger))
     {
-        channel1.min_voltage = voltage;
+        channel->acquiring = false;
     }
+}
 
-    if(POINTS_PER_FRAME == channel1.index)
+static uint32_t _oscilloscope_trigger_phase(uint16_t previous, uint16_t voltage)
+{
+    int32_t level = trigger.level;
+    bool rising = (previous < level) && (voltage >= level);
+    bool falling = (previous > level) && (voltage <= level);
+    if(!rising && !falling)
     {
-        channel1.index = 0;
-        esp_timer_stop(channel1.sample_timer);
+        return 0;
     }
+
+    /* Linear interpolation, the crossing lies within one sample period of the source. */
+    uint32_t sample_period_ns = channels[trigger_source].decimation * scheduler_tick * 1000U;
+    return (uint32_t)(((int64_t)(voltage - level) * sample_period_ns) / (voltage - previous));
 }
 
-void _oscilloscope_sample_timer_callback_ch2(void* arg)
+static bool _oscilloscope_ets_collect(void)
 {
-    uint32_t voltage = adc_oneshot_get_voltage(ADC_CHANNEL_6);
-    channel2.measurement_data[channel2.index++] = voltage;
+    bool complete = true;
+    uint32_t sample_period_ns = scheduler_tick * 1000U;
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        oscilloscope_channel_t *channel = &channels[i];
+        if(!channel->enabled)
+        {
+            continue;
+        }
 
-    if(voltage > channel2.max_voltage)
+        /* The oldest sample is pre_trigger_points before the trigger sample, the level crossing is
+         * trigger_phase_ns before it and the left edge of the frame is the pre-trigger time before the crossing. */
+        uint32_t column_ns = _oscilloscope_column_ns(channel);
+        uint32_t start = (capture_points == channel->filled) ? channel->index : 0;
+        int64_t pre_trigger_ns = ((int64_t)column_ns * POINTS_PER_FRAME * trigger_config.pre_trigger_percent) / 100;
+        int32_t first_offset_ns = (int32_t)(pre_trigger_ns + trigger_phase_ns -
+                                            (int64_t)pre_trigger_points * sample_period_ns);
+
+        oscilloscope_ets_add(&ets[i], channel->capture, capture_points, start, first_offset_ns, sample_period_ns,
+                             column_ns);
+        complete = complete && oscilloscope_ets_complete(&ets[i]);
+    }
+
+    return complete || (OSCILLOSCOPE_ETS_MAX_ACQUISITIONS <= ++ets_acquisitions);
+}
+
+static void _oscilloscope_ets_reset(void)
+{
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
     {
-        channel2.max_voltage = voltage;
+        oscilloscope_ets_reset(&ets[i]);
     }
+    ets_acquisitions = 0;
+}
 
-    if(voltage < channel2.min_voltage)
+static uint32_t _oscilloscope_column_ns(const oscilloscope_channel_t *channel)
+{
+    uint32_t column_ns = channel->sampling_rate * 1000U;
+    if(OSCILLOSCOPE_ACQUISITION_EQUIVALENT_TIME == acquisition_mode)
     {
-        channel2.min_voltage = voltage;
+        column_ns /= OSCILLOSCOPE_ETS_FACTOR;
     }
+    return column_ns;
+}
+
+static void _oscilloscope_timebase_label_update(void)
+{
+    /* One division is 50 columns, CH3 has no label. */
+    lv_obj_t *labels[] = {ui_CH1msdiv_label, ui_CH2msdiv_label};
 
-    if(POINTS_PER_FRAME == channel2.index)
+    for(uint32_t i = 0; i < sizeof(labels) / sizeof(labels[0]); i++)
     {
-        channel2.index = 0;
-        esp_timer_stop(channel2.sample_timer);
+        uint32_t division_us = (_oscilloscope_column_ns(&channels[i]) * 50U) / 1000U;
+        if(1000U <= division_us)
+        {
+            lv_label_set_text_fmt(labels[i], "%d ms/div", (int)(division_us / 1000U));
+        }
+        else
+        {
+            lv_label_set_text_fmt(labels[i], "%d us/div", (int)division_us);
+        }
     }
 }
 
-void _oscilloscope_timer_for_screen(void* arg)
+static void _oscilloscope_record_reset(void)
 {
-    esp_timer_stop(oscilloscope_screen_timer);
-    vTaskNotifyGiveFromISR(oscilloscope_draw_task_handle, NULL);
+    uint32_t sample_period_us[OSCILLOSCOPE_CHANNEL_COUNT];
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        sample_period_us[i] = channels[i].enabled ? channels[i].decimation * scheduler_tick : 0;
+    }
+    oscilloscope_record_reset(sample_period_us);
 }
 
-void _draw_waveform(void)
+static void _oscilloscope_record_display(void)
 {
-    /* Draw channel 1. */
-    lv_chart_set_ext_y_array(ui_OscilloscopeChart, channel1.ui_Chart_series, channel1.measurement_data);
+    if(roll_displayed)
+    {
+        _oscilloscope_roll_display(false);
+    }
+    if(OSCILLOSCOPE_VIEW_TIME != view_displayed)
+    {
+        _oscilloscope_view_display(OSCILLOSCOPE_VIEW_TIME);
+    }
 
-    /* Draw channel 2. */
-    lv_chart_set_ext_y_array(ui_OscilloscopeChart, channel2.ui_Chart_series, channel2.measurement_data);
+    oscilloscope_record_render(&record_view);
+    lv_chart_hide_series(ui_OscilloscopeChart, math_series, true);
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        bool envelope = record_view.enabled[i] && record_view.envelope;
 
-    /* Refresh Vpp values. */
-    lv_label_set_text_fmt(ui_Ch1Vpp, "CH1: %d mVpp", (int)(channel1.max_voltage - channel1.min_voltage));
-    lv_label_set_text_fmt(ui_Ch2Vpp, "CH2: %d mVpp", (int)(channel2.max_voltage - channel2.min_voltage));
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, !envelope);
+        if(record_view.enabled[i])
+        {
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series, record_view.column_max[i]);
+        }
+        if(envelope)
+        {
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, record_view.column_min[i]);
+        }
+    }
 
+    /* Time on the screen and its distance from the end of the record. */
+    lv_label_set_text_fmt(oscilloscope_stats_label, "REC %d.%d ms -%d.%d ms", (int)(record_view.span_us / 1000U),
+                          (int)((record_view.span_us % 1000U) / 100U), (int)(record_view.end_us / 1000U),
+                          (int)((record_view.end_us % 1000U) / 100U));
     lv_chart_refresh(ui_OscilloscopeChart);
 }
 
-void _draw_waveform_task(void * pvParameters)
+static bool _oscilloscope_segment_next(void)
 {
-    for(;;)
+    const uint16_t *capture[OSCILLOSCOPE_CHANNEL_COUNT];
+    uint32_t start[OSCILLOSCOPE_CHANNEL_COUNT];
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        capture[i] = channels[i].enabled ? channels[i].capture : NULL;
+        start[i] = (capture_points == channels[i].filled) ? channels[i].index : 0;
+    }
+    if(oscilloscope_segment_store(capture, start, trigger_timestamp_us))
+    {
+        return true;
+    }
+
+    /* Unlike a restart, the capture keeps running: its newest samples are already the pre-trigger part of
+     * the next segment, so the next kept sample can trigger. */
+    trigger_force = false;
+    capture_state = CAPTURE_ARMED;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        channels[i].acquiring = channels[i].enabled;
+    }
+    return false;
+}
+
+static void _oscilloscope_segment_display(uint32_t segment)
+{
+    uint32_t count = oscilloscope_segment_count();
+    int64_t first_us = oscilloscope_segment_timestamp_us(0);
+
+    if(roll_displayed)
     {
-        xTaskNotifyWait(0x00, ULONG_MAX, NULL, portMAX_DELAY);
-        _draw_waveform();
+        _oscilloscope_roll_display(false);
+    }
+    if(OSCILLOSCOPE_VIEW_TIME != view_displayed)
+    {
+        _oscilloscope_view_display(OSCILLOSCOPE_VIEW_TIME);
+    }
+    lv_chart_hide_series(ui_OscilloscopeChart, math_series, true);
+
+    if((OSCILLOSCOPE_SEGMENT_OVERLAY == segment) && !_oscilloscope_persistence_allocate())
+    {
+        /* No memory for the overlay, show the last segment. */
+        segment = count - 1;
+    }
+    if(OSCILLOSCOPE_SEGMENT_OVERLAY == segment)
+    {
+        /* Every segment of every channel as hits on the persistence image, the sampler starts a new one. */
+        oscilloscope_persistence_configure(&persistence, persistence.intensity, persistence.width,
+                                           persistence.height, chart_min_mv, chart_max_mv);
+        for(uint32_t s = 0; s < count; s++)
+        {
+            for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+            {
+                const uint16_t *data = oscilloscope_segment_data(s, (oscilloscope_channel_id_t)i);
+                if(NULL != data)
+                {
+                    oscilloscope_persistence_accumulate(&persistence, data, OSCILLOSCOPE_SEGMENT_POINTS, 0);
+                }
+            }
+        }
+        persistence_clear = true;
+        _oscilloscope_persistence_display(true);
+        lv_obj_invalidate(persistence_canvas);
 
-        _reset_max_and_min_voltage();
+        int64_t span_us = oscilloscope_segment_timestamp_us(count - 1) - first_us;
+        lv_label_set_text_fmt(oscilloscope_stats_label, "SEG x%u %d.%03d ms", (unsigned)count,
+                              (int)(span_us / 1000), (int)(span_us % 1000));
+    }
+    else
+    {
+        _oscilloscope_persistence_display(false);
+        for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+        {
+            const uint16_t *data = oscilloscope_segment_data(segment, (oscilloscope_channel_id_t)i);
+            lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series, NULL == data);
+            lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, true);
+            if(NULL != data)
+            {
+                lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series, (lv_coord_t *)data);
+            }
+        }
 
-        esp_timer_start_periodic(channel1.sample_timer, channel1.sampling_rate);
-        esp_timer_start_periodic(channel2.sample_timer, channel2.sampling_rate);
-        esp_timer_start_periodic(oscilloscope_screen_timer, OSCILLOSCOPE_SCREEN_REFRESH_RATE);
+        /* Trigger time from the first segment of the sequence. */
+        int64_t offset_us = oscilloscope_segment_timestamp_us(segment) - first_us;
+        lv_label_set_text_fmt(oscilloscope_stats_label, "SEG %u/%u +%d.%03d ms", (unsigned)(segment + 1),
+                              (unsigned)count, (int)(offset_us / 1000), (int)(offset_us % 1000));
     }
+
+    lv_chart_refresh(ui_OscilloscopeChart);
 }
 
-void _reset_max_and_min_voltage(void)
+static bool _oscilloscope_decimate(oscilloscope_channel_t *channel, uint16_t voltage, uint16_t *kept)
 {
-    channel1.max_voltage = OSCILLOSCOPE_MIN_VOLTAGE;
-    channel1.min_voltage = OSCILLOSCOPE_MAX_VOLTAGE;
+    bool ready;
+
+    if(OSCILLOSCOPE_ACQUISITION_HIGH_RES == acquisition_mode)
+    {
+        /* Box filter over all ticks of the column, stored on its last tick. */
+        channel->oversample_sum += voltage;
+        ready = (channel->decimation_counter + 1 >= channel->decimation);
+        if(ready)
+        {
+            *kept = (uint16_t)((channel->oversample_sum + channel->decimation / 2) / channel->decimation);
+            channel->oversample_sum = 0;
+        }
+    }
+    else
+    {
+        ready = (0 == channel->decimation_counter);
+        *kept = voltage;
+    }
 
-    channel2.max_voltage = OSCILLOSCOPE_MIN_VOLTAGE;
-    channel2.min_voltage = OSCILLOSCOPE_MAX_VOLTAGE;
+    if(++channel->decimation_counter >= channel->decimation)
+    {
+        channel->decimation_counter = 0;
+    }
+    return ready;
+}
+
+static void _oscilloscope_trigger_fire(int64_t timestamp_us, uint32_t phase_ns)
+{
+    /* The trigger sample is the first post-trigger sample. */
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        channels[i].post_trigger = capture_points - pre_trigger_points;
+    }
+
+    trigger_timestamp_us = timestamp_us;
+    trigger_phase_ns = phase_ns;
+    holdoff_end_us = timestamp_us + trigger_config.holdoff_us;
+    trigger_force = false;
+    capture_state = CAPTURE_TRIGGERED;
+}
+
+static void _oscilloscope_publish_frame(void)
+{
+    oscilloscope_frame_t *frame = &frames[oscilloscope_triple_buffer_back(&frame_buffer)];
+
+    frame->envelope = !ets_active && (POINTS_PER_FRAME != capture_points);
+    frame->trigger_timestamp_us = trigger_timestamp_us;
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        oscilloscope_channel_t *channel = &channels[i];
+        frame->enabled[i] = channel->enabled;
+        if(!channel->enabled)
+        {
+            continue;
+        }
+
+        /* Oldest sample is at the write position once the buffer has wrapped. */
+        uint32_t start = (capture_points == channel->filled) ? channel->index : 0;
+        if(ets_active)
+        {
+            oscilloscope_ets_resolve(&ets[i], frame->column_max[i]);
+        }
+        else
+        {
+            oscilloscope_minmax_reduce(channel->capture, capture_points, start, frame->column_min[i],
+                                       frame->column_max[i], POINTS_PER_FRAME);
+        }
+        if(OSCILLOSCOPE_ACQUISITION_AVERAGE == acquisition_mode)
+        {
+            oscilloscope_average_update(average_accumulator[i], frame->column_max[i], POINTS_PER_FRAME,
+                                        average_frames, average_weight);
+            if(POINTS_PER_FRAME == capture_points)
+            {
+                /* One sample per column: the average replaces the capture, so the measurements, the
+                   persistence image and the math trace see the averaged signal as well. The capture
+                   starts over with the next frame. */
+                for(uint32_t n = 0; n < POINTS_PER_FRAME; n++)
+                {
+                    channel->capture[(start + n) % POINTS_PER_FRAME] = (uint16_t)frame->column_max[i][n];
+                }
+            }
+        }
+
+        /* Measured on the full capture, edges against the levels of the previous frame. */
+        oscilloscope_measure(channel->capture, capture_points, start, channel->decimation * scheduler_tick * 1000U,
+                             &channel->levels, &channel->measurements);
+        oscilloscope_measure_levels(&channel->measurements, &channel->levels);
+        frame->measurements[i] = channel->measurements;
+    }
+
+    _oscilloscope_math_update(frame);
+    _oscilloscope_persistence_update();
+
+    /* CH1 and CH2 share the decimation in the XY view, so sample n of both is from the same scan. */
+    frame->xy = (OSCILLOSCOPE_VIEW_XY == capture_view);
+    frame->xy_count = 0;
+    if(frame->xy && frame->enabled[OSCILLOSCOPE_CH1] && frame->enabled[OSCILLOSCOPE_CH2])
+    {
+        oscilloscope_channel_t *x = &channels[OSCILLOSCOPE_CH1];
+        frame->xy_count = oscilloscope_xy_reduce(x->capture, channels[OSCILLOSCOPE_CH2].capture, capture_points,
+                                                 (capture_points == x->filled) ? x->index : 0, frame->xy_x,
+                                                 frame->xy_y, OSCILLOSCOPE_XY_POINTS);
+    }
+
+    if((OSCILLOSCOPE_ACQUISITION_AVERAGE == acquisition_mode) && (average_weight > average_frames))
+    {
+        average_frames++;
+    }
+    if(ets_active)
+    {
+        _oscilloscope_ets_reset();
+    }
+
+    frame->publish_timestamp_us = esp_timer_get_time();
+    oscilloscope_triple_buffer_publish(&frame_buffer);
+}
+
+static void _oscilloscope_update_schedule(void)
+{
+    capture_view = view;
+    capture_points = (OSCILLOSCOPE_ACQUISITION_PEAK_DETECT == acquisition_mode) ? OSCILLOSCOPE_DEEP_CAPTURE_POINTS :
+                                                                                POINTS_PER_FRAME;
+    if(OSCILLOSCOPE_VIEW_SPECTRUM == capture_view)
+    {
+        capture_points = oscilloscope_spectrum_points_get();
+    }
+    else if(OSCILLOSCOPE_VIEW_XY == capture_view)
+    {
+        capture_points = OSCILLOSCOPE_DEEP_CAPTURE_POINTS;
+    }
+
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+    scheduler_tick = OSCILLOSCOPE_DMA_SCAN_PERIOD;
+#else
+    scheduler_tick = UINT32_MAX;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(channels[i].enabled && (channels[i].sampling_rate < scheduler_tick))
+        {
+            scheduler_tick = channels[i].sampling_rate;
+        }
+    }
+    if(UINT32_MAX == scheduler_tick)
+    {
+        scheduler_tick = DEFAULT_SAMPLING_RATE_CH1;
+    }
+    scheduler_tick = (scheduler_tick * POINTS_PER_FRAME) / capture_points;
+    if(OSCILLOSCOPE_MINIMUM_SAMPLING_RATE > scheduler_tick)
+    {
+        scheduler_tick = OSCILLOSCOPE_MINIMUM_SAMPLING_RATE;
+    }
+#endif
+
+    frame_duration_us = 0;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(channels[i].enabled && (channels[i].sampling_rate * POINTS_PER_FRAME > frame_duration_us))
+        {
+            frame_duration_us = channels[i].sampling_rate * POINTS_PER_FRAME;
+        }
+    }
+
+    /* Slow timebases roll, one sample per column, so nothing is waiting for a frame to fill. */
+    schedule_pending = false;
+    roll_active = roll_enabled && (OSCILLOSCOPE_VIEW_TIME == capture_view) &&
+                  (OSCILLOSCOPE_ROLL_THRESHOLD_US <= frame_duration_us);
+    if(roll_active)
+    {
+        capture_points = POINTS_PER_FRAME;
+    }
+
+    /* Segments hold one sample per display column. */
+    segments_active = (1U < segments_requested) && (OSCILLOSCOPE_VIEW_TIME == capture_view) && !roll_active &&
+                      !autoset_active;
+    if(segments_active)
+    {
+        capture_points = OSCILLOSCOPE_SEGMENT_POINTS;
+    }
+
+    /* Equivalent time keeps every tick, the capture covers the longest frame of the enabled channels. */
+    ets_active = (OSCILLOSCOPE_ACQUISITION_EQUIVALENT_TIME == acquisition_mode) &&
+                 (OSCILLOSCOPE_VIEW_TIME == capture_view) && !roll_active && !autoset_active && !segments_active;
+    if(ets_active)
+    {
+        uint32_t frame_ns = 0;
+        for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+        {
+            if(channels[i].enabled && (_oscilloscope_column_ns(&channels[i]) * POINTS_PER_FRAME > frame_ns))
+            {
+                frame_ns = _oscilloscope_column_ns(&channels[i]) * POINTS_PER_FRAME;
+            }
+        }
+
+        capture_points = frame_ns / (scheduler_tick * 1000U) + 1;
+        if(2U > capture_points)
+        {
+            capture_points = 2U;
+        }
+        if(OSCILLOSCOPE_CAPTURE_BUFFER_POINTS < capture_points)
+        {
+            capture_points = OSCILLOSCOPE_CAPTURE_BUFFER_POINTS;
+        }
+    }
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        /* Sample period of the capture, rounded to the nearest whole number of ticks. */
+        uint32_t tick_per_frame = scheduler_tick * capture_points;
+        uint32_t decimation = (channels[i].sampling_rate * POINTS_PER_FRAME + tick_per_frame / 2) / tick_per_frame;
+        if((0 == decimation) || ets_active)
+        {
+            decimation = 1;
+        }
+        if((OSCILLOSCOPE_VIEW_XY == capture_view) && (OSCILLOSCOPE_CH1 != i))
+        {
+            /* XY pairs samples by index, every channel follows the CH1 timebase. */
+            decimation = channels[OSCILLOSCOPE_CH1].decimation;
+        }
+
+        /* A new timebase starts a new average, equivalent-time frame and record. */
+        if(decimation != channels[i].decimation)
+        {
+            accumulation_reset = true;
+        }
+        channels[i].decimation = decimation;
+    }
+
+    /* Filters run at the rate of the kept samples. Redesigned only when it changes, so the state carries over
+     * from frame to frame. Equivalent time interleaves acquisitions and is never filtered. */
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        uint32_t rate_hz = ets_active ? 0 : 1000000U / (scheduler_tick * channels[i].decimation);
+        if(filter_dirty[i] || (rate_hz != channels[i].filter_rate_hz))
+        {
+            filter_dirty[i] = false;
+            channels[i].filter_rate_hz = rate_hz;
+            if(!oscilloscope_filter_design(&channels[i].filter, &filter_config[i], rate_hz) && (0 != rate_hz))
+            {
+                ESP_LOGW(TAG, "CH%u filter does not fit a sample rate of %u Hz, bypassed", (unsigned)(i + 1),
+                         (unsigned)rate_hz);
+            }
+        }
+    }
+
+    if(accumulation_reset)
+    {
+        accumulation_reset = false;
+        persistence_clear = true;
+        average_frames = 0;
+        _oscilloscope_ets_reset();
+        _oscilloscope_record_reset();
+    }
+}
+
+static void _oscilloscope_restart_acquisition(void)
+{
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        channels[i].index = 0;
+        channels[i].filled = 0;
+        channels[i].decimation_counter = 0;
+        channels[i].oversample_sum = 0;
+    }
+
+    /* Apply the trigger configuration for the next frame. At least one sample is post-trigger. */
+    trigger_source = trigger_config.source;
+    for(uint32_t i = 0; (i < OSCILLOSCOPE_CHANNEL_COUNT) && !channels[trigger_source].enabled; i++)
+    {
+        /* Source is disabled, trigger on the first enabled channel. */
+        trigger_source = (oscilloscope_channel_id_t)i;
+    }
+    pre_trigger_points = (capture_points * trigger_config.pre_trigger_percent) / 100U;
+    if(capture_points <= pre_trigger_points)
+    {
+        pre_trigger_points = capture_points - 1;
+    }
+    /* The spectrum view and autoset run free, a trigger does not change the spectrum or the period. */
+    oscilloscope_trigger_configure(&trigger,
+                                   ((OSCILLOSCOPE_VIEW_SPECTRUM == capture_view) || autoset_active) ?
+                                   OSCILLOSCOPE_TRIGGER_NONE : trigger_config.type,
+                                   trigger_config.level, trigger_config.hysteresis);
+    trigger_force = false;
+    capture_state = CAPTURE_ARMED;
+    if(segments_active)
+    {
+        oscilloscope_segment_reset(segments_requested);
+    }
+
+    /* Set acquiring flags last, all channels start in the same tick. */
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        channels[i].acquiring = channels[i].enabled;
+    }
+}
+
+static void _oscilloscope_channel_zoom(oscilloscope_channel_id_t channel, oscilloscope_zoom_t zoom)
+{
+    oscilloscope_channel_t *ch = &channels[channel];
+
+    switch(zoom)
+    {
+    case OSCILLOSCOPE_ZOOM_IN:
+    if(ch->sampling_rate > OSCILLOSCOPE_MINIMUM_SAMPLING_RATE)
+    {
+        if(ch->sampling_rate <= OSCILLOSCOPE_RATE_THRESHOLD)
+        {
+            ch->sampling_rate -= OSCILLOSCOPE_ZOOM_INCREMENT / 10;
+            break;
+        }
+        ch->sampling_rate -= OSCILLOSCOPE_ZOOM_INCREMENT;
+    }
+    break;
+    case OSCILLOSCOPE_ZOOM_OUT:
+        if(ch->sampling_rate < OSCILLOSCOPE_RATE_THRESHOLD)
+        {
+            ch->sampling_rate += OSCILLOSCOPE_ZOOM_INCREMENT / 10;
+            break;
+        }
+        ch->sampling_rate += OSCILLOSCOPE_ZOOM_INCREMENT;
+    break;
+    default: break;
+    }
+
+    schedule_pending = true;
+    accumulation_reset = true;
+}
+
+#if OSCILLOSCOPE_USE_DMA_ACQUISITION
+static bool _oscilloscope_dma_configure(void)
+{
+    adc_dma_config_t dma_config = {
+        .channel_count = 0,
+        .scan_rate_hz = 1000000U / OSCILLOSCOPE_DMA_SCAN_PERIOD,
+    };
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        dma_slot[i] = OSCILLOSCOPE_CHANNEL_COUNT;
+        if(channels[i].enabled)
+        {
+            dma_slot[i] = dma_config.channel_count;
+            dma_config.channels[dma_config.channel_count++] = channels[i].adc_channel;
+        }
+    }
+
+    if(0 == dma_config.channel_count)
+    {
+        return false;
+    }
+
+    dma_config.frame_scans = ADC_DMA_MAX_FRAME_SAMPLES / dma_config.channel_count;
+    if(OSCILLOSCOPE_DMA_FRAME_SCANS < dma_config.frame_scans)
+    {
+        dma_config.frame_scans = OSCILLOSCOPE_DMA_FRAME_SCANS;
+    }
+
+    dma_channel_count = dma_config.channel_count;
+    dma_configured = (ADC_INITIALIZATION_SUCCESS == adc_dma_init(&dma_config));
+    return dma_configured;
+}
+
+static void _oscilloscope_dma_reconfigure(void)
+{
+    xSemaphoreTake(dma_driver_mutex, portMAX_DELAY);
+    dma_reconfigure = false;
+    if(_oscilloscope_dma_configure())
+    {
+        if(running)
+        {
+            _oscilloscope_restart_acquisition();
+            adc_dma_start();
+        }
+    }
+    else
+    {
+        /* No channel left to scan, the next enabled channel or start configures the driver again. */
+        adc_dma_stop();
+        dma_configured = false;
+    }
+    xSemaphoreGive(dma_driver_mutex);
+}
+#endif
+
+void _draw_waveform(const oscilloscope_frame_t *frame)
+{
+    if(frame->xy != (OSCILLOSCOPE_VIEW_XY == view_displayed))
+    {
+        /* Captured before the view changed. */
+        return;
+    }
+
+    if(frame->xy)
+    {
+        _oscilloscope_xy_render(frame);
+        _oscilloscope_measurement_panel_render(frame);
+        lv_chart_refresh(ui_OscilloscopeChart);
+        return;
+    }
+
+    /* Draw all enabled channels, in peak detect as a band between the column minimums and maximums. */
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        bool envelope = frame->enabled[i] && frame->envelope && !persistence_displayed;
+
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, !envelope);
+        if(frame->enabled[i])
+        {
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series,
+                                     (lv_coord_t *)frame->column_max[i]);
+        }
+        if(envelope)
+        {
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series_min,
+                                     (lv_coord_t *)frame->column_min[i]);
+        }
+    }
+
+    lv_chart_hide_series(ui_OscilloscopeChart, math_series, OSCILLOSCOPE_MATH_OFF == frame->math);
+    if(OSCILLOSCOPE_MATH_OFF != frame->math)
+    {
+        lv_chart_set_ext_y_array(ui_OscilloscopeChart, math_series, (lv_coord_t *)frame->column_math);
+    }
+    _oscilloscope_math_label_update(frame);
+
+    _oscilloscope_measurement_panel_render(frame);
+
+    if(persistence_displayed)
+    {
+        /* Redrawn from the buffer the sampler keeps up to date, no copy. */
+        lv_obj_invalidate(persistence_canvas);
+    }
+
+    lv_chart_refresh(ui_OscilloscopeChart);
+}
+
+static void _oscilloscope_xy_render(const oscilloscope_frame_t *frame)
+{
+    lv_chart_hide_series(ui_OscilloscopeChart, xy_series, 0 == frame->xy_count);
+    if(0 == frame->xy_count)
+    {
+        return;
+    }
+
+    lv_chart_set_point_count(ui_OscilloscopeChart, (uint16_t)frame->xy_count);
+    lv_chart_set_ext_x_array(ui_OscilloscopeChart, xy_series, (lv_coord_t *)frame->xy_x);
+    lv_chart_set_ext_y_array(ui_OscilloscopeChart, xy_series, (lv_coord_t *)frame->xy_y);
+}
+
+static void _oscilloscope_math_update(oscilloscope_frame_t *frame)
+{
+    oscilloscope_math_t operation = math_operation;
+    uint32_t column_ns = _oscilloscope_column_ns(&channels[OSCILLOSCOPE_CH1]);
+
+    /* Both inputs come from the same scans only at the same decimation. */
+    bool single_input = (OSCILLOSCOPE_MATH_DERIVATIVE == operation) || (OSCILLOSCOPE_MATH_INTEGRAL == operation);
+    bool aligned = frame->enabled[OSCILLOSCOPE_CH1] &&
+                   (single_input || (frame->enabled[OSCILLOSCOPE_CH2] &&
+                                     (channels[OSCILLOSCOPE_CH1].decimation == channels[OSCILLOSCOPE_CH2].decimation)));
+
+    frame->math = aligned ? operation : OSCILLOSCOPE_MATH_OFF;
+    frame->math_column_ns = column_ns;
+
+    const lv_coord_t *a = frame->column_max[OSCILLOSCOPE_CH1];
+    const lv_coord_t *b = frame->column_max[OSCILLOSCOPE_CH2];
+    if(frame->envelope && (OSCILLOSCOPE_MATH_OFF != frame->math))
+    {
+        /* The maxima of a column are no sample of the signal and not from the same scan on both channels.
+           The first sample of every column is, at the same position in both captures. */
+        for(uint32_t i = 0; i < 2; i++)
+        {
+            const oscilloscope_channel_t *channel = &channels[OSCILLOSCOPE_CH1 + i];
+            uint32_t start = (capture_points == channel->filled) ? channel->index : 0;
+            for(uint32_t n = 0; n < POINTS_PER_FRAME; n++)
+            {
+                math_input[i][n] = (lv_coord_t)channel->capture[(start + (n * capture_points) / POINTS_PER_FRAME) %
+                                                                capture_points];
+            }
+        }
+        a = math_input[0];
+        b = math_input[1];
+    }
+    oscilloscope_math_compute(frame->math, a, b, frame->column_math, POINTS_PER_FRAME);
+}
+
+static void _oscilloscope_persistence_update(void)
+{
+    oscilloscope_persistence_t mode = persistence_mode;
+    if((OSCILLOSCOPE_PERSISTENCE_OFF == mode) || (OSCILLOSCOPE_VIEW_TIME != capture_view) || ets_active ||
+       (NULL == persistence.intensity))
+    {
+        return;
+    }
+
+    /* Hits of an old timebase or range would sit in the wrong place. */
+    if(persistence_clear || (chart_min_mv != persistence.min_mv) || (chart_max_mv != persistence.max_mv))
+    {
+        persistence_clear = false;
+        oscilloscope_persistence_configure(&persistence, persistence.intensity, persistence.width,
+                                           persistence.height, chart_min_mv, chart_max_mv);
+    }
+
+    /* Every captured sample of every channel, also the ones a column reduction would hide. */
+    oscilloscope_persistence_fade(&persistence, mode);
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        oscilloscope_channel_t *channel = &channels[i];
+        if(channel->enabled)
+        {
+            oscilloscope_persistence_accumulate(&persistence, channel->capture, capture_points,
+                                                (capture_points == channel->filled) ? channel->index : 0);
+        }
+    }
+}
+
+static void _oscilloscope_persistence_display(bool show)
+{
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series,
+                             show || !channels[i].enabled || (OSCILLOSCOPE_VIEW_XY == view_displayed));
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, true);
+    }
+
+    if(show)
+    {
+        lv_obj_clear_flag(persistence_canvas, LV_OBJ_FLAG_HIDDEN);
+    }
+    else
+    {
+        lv_obj_add_flag(persistence_canvas, LV_OBJ_FLAG_HIDDEN);
+    }
+    persistence_displayed = show;
+    lv_chart_refresh(ui_OscilloscopeChart);
+}
+
+static bool _oscilloscope_persistence_allocate(void)
+{
+    if(NULL != persistence_memory)
+    {
+        return true;
+    }
+
+    uint8_t *memory = heap_caps_malloc(OSCILLOSCOPE_PERSISTENCE_MEMORY, MALLOC_CAP_8BIT);
+    if(NULL == memory)
+    {
+        ESP_LOGE(TAG, "Persistence image allocation failed!");
+        return false;
+    }
+    lv_canvas_set_buffer(persistence_canvas, memory, (lv_coord_t)persistence_width, (lv_coord_t)persistence_height,
+                         LV_IMG_CF_INDEXED_8BIT);
+    oscilloscope_persistence_palette((lv_color32_t *)memory);
+
+    /* The sampler starts accumulating once it sees the intensity pointer, so it is published last. */
+    oscilloscope_persistence_buffer_t buffer;
+    uint8_t *intensity = memory + OSCILLOSCOPE_PERSISTENCE_PALETTE * sizeof(lv_color32_t);
+    oscilloscope_persistence_configure(&buffer, intensity, persistence_width, persistence_height, chart_min_mv,
+                                       chart_max_mv);
+    buffer.intensity = NULL;
+    persistence = buffer;
+    __sync_synchronize();
+    persistence.intensity = intensity;
+    persistence_memory = memory;
+    return true;
+}
+
+static void _oscilloscope_math_label_update(const oscilloscope_frame_t *frame)
+{
+    oscilloscope_math_t requested = math_operation;
+    if((frame->math == math_label_operation) && (frame->math_column_ns == math_label_column_ns) &&
+       (requested == math_label_requested))
+    {
+        return;
+    }
+
+    math_label_operation = frame->math;
+    math_label_requested = requested;
+    math_label_column_ns = frame->math_column_ns;
+    uint32_t column_ns = (0 != frame->math_column_ns) ? frame->math_column_ns : 1U;
+
+    /* Scale as the value of 1 V on the chart. */
+    switch(frame->math)
+    {
+    case OSCILLOSCOPE_MATH_ADD:
+        lv_label_set_text(oscilloscope_math_label, "M CH1+CH2 1V=2V");
+        break;
+    case OSCILLOSCOPE_MATH_SUBTRACT:
+        lv_label_set_text(oscilloscope_math_label, "M CH1-CH2 1V=2V 0V=1.65");
+        break;
+    case OSCILLOSCOPE_MATH_MULTIPLY:
+        lv_label_set_text(oscilloscope_math_label, "M CH1xCH2 1V=3.3V2");
+        break;
+    case OSCILLOSCOPE_MATH_DERIVATIVE:
+        lv_label_set_text_fmt(oscilloscope_math_label, "M dCH1/dt 1V=%uV/s 0V=1.65",
+                              (unsigned)(1000000000ULL / ((uint64_t)OSCILLOSCOPE_MATH_DERIVATIVE_GAIN * column_ns)));
+        break;
+    case OSCILLOSCOPE_MATH_INTEGRAL:
+        lv_label_set_text_fmt(oscilloscope_math_label, "M intCH1 1V=%uuVs 0V=1.65",
+                              (unsigned)(((uint64_t)column_ns << OSCILLOSCOPE_MATH_INTEGRAL_SHIFT) / 1000U));
+        break;
+    default:
+        lv_label_set_text(oscilloscope_math_label, (OSCILLOSCOPE_MATH_OFF == requested) ? "" : "M needs CH1/CH2 aligned");
+        break;
+    }
+}
+
+static void _oscilloscope_render_timer_callback(lv_timer_t *timer)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    bool persistence = (OSCILLOSCOPE_PERSISTENCE_OFF != persistence_mode) && !roll_active &&
+                       (OSCILLOSCOPE_VIEW_TIME == view) && _oscilloscope_persistence_allocate();
+    if(persistence != persistence_displayed)
+    {
+        _oscilloscope_persistence_display(persistence);
+    }
+
+    if(roll_active != roll_displayed)
+    {
+        _oscilloscope_roll_display(roll_active);
+    }
+
+    if(roll_displayed)
+    {
+        _oscilloscope_roll_render();
+        last_render_us = now_us;
+        stats_frames++;
+        _oscilloscope_update_render_stats(now_us);
+        return;
+    }
+
+    if(view != view_displayed)
+    {
+        _oscilloscope_view_display(view);
+    }
+
+    if(autoset_done)
+    {
+        autoset_done = false;
+        if(OSCILLOSCOPE_VIEW_SPECTRUM != view_displayed)
+        {
+            lv_chart_set_range(ui_OscilloscopeChart, LV_CHART_AXIS_PRIMARY_Y, chart_min_mv, chart_max_mv);
+            lv_chart_set_range(ui_OscilloscopeChart, LV_CHART_AXIS_PRIMARY_X, chart_min_mv, chart_max_mv);
+        }
+        _oscilloscope_timebase_label_update();
+    }
+
+    if(OSCILLOSCOPE_VIEW_SPECTRUM == view_displayed)
+    {
+        if(_oscilloscope_spectrum_render())
+        {
+            last_render_us = now_us;
+            stats_frames++;
+        }
+        _oscilloscope_update_render_stats(now_us);
+        return;
+    }
+
+    if(oscilloscope_triple_buffer_acquire(&frame_buffer))
+    {
+        displayed_frame = &frames[oscilloscope_triple_buffer_front(&frame_buffer)];
+        _draw_waveform(displayed_frame);
+
+        last_render_us = now_us;
+        stats_frames++;
+        stats_latency_us += now_us - displayed_frame->publish_timestamp_us;
+
+        if(CAPTURE_COMPLETE == capture_state)
+        {
+            /* Single sweep done. */
+            oscilloscope_stop();
+        }
+    }
+    else if((OSCILLOSCOPE_SWEEP_AUTO == trigger_config.sweep) && !segments_active &&
+            (now_us - last_render_us > (int64_t)frame_duration_us + OSCILLOSCOPE_AUTO_TRIGGER_TIMEOUT_US))
+    {
+        /* No trigger for a while, force one. The frame is drawn as soon as it is complete. */
+        trigger_force = true;
+    }
+
+    _oscilloscope_update_render_stats(now_us);
+}
+
+static void _oscilloscope_screenshot_timer_callback(lv_timer_t *timer)
+{
+    const oscilloscope_screenshot_t *screenshot = NULL;
+
+    if(oscilloscope_screenshot_store_acquire(&screenshot))
+    {
+        _oscilloscope_screenshot_display(screenshot);
+        lv_timer_pause(timer);
+    }
+    else if(!oscilloscope_screenshot_store_loading())
+    {
+        /* Read failed, keep the current screenshot. */
+        lv_timer_pause(timer);
+    }
+}
+
+static void _oscilloscope_screenshot_display(const oscilloscope_screenshot_t *screenshot)
+{
+    lv_chart_series_t *series[OSCILLOSCOPE_CHANNEL_COUNT] = {
+        [OSCILLOSCOPE_CH1] = screenshot_series1,
+        [OSCILLOSCOPE_CH2] = screenshot_series2,
+    };
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(NULL == series[i])
+        {
+            continue;
+        }
+
+        memcpy(screenshot_data[i], screenshot->column[i], sizeof(screenshot_data[i]));
+        lv_chart_set_ext_y_array(ui_OscilloscopeChart2, series[i], screenshot_data[i]);
+        lv_chart_hide_series(ui_OscilloscopeChart2, series[i], 0 == (screenshot->channel_mask & (1U << i)));
+    }
+
+    lv_chart_set_range(ui_OscilloscopeChart2, LV_CHART_AXIS_PRIMARY_Y, screenshot->chart_min_mv,
+                       screenshot->chart_max_mv);
+    lv_chart_refresh(ui_OscilloscopeChart2);
+}
+
+static void _oscilloscope_roll_push(oscilloscope_channel_id_t channel, uint16_t voltage)
+{
+    unsigned int head = atomic_load_explicit(&roll_stream_head[channel], memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&roll_stream_tail[channel], memory_order_acquire);
+
+    if(OSCILLOSCOPE_ROLL_STREAM_POINTS == head - tail)
+    {
+        /* Renderer is behind, drop the sample. */
+        return;
+    }
+
+    roll_stream[channel][head & (OSCILLOSCOPE_ROLL_STREAM_POINTS - 1)] = voltage;
+    atomic_store_explicit(&roll_stream_head[channel], head + 1, memory_order_release);
+}
+
+static void _oscilloscope_roll_display(bool roll)
+{
+    lv_chart_set_update_mode(ui_OscilloscopeChart, LV_CHART_UPDATE_MODE_SHIFT);
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(roll)
+        {
+            /* Start from an empty display and drop whatever is queued from before. */
+            for(uint32_t n = 0; n < POINTS_PER_FRAME; n++)
+            {
+                roll_data[i][n] = LV_CHART_POINT_NONE;
+            }
+            atomic_store(&roll_stream_tail[i], atomic_load(&roll_stream_head[i]));
+
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series, roll_data[i]);
+            lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, true);
+            lv_chart_hide_series(ui_OscilloscopeChart, math_series, true);
+        }
+        else if(NULL != displayed_frame)
+        {
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series,
+                                     (lv_coord_t *)displayed_frame->column_max[i]);
+        }
+        lv_chart_set_x_start_point(ui_OscilloscopeChart, channels[i].ui_Chart_series, 0);
+    }
+
+    lv_chart_refresh(ui_OscilloscopeChart);
+    roll_displayed = roll;
+}
+
+static void _oscilloscope_roll_render(void)
+{
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        unsigned int tail = atomic_load_explicit(&roll_stream_tail[i], memory_order_relaxed);
+        unsigned int head = atomic_load_explicit(&roll_stream_head[i], memory_order_acquire);
+
+        /* Writes the value at the start point and moves the start point by one, no data is moved. */
+        for(; tail != head; tail++)
+        {
+            lv_chart_set_next_value(ui_OscilloscopeChart, channels[i].ui_Chart_series,
+                                    roll_stream[i][tail & (OSCILLOSCOPE_ROLL_STREAM_POINTS - 1)]);
+        }
+        atomic_store_explicit(&roll_stream_tail[i], tail, memory_order_release);
+    }
+}
+
+static void _oscilloscope_update_render_stats(int64_t now_us)
+{
+    int64_t window_us = now_us - stats_window_start_us;
+    if(OSCILLOSCOPE_STATS_PERIOD_US > window_us)
+    {
+        return;
+    }
+
+    uint32_t fps_x10 = (uint32_t)((stats_frames * 10000000LL) / window_us);
+    uint32_t latency_ms = (0 < stats_frames) ? (uint32_t)(stats_latency_us / stats_frames / 1000) : 0;
+
+    lv_label_set_text_fmt(oscilloscope_stats_label, "%d.%d fps %d ms", (int)(fps_x10 / 10), (int)(fps_x10 % 10),
+                          (int)latency_ms);
+    if(0 == (++stats_windows % OSCILLOSCOPE_STATS_LOG_PERIOD))
+    {
+        ESP_LOGI(TAG, "Render: %d.%d fps, %d ms frame latency", (int)(fps_x10 / 10), (int)(fps_x10 % 10),
+                 (int)latency_ms);
+    }
+
+    stats_window_start_us = now_us;
+    stats_frames = 0;
+    stats_latency_us = 0;
+}
+
+static void _oscilloscope_publish_spectrum(void)
+{
+    const uint16_t *capture[OSCILLOSCOPE_CHANNEL_COUNT];
+    uint32_t start[OSCILLOSCOPE_CHANNEL_COUNT];
+    uint32_t sample_period_us[OSCILLOSCOPE_CHANNEL_COUNT];
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        oscilloscope_channel_t *channel = &channels[i];
+        capture[i] = channel->enabled ? channel->capture : NULL;
+        start[i] = (capture_points == channel->filled) ? channel->index : 0;
+        sample_period_us[i] = channel->decimation * scheduler_tick;
+    }
+
+    /* Skipped if the previous spectrum is still being computed, the next frame follows right away. */
+    oscilloscope_spectrum_submit(capture, start, capture_points, sample_period_us);
+}
+
+static void _oscilloscope_view_display(oscilloscope_view_t new_view)
+{
+    /* XY draws points only, the channel series have no X array and must stay hidden there. */
+    bool xy = (OSCILLOSCOPE_VIEW_XY == new_view);
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series,
+                             xy || !channels[i].enabled || persistence_displayed);
+        lv_chart_hide_series(ui_OscilloscopeChart, channels[i].ui_Chart_series_min, true);
+    }
+    lv_chart_hide_series(ui_OscilloscopeChart, math_series, true);
+    lv_chart_hide_series(ui_OscilloscopeChart, xy_series, true);
+    lv_chart_set_type(ui_OscilloscopeChart, xy ? LV_CHART_TYPE_SCATTER : LV_CHART_TYPE_LINE);
+    if(xy)
+    {
+        lv_obj_set_style_line_opa(ui_OscilloscopeChart, LV_OPA_TRANSP, LV_PART_ITEMS);
+        lv_obj_set_style_size(ui_OscilloscopeChart, OSCILLOSCOPE_XY_POINT_SIZE, LV_PART_INDICATOR);
+    }
+    else
+    {
+        lv_obj_remove_local_style_prop(ui_OscilloscopeChart, LV_STYLE_LINE_OPA, LV_PART_ITEMS);
+        lv_obj_remove_local_style_prop(ui_OscilloscopeChart, LV_STYLE_WIDTH, LV_PART_INDICATOR);
+        lv_obj_remove_local_style_prop(ui_OscilloscopeChart, LV_STYLE_HEIGHT, LV_PART_INDICATOR);
+        lv_chart_set_point_count(ui_OscilloscopeChart, POINTS_PER_FRAME);
+    }
+    view_displayed = new_view;
+
+    if(OSCILLOSCOPE_VIEW_SPECTRUM == new_view)
+    {
+        lv_chart_set_range(ui_OscilloscopeChart, LV_CHART_AXIS_PRIMARY_Y, OSCILLOSCOPE_FFT_DB_FLOOR, 0);
+    }
+    else
+    {
+        lv_chart_set_range(ui_OscilloscopeChart, LV_CHART_AXIS_PRIMARY_Y, chart_min_mv, chart_max_mv);
+        lv_chart_set_range(ui_OscilloscopeChart, LV_CHART_AXIS_PRIMARY_X, chart_min_mv, chart_max_mv);
+        if(NULL != displayed_frame)
+        {
+            _draw_waveform(displayed_frame);
+        }
+    }
+
+    lv_chart_refresh(ui_OscilloscopeChart);
+}
+
+static bool _oscilloscope_spectrum_render(void)
+{
+    const oscilloscope_spectrum_t *spectrum;
+    if(!oscilloscope_spectrum_acquire(&spectrum))
+    {
+        return false;
+    }
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(spectrum->enabled[i])
+        {
+            lv_chart_set_ext_y_array(ui_OscilloscopeChart, channels[i].ui_Chart_series,
+                                     (lv_coord_t *)spectrum->column_db[i]);
+        }
+    }
+
+    /* Peak frequency and span instead of Vpp. */
+    lv_label_set_text_fmt(ui_Ch1Vpp, "CH1: %u Hz / %u Hz", (unsigned)spectrum->peak_frequency_hz[OSCILLOSCOPE_CH1],
+                          (unsigned)spectrum->span_hz[OSCILLOSCOPE_CH1]);
+    lv_label_set_text_fmt(ui_Ch2Vpp, "CH2: %u Hz / %u Hz", (unsigned)spectrum->peak_frequency_hz[OSCILLOSCOPE_CH2],
+                          (unsigned)spectrum->span_hz[OSCILLOSCOPE_CH2]);
+
+    lv_chart_refresh(ui_OscilloscopeChart);
+    return true;
+}
+
+static void _oscilloscope_autoset_begin(void)
+{
+    autoset_pending = 0;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(channels[i].enabled)
+        {
+            channels[i].autoset_step = 0;
+            channels[i].sampling_rate = autoset_timebases[0];
+            autoset_pending |= 1U << i;
+        }
+    }
+
+    autoset_measure_frame = false;
+    autoset_active = (0 != autoset_pending);
+}
+
+static void _oscilloscope_autoset_step(void)
+{
+    /* The first frame at a timebase only provides the reference levels for the next one. */
+    autoset_measure_frame = !autoset_measure_frame;
+    if(autoset_measure_frame)
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        oscilloscope_channel_t *channel = &channels[i];
+        const oscilloscope_measurements_t *measurements = &channel->measurements;
+        if(0 == (autoset_pending & (1U << i)))
+        {
+            continue;
+        }
+
+        uint32_t sample_period_ns = channel->decimation * scheduler_tick * 1000U;
+        bool periodic = (0 != measurements->period_ns) &&
+                        (OSCILLOSCOPE_AUTOSET_MIN_AMPLITUDE_MV <= measurements->max_mv - measurements->min_mv) &&
+                        (OSCILLOSCOPE_AUTOSET_MIN_PERIOD * sample_period_ns <= measurements->period_ns);
+
+        if(periodic)
+        {
+            uint64_t period_us = measurements->period_ns / 1000U;
+            channel->sampling_rate = _oscilloscope_timebase_round(
+                (uint32_t)((OSCILLOSCOPE_AUTOSET_PERIODS * period_us) / POINTS_PER_FRAME));
+        }
+        else if(sizeof(autoset_timebases) / sizeof(autoset_timebases[0]) > channel->autoset_step + 1)
+        {
+            /* No full period yet, try a slower timebase. */
+            channel->sampling_rate = autoset_timebases[++channel->autoset_step];
+            continue;
+        }
+
+        /* Periodic, or DC / slower than the slowest coarse timebase, which is kept. */
+        autoset_result[i] = *measurements;
+        autoset_pending &= ~(1U << i);
+    }
+
+    if(0 == autoset_pending)
+    {
+        _oscilloscope_autoset_finish();
+    }
+}
+
+static void _oscilloscope_autoset_finish(void)
+{
+    int32_t min_mv = OSCILLOSCOPE_MAX_VOLTAGE;
+    int32_t max_mv = OSCILLOSCOPE_MIN_VOLTAGE;
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(!channels[i].enabled)
+        {
+            continue;
+        }
+        if(autoset_result[i].min_mv < min_mv)
+        {
+            min_mv = autoset_result[i].min_mv;
+        }
+        if(autoset_result[i].max_mv > max_mv)
+        {
+            max_mv = autoset_result[i].max_mv;
+        }
+    }
+
+    /* Swing plus a margin, on whole range steps, at least the minimum range. */
+    int32_t margin = (max_mv - min_mv) / OSCILLOSCOPE_AUTOSET_MARGIN_DIV;
+    min_mv -= margin;
+    max_mv += margin;
+    if(OSCILLOSCOPE_AUTOSET_MIN_RANGE_MV > max_mv - min_mv)
+    {
+        int32_t center = (max_mv + min_mv) / 2;
+        min_mv = center - OSCILLOSCOPE_AUTOSET_MIN_RANGE_MV / 2;
+        max_mv = center + OSCILLOSCOPE_AUTOSET_MIN_RANGE_MV / 2;
+    }
+    min_mv = (0 > min_mv) ? 0 : (min_mv / OSCILLOSCOPE_AUTOSET_RANGE_STEP_MV) * OSCILLOSCOPE_AUTOSET_RANGE_STEP_MV;
+    max_mv = ((max_mv + OSCILLOSCOPE_AUTOSET_RANGE_STEP_MV - 1) / OSCILLOSCOPE_AUTOSET_RANGE_STEP_MV) *
+             OSCILLOSCOPE_AUTOSET_RANGE_STEP_MV;
+    if((int32_t)OSCILLOSCOPE_MAX_VOLTAGE < max_mv)
+    {
+        max_mv = OSCILLOSCOPE_MAX_VOLTAGE;
+    }
+    chart_min_mv = (lv_coord_t)min_mv;
+    chart_max_mv = (lv_coord_t)max_mv;
+
+    /* Trigger in the middle of the source signal. */
+    if(channels[trigger_config.source].enabled)
+    {
+        const oscilloscope_measurements_t *source = &autoset_result[trigger_config.source];
+        trigger_config.level = (uint16_t)((source->min_mv + source->max_mv) / 2U);
+    }
+
+    autoset_active = false;
+    autoset_done = true;
+}
+
+static uint32_t _oscilloscope_timebase_round(uint32_t sampling_rate)
+{
+    /* Zoom steps are 10 us up to OSCILLOSCOPE_RATE_THRESHOLD and 100 us above it. */
+    if(OSCILLOSCOPE_MINIMUM_SAMPLING_RATE > sampling_rate)
+    {
+        return OSCILLOSCOPE_MINIMUM_SAMPLING_RATE;
+    }
+    if(OSCILLOSCOPE_RATE_THRESHOLD >= sampling_rate)
+    {
+        return ((sampling_rate + OSCILLOSCOPE_ZOOM_INCREMENT / 20) / (OSCILLOSCOPE_ZOOM_INCREMENT / 10)) *
+               (OSCILLOSCOPE_ZOOM_INCREMENT / 10);
+    }
+    return OSCILLOSCOPE_RATE_THRESHOLD +
+           ((sampling_rate - OSCILLOSCOPE_RATE_THRESHOLD + OSCILLOSCOPE_ZOOM_INCREMENT / 2) / OSCILLOSCOPE_ZOOM_INCREMENT) *
+           OSCILLOSCOPE_ZOOM_INCREMENT;
+}
+
+static void _oscilloscope_measurement_panel_render(const oscilloscope_frame_t *frame)
+{
+    static const oscilloscope_channel_id_t panel_channels[] = {OSCILLOSCOPE_CH1, OSCILLOSCOPE_CH2};
+    lv_obj_t *panel_labels[] = {ui_Ch1Vpp, ui_Ch2Vpp};
+    char text[64];
+
+    for(uint32_t c = 0; c < sizeof(panel_channels) / sizeof(panel_channels[0]); c++)
+    {
+        oscilloscope_channel_id_t channel = panel_channels[c];
+        int length = snprintf(text, sizeof(text), "CH%d:", (int)channel + 1);
+
+        for(uint32_t i = 0; (i < panel_item_count[channel]) && (length < (int)sizeof(text)); i++)
+        {
+            length += _oscilloscope_measurement_format(&text[length], sizeof(text) - length, panel_items[channel][i],
+                                                       &frame->measurements[channel]);
+        }
+        lv_label_set_text(panel_labels[c], frame->enabled[channel] ? text : "");
+    }
+}
+
+static int _oscilloscope_measurement_format(char *buffer, size_t size, oscilloscope_measurement_t item,
+                                            const oscilloscope_measurements_t *measurements)
+{
+    switch(item)
+    {
+    case OSCILLOSCOPE_MEASUREMENT_VPP:
+        return snprintf(buffer, size, " %d mVpp", (int)(measurements->max_mv - measurements->min_mv));
+    case OSCILLOSCOPE_MEASUREMENT_MIN:
+        return snprintf(buffer, size, " min %d mV", (int)measurements->min_mv);
+    case OSCILLOSCOPE_MEASUREMENT_MAX:
+        return snprintf(buffer, size, " max %d mV", (int)measurements->max_mv);
+    case OSCILLOSCOPE_MEASUREMENT_MEAN:
+        return snprintf(buffer, size, " avg %d mV", (int)measurements->mean_mv);
+    case OSCILLOSCOPE_MEASUREMENT_RMS:
+        return snprintf(buffer, size, " %d mVrms", (int)measurements->rms_mv);
+    case OSCILLOSCOPE_MEASUREMENT_FREQUENCY:
+        if(1000000U <= measurements->frequency_mhz)
+        {
+            return snprintf(buffer, size, " %d Hz", (int)(measurements->frequency_mhz / 1000U));
+        }
+        return snprintf(buffer, size, " %d.%02d Hz", (int)(measurements->frequency_mhz / 1000U),
+                        (int)((measurements->frequency_mhz % 1000U) / 10U));
+    case OSCILLOSCOPE_MEASUREMENT_PERIOD:
+        if(1000000U <= measurements->period_ns)
+        {
+            return snprintf(buffer, size, " T %d ms", (int)(measurements->period_ns / 1000000U));
+        }
+        return snprintf(buffer, size, " T %d us", (int)(measurements->period_ns / 1000U));
+    case OSCILLOSCOPE_MEASUREMENT_DUTY:
+        return snprintf(buffer, size, " %d.%d %%", (int)(measurements->duty_permille / 10U),
+                        (int)(measurements->duty_permille % 10U));
+    case OSCILLOSCOPE_MEASUREMENT_RISE_TIME:
+        return snprintf(buffer, size, " tr %d us", (int)(measurements->rise_time_ns / 1000U));
+    case OSCILLOSCOPE_MEASUREMENT_FALL_TIME:
+        return snprintf(buffer, size, " tf %d us", (int)(measurements->fall_time_ns / 1000U));
+    default:
+        return 0;
+    }
 }
 
 //---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -16,14 +16,75 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "ui.h"
+#include "oscilloscope_trigger.h"
+#include "oscilloscope_fft.h"
+#include "oscilloscope_math.h"
+#include "oscilloscope_filter.h"
+#include "oscilloscope_persistence.h"
 
 //---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_MEASUREMENT_PANEL_ITEMS (3U)  // Measurements shown per channel
+#define OSCILLOSCOPE_AVERAGE_MAX_FRAMES      (256U)
+#define OSCILLOSCOPE_ETS_FACTOR              (10U)   // Equivalent time: timebase divider
+#define OSCILLOSCOPE_SEGMENT_OVERLAY         (UINT32_MAX)  // All segments at once
 
 //-------------------------------- DATA TYPES ---------------------------------
 typedef enum{
     OSCILLOSCOPE_ZOOM_IN,
     OSCILLOSCOPE_ZOOM_OUT
 } oscilloscope_zoom_t;
+
+typedef enum{
+    OSCILLOSCOPE_CH1,  // ADC_CHANNEL_3
+    OSCILLOSCOPE_CH2,  // ADC_CHANNEL_6
+    OSCILLOSCOPE_CH3,  // ADC_CHANNEL_7, disabled by default
+    OSCILLOSCOPE_CHANNEL_COUNT
+} oscilloscope_channel_id_t;
+
+typedef enum{
+    OSCILLOSCOPE_ACQUISITION_NORMAL,       // One sample per display column
+    OSCILLOSCOPE_ACQUISITION_PEAK_DETECT,  // Deep capture, every column shows the min/max of its samples
+    OSCILLOSCOPE_ACQUISITION_AVERAGE,      // Every column shows the running average of several frames
+    OSCILLOSCOPE_ACQUISITION_HIGH_RES,     // Every column shows the mean of all ADC samples in its time
+    OSCILLOSCOPE_ACQUISITION_EQUIVALENT_TIME  // Repetitive signals, frame assembled from many triggers
+} oscilloscope_acquisition_t;
+
+typedef enum{
+    OSCILLOSCOPE_SWEEP_AUTO,    // Frame is forced if no trigger occurs until the next screen refresh
+    OSCILLOSCOPE_SWEEP_NORMAL,  // Only triggered frames are displayed
+    OSCILLOSCOPE_SWEEP_SINGLE   // One triggered frame is displayed, then acquisition stops
+} oscilloscope_sweep_t;
+
+typedef enum{
+    OSCILLOSCOPE_VIEW_TIME,     // Voltage over time
+    OSCILLOSCOPE_VIEW_SPECTRUM, // Magnitude spectrum in dBFS, DC to half the sample rate
+    OSCILLOSCOPE_VIEW_XY        // CH2 over CH1, for phase comparison (Lissajous figures)
+} oscilloscope_view_t;
+
+typedef enum{
+    OSCILLOSCOPE_MEASUREMENT_VPP,
+    OSCILLOSCOPE_MEASUREMENT_MIN,
+    OSCILLOSCOPE_MEASUREMENT_MAX,
+    OSCILLOSCOPE_MEASUREMENT_MEAN,
+    OSCILLOSCOPE_MEASUREMENT_RMS,
+    OSCILLOSCOPE_MEASUREMENT_FREQUENCY,
+    OSCILLOSCOPE_MEASUREMENT_PERIOD,
+    OSCILLOSCOPE_MEASUREMENT_DUTY,
+    OSCILLOSCOPE_MEASUREMENT_RISE_TIME,  // 10 % to 90 %
+    OSCILLOSCOPE_MEASUREMENT_FALL_TIME,  // 90 % to 10 %
+    OSCILLOSCOPE_MEASUREMENT_COUNT
+} oscilloscope_measurement_t;
+
+typedef struct
+{
+    oscilloscope_channel_id_t source;
+    oscilloscope_trigger_type_t type;
+    oscilloscope_sweep_t sweep;
+    uint16_t level;               // Millivolts
+    uint16_t hysteresis;          // Millivolts
+    uint8_t pre_trigger_percent;  // Part of the frame shown before the trigger point, 0 - 100
+    uint32_t holdoff_us;          // Minimum time between two triggers
+} oscilloscope_trigger_config_t;
 //---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
 /**
  * @brief Initialize the oscilloscope module.
@@ -36,9 +97,9 @@ void oscilloscope_init(void);
 /**
  * @brief Start the oscilloscope's periodic sampling.
  *
- * This function starts the periodic sampling timer that collects data from the ADC
- * and triggers the waveform drawing function. Additionally, it starts a slow blink
- * LED pattern to indicate the oscilloscope is running.
+ * This function starts ADC acquisition and the render loop, an LVGL timer that draws
+ * every complete frame at up to 25 fps. Must be called from the GUI task. Additionally,
+ * it starts a slow blink LED pattern to indicate the oscilloscope is running.
  */
 void oscilloscope_start(void);
 
@@ -53,23 +114,213 @@ void oscilloscope_stop(void);
 /**
  * @brief Take a screenshot of the current oscilloscope chart data.
  *
- * This function captures the waveform data from the current chart (`ui_OscilloscopeChart`)
- * and copies it into a new chart (`ui_OscilloscopeChart2`). It creates new series for the 
- * second chart and transfers the Y-axis data from the original series to the new one.
+ * This function copies the waveform data shown on the current chart (`ui_OscilloscopeChart`), together with
+ * the timebase, vertical range and enabled channels, and shows the copy on the screenshot chart
+ * (`ui_OscilloscopeChart2`). The copy is then saved to the next flash slot in the background.
  *
- * @note This function assumes that the chart series (`ui_Chart_series1` and `ui_Chart_series2`)
- *       are already initialized.
+ * @note Does nothing before oscilloscope_start() created the chart series.
  */
 void oscilloscope_screenshot(void);
 
 /**
- * @brief Display the captured oscilloscope screenshot.
+ * @brief Display the newest stored oscilloscope screenshot.
  *
- * This function sets the Y-axis data for the chart `ui_OscilloscopeChart2` based on the
- * captured oscilloscope data stored in the screenshot series.
+ * Same as oscilloscope_screenshot_show(0).
  */
 void oscilloscope_display_screenshot(void);
 
+/**
+ * @brief Display a stored oscilloscope screenshot on `ui_OscilloscopeChart2`.
+ *
+ * The screenshot is read from flash in the background and shown as soon as it is loaded. If there is no
+ * such screenshot, the chart keeps what it shows.
+ *
+ * @param[in] age 0 for the newest screenshot, 1 for the one before it and so on.
+ */
+void oscilloscope_screenshot_show(uint32_t age);
+
+/**
+ * @brief Enable or disable an oscilloscope channel.
+ *
+ * All enabled channels are sampled in the same scheduler tick. With DMA acquisition the new
+ * channel set takes effect on the next `oscilloscope_start()`.
+ *
+ * @param[in] channel Channel to enable or disable.
+ * @param[in] enable `true` to enable the channel, `false` to disable it.
+ */
+void oscilloscope_channel_enable(oscilloscope_channel_id_t channel, bool enable);
+
+/**
+ * @brief Set the acquisition mode.
+ *
+ * In peak detect every channel captures OSCILLOSCOPE_DEEP_CAPTURE_POINTS samples in the time of a normal
+ * frame and every display column shows the band between the minimum and maximum of its samples, so short
+ * glitches stay visible at slow timebases. Average reduces noise on repetitive triggered signals, see
+ * oscilloscope_average_set(). High resolution keeps every ADC sample instead of one per display column and
+ * shows their mean, so noise drops with the square root of the samples per column, also in roll mode.
+ * Equivalent time shows repetitive signals faster than the ADC rate: the timebase is divided by
+ * OSCILLOSCOPE_ETS_FACTOR and every frame is assembled from triggered acquisitions with random phase,
+ * each placed by the interpolated trigger crossing. It needs a stable rising or falling edge trigger.
+ * The mode is applied when the next frame is armed.
+ *
+ * @param[in] mode Acquisition mode.
+ */
+void oscilloscope_acquisition_set(oscilloscope_acquisition_t mode);
+
+/**
+ * @brief Set the number of frames averaged in the average acquisition mode. 16 by default.
+ *
+ * The average restarts whenever the timebase, the channels, the trigger or the mode change. Measurements,
+ * persistence and the math trace are computed on the averaged frame.
+ *
+ * @param[in] frames Number of frames, 2 to OSCILLOSCOPE_AVERAGE_MAX_FRAMES.
+ */
+void oscilloscope_average_set(uint32_t frames);
+
+/**
+ * @brief Allow or forbid roll mode.
+ *
+ * When allowed, the oscilloscope rolls at timebases where one frame takes a second or more to fill:
+ * new samples are appended at the right edge of the chart as they arrive and older ones move left,
+ * without waiting for a trigger. Roll mode is allowed by default.
+ *
+ * @param[in] enable `true` to allow roll mode.
+ */
+void oscilloscope_roll_enable(bool enable);
+
+/**
+ * @brief Set the trigger configuration.
+ *
+ * The configuration is applied when the next frame is armed.
+ *
+ * @param[in] config Trigger source, type, sweep, level, pre-trigger part of the frame and holdoff.
+ */
+void oscilloscope_trigger_set(const oscilloscope_trigger_config_t *config);
+
+/**
+ * @brief Get the current trigger configuration.
+ *
+ * @param[out] config Current trigger configuration.
+ */
+void oscilloscope_trigger_get(oscilloscope_trigger_config_t *config);
+
+/**
+ * @brief Switch between the time, the spectrum and the XY view.
+ *
+ * In the spectrum view every enabled channel captures as many samples as the FFT size, free running, the
+ * FFT runs on the core the GUI does not use and the chart shows the spectrum from -90 to 0 dBFS. The peak
+ * frequency replaces the Vpp value. Zoom changes the sample rate and with it the frequency span.
+ * In the XY view CH1 and CH2 take a deep capture at the CH1 timebase and the chart plots CH2 over CH1 as
+ * points. The sampler reduces the capture to one point per screen cell, so the render cost does not grow
+ * with the capture depth. It needs CH1 and CH2 enabled. The view is applied when the next frame is armed.
+ *
+ * @param[in] view View to show.
+ */
+void oscilloscope_view_set(oscilloscope_view_t view);
+
+/**
+ * @brief Set the window applied before the FFT in the spectrum view. Hann by default.
+ *
+ * @param[in] window Window type.
+ */
+void oscilloscope_fft_window_set(oscilloscope_fft_window_t window);
+
+/**
+ * @brief Set the FFT size in the spectrum view, applied when the next frame is armed. Fewer points give a
+ *        faster update, more points a finer bin spacing. OSCILLOSCOPE_FFT_MAX_POINTS by default.
+ *
+ * @param[in] points Power of 2 from 256 to OSCILLOSCOPE_FFT_MAX_POINTS.
+ *
+ * @return true if the size is valid.
+ */
+bool oscilloscope_fft_points_set(uint32_t points);
+
+/**
+ * @brief Select the measurements shown for a channel.
+ *
+ * Measurements are computed for every frame of every enabled channel; the panel below the chart shows the
+ * selected ones for CH1 and CH2, in the given order. The default is Vpp and frequency.
+ *
+ * @param[in] channel Channel to configure.
+ * @param[in] items Measurements to show.
+ * @param[in] count Number of measurements, at most OSCILLOSCOPE_MEASUREMENT_PANEL_ITEMS.
+ */
+void oscilloscope_measurement_panel_set(oscilloscope_channel_id_t channel, const oscilloscope_measurement_t *items,
+                                        uint32_t count);
+
+/**
+ * @brief Select the timebase of every enabled channel and the vertical range automatically.
+ *
+ * Free-running coarse captures from the fastest timebase towards slower ones are measured until a
+ * period is found. Each channel's timebase is then set so about three periods fill the screen, the
+ * chart range to the signal with a margin, and the trigger level to the middle of the source.
+ * Runs in the background, a signal of 50 Hz or more settles in under 100 ms. Switches to the time view.
+ */
+void oscilloscope_autoset(void);
+
+/**
+ * @brief Select the math trace, off by default.
+ *
+ * The trace is computed by the sampler on the display columns of every frame and drawn in magenta on the
+ * same chart; a label shows its scale. CH1 and CH2 are taken in the same scan, so the two-input operations
+ * need both channels enabled at the same timebase to be time aligned, otherwise the trace is hidden. The
+ * derivative and the integral use CH1 only. In peak detect the first sample of every column is used, so
+ * both inputs are real samples of the same scan.
+ *
+ * @param[in] operation Math operation.
+ */
+void oscilloscope_math_set(oscilloscope_math_t operation);
+
+/**
+ * @brief Select the filter of a channel, off by default.
+ *
+ * The filter runs in the sampler on every kept sample, after the decimation, so the display, the
+ * measurements, the math trace, the spectrum and the record all see the filtered signal. The trigger
+ * still runs on the raw samples. Coefficients are computed when the filter or the timebase changes;
+ * a cutoff above 0.45 of the sample rate of the timebase bypasses the filter. High-pass and band-pass
+ * outputs are centered on OSCILLOSCOPE_FILTER_AC_CENTER_MV. Not applied in equivalent time.
+ *
+ * @param[in] channel Channel to filter.
+ * @param[in] config Type, structure and frequencies.
+ */
+void oscilloscope_filter_set(oscilloscope_channel_id_t channel, const oscilloscope_filter_config_t *config);
+
+/**
+ * @brief Select the persistence of the time view, off by default.
+ *
+ * With persistence on, the chart shows an intensity graded image in place of the channel traces. Every
+ * captured sample of every enabled channel is a hit on its pixel, including the samples a column
+ * reduction would hide, and the image fades once per frame. Rare glitches stay visible for the
+ * following frames, and the color shows how often each pixel is hit. All channels share one image.
+ * The image is cleared when the timebase, the vertical range or the mode changes. Not used in roll
+ * mode or in equivalent time.
+ *
+ * @param[in] mode Persistence mode.
+ */
+void oscilloscope_persistence_set(oscilloscope_persistence_t mode);
+
+/**
+ * @brief Split the acquisition into a sequence of triggered segments, off by default.
+ *
+ * Every segment is a capture of one sample per display column with its own trigger time. The sampler
+ * copies a complete segment and re-arms in the same tick, keeping the running capture as the pre-trigger
+ * part of the next segment, so events milliseconds apart are all kept. No frames are shown during the
+ * sequence and the auto sweep does not force triggers. When all segments are stored, the last one is
+ * shown as a frame and acquisition stops. The chart then overlays all segments on the persistence image.
+ * While stopped, CH1 +/- switches between one segment and the overlay, and CH2 +/- steps through the
+ * segments. Applies to the time view, not in roll mode; settings change between sequences.
+ *
+ * @param[in] count Segments per sequence, up to OSCILLOSCOPE_SEGMENT_MAX. 0 or 1 turns it off.
+ */
+void oscilloscope_segments_set(uint32_t count);
+
+/**
+ * @brief Show a stored segment while stopped, or all of them overlaid.
+ *
+ * @param[in] segment Segment index, OSCILLOSCOPE_SEGMENT_OVERLAY for all.
+ */
+void oscilloscope_segment_show(uint32_t segment);
+
 void oscilloscopeCH1_zoom(oscilloscope_zoom_t zoom);
 
 void oscilloscopeCH2_zoom(oscilloscope_zoom_t zoom);
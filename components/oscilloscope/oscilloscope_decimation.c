@@ -0,0 +1,173 @@
+/**
+* @file oscilloscope_decimation.c
+*
+* @brief Peak-detect (min/max) reduction of deep captures to the display width, running average of
+*        display frames and reduction of XY captures to the screen resolution.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_decimation.h"
+#include <stddef.h>
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+/* Cell of a millivolt value as (mv * XY_CELL_SCALE) >> 16, no division per sample. */
+#define XY_CELL_SCALE ((OSCILLOSCOPE_XY_GRID << 16) / (OSCILLOSCOPE_XY_FULL_SCALE_MV + 1U))
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint32_t xy_occupied[(OSCILLOSCOPE_XY_GRID * OSCILLOSCOPE_XY_GRID) / 32U];  // Bit per cell
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_minmax_reduce(const uint16_t *capture, uint32_t length, uint32_t start,
+                                lv_coord_t *column_min, lv_coord_t *column_max, uint32_t columns)
+{
+    if((NULL == capture) || (NULL == column_min) || (NULL == column_max) || (0 == columns) || (length < columns))
+    {
+        return;
+    }
+
+    uint32_t read = start;
+    uint32_t column = 0;
+    uint32_t column_end = length / columns;
+    uint16_t min = UINT16_MAX;
+    uint16_t max = 0;
+
+    for(uint32_t n = 0; n < length; n++)
+    {
+        uint16_t sample = capture[read];
+        if(sample < min)
+        {
+            min = sample;
+        }
+        if(sample > max)
+        {
+            max = sample;
+        }
+
+        if(length == ++read)
+        {
+            read = 0;
+        }
+
+        if(n + 1 == column_end)
+        {
+            column_min[column] = min;
+            column_max[column] = max;
+            min = UINT16_MAX;
+            max = 0;
+            column++;
+            column_end = ((column + 1) * length) / columns;
+        }
+    }
+}
+
+void oscilloscope_minmax_reduce_range(const uint16_t *buffer, uint32_t buffer_length, uint32_t start, uint32_t count,
+                                      lv_coord_t *column_min, lv_coord_t *column_max, uint32_t columns)
+{
+    if((NULL == buffer) || (NULL == column_min) || (NULL == column_max) || (0 == count) || (0 == buffer_length))
+    {
+        return;
+    }
+
+    for(uint32_t c = 0; c < columns; c++)
+    {
+        uint32_t first = (c * count) / columns;
+        uint32_t last = ((c + 1) * count) / columns;
+        if(last <= first)
+        {
+            last = first + 1;
+        }
+
+        uint32_t read = (start + first) % buffer_length;
+        uint16_t min = UINT16_MAX;
+        uint16_t max = 0;
+        for(uint32_t n = first; n < last; n++)
+        {
+            uint16_t sample = buffer[read];
+            if(sample < min)
+            {
+                min = sample;
+            }
+            if(sample > max)
+            {
+                max = sample;
+            }
+            if(buffer_length == ++read)
+            {
+                read = 0;
+            }
+        }
+
+        column_min[c] = min;
+        column_max[c] = max;
+    }
+}
+
+void oscilloscope_average_update(int32_t *accumulator, lv_coord_t *columns, uint32_t count, uint32_t frames,
+                                 uint32_t weight)
+{
+    if((NULL == accumulator) || (NULL == columns) || (0 == weight))
+    {
+        return;
+    }
+
+    /* Cumulative mean until the accumulator holds `weight` frames, exponential average afterwards. */
+    int32_t divisor = (int32_t)((frames < weight) ? frames + 1 : weight);
+    int32_t half = 1 << (OSCILLOSCOPE_AVERAGE_FRACTION_BITS - 1);
+
+    for(uint32_t n = 0; n < count; n++)
+    {
+        int32_t value = (int32_t)columns[n] << OSCILLOSCOPE_AVERAGE_FRACTION_BITS;
+        accumulator[n] = (0 == frames) ? value : accumulator[n] + (value - accumulator[n]) / divisor;
+        columns[n] = (lv_coord_t)((accumulator[n] + half) >> OSCILLOSCOPE_AVERAGE_FRACTION_BITS);
+    }
+}
+
+uint32_t oscilloscope_xy_reduce(const uint16_t *x, const uint16_t *y, uint32_t length, uint32_t start,
+                                lv_coord_t *points_x, lv_coord_t *points_y, uint32_t max_points)
+{
+    if((NULL == x) || (NULL == y) || (NULL == points_x) || (NULL == points_y) || (0 == length))
+    {
+        return 0;
+    }
+
+    memset(xy_occupied, 0, sizeof(xy_occupied));
+
+    uint32_t count = 0;
+    uint32_t read = start;
+    for(uint32_t n = 0; (n < length) && (count < max_points); n++)
+    {
+        uint32_t x_mv = (OSCILLOSCOPE_XY_FULL_SCALE_MV < x[read]) ? OSCILLOSCOPE_XY_FULL_SCALE_MV : x[read];
+        uint32_t y_mv = (OSCILLOSCOPE_XY_FULL_SCALE_MV < y[read]) ? OSCILLOSCOPE_XY_FULL_SCALE_MV : y[read];
+        uint32_t cell = ((y_mv * XY_CELL_SCALE) >> 16) * OSCILLOSCOPE_XY_GRID + ((x_mv * XY_CELL_SCALE) >> 16);
+
+        if(0 == (xy_occupied[cell / 32U] & (1UL << (cell % 32U))))
+        {
+            xy_occupied[cell / 32U] |= 1UL << (cell % 32U);
+            points_x[count] = (lv_coord_t)x_mv;
+            points_y[count] = (lv_coord_t)y_mv;
+            count++;
+        }
+
+        if(++read == length)
+        {
+            read = 0;
+        }
+    }
+
+    return count;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,103 @@
+/**
+* @file oscilloscope_decimation.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_DECIMATION_H__
+#define __OSCILLOSCOPE_DECIMATION_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include "lvgl.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_AVERAGE_FRACTION_BITS (8U)
+#define OSCILLOSCOPE_XY_GRID               (128U)   // Cells per axis, about the chart resolution
+#define OSCILLOSCOPE_XY_FULL_SCALE_MV      (3300U)
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Reduce a circular capture to display columns keeping the minimum and maximum of every column.
+ *
+ * Samples are read once, oldest first, starting at `start` and wrapping at `length`. Column `c` covers
+ * samples `[c * length / columns, (c + 1) * length / columns)`, so a single-sample glitch is visible in
+ * its column at any reduction ratio. Works in place on the output arrays, no allocation.
+ *
+ * @param[in] capture Circular capture buffer.
+ * @param[in] length Number of samples in the capture buffer, at least `columns`.
+ * @param[in] start Index of the oldest sample.
+ * @param[out] column_min Minimum of every column, `columns` entries.
+ * @param[out] column_max Maximum of every column, `columns` entries.
+ * @param[in] columns Number of display columns.
+ */
+void oscilloscope_minmax_reduce(const uint16_t *capture, uint32_t length, uint32_t start,
+                                lv_coord_t *column_min, lv_coord_t *column_max, uint32_t columns);
+
+/**
+ * @brief Reduce a slice of a ring buffer to display columns keeping the minimum and maximum of every column.
+ *
+ * Only the `count` samples of the slice are read. Column `c` covers samples `[c * count / columns,
+ * (c + 1) * count / columns)` of the slice and at least one, so slices shorter than the display repeat
+ * samples over several columns.
+ *
+ * @param[in] buffer Ring buffer.
+ * @param[in] buffer_length Number of samples in the ring buffer.
+ * @param[in] start Index of the first sample of the slice.
+ * @param[in] count Number of samples in the slice, at least 1.
+ * @param[out] column_min Minimum of every column, `columns` entries.
+ * @param[out] column_max Maximum of every column, `columns` entries.
+ * @param[in] columns Number of display columns.
+ */
+void oscilloscope_minmax_reduce_range(const uint16_t *buffer, uint32_t buffer_length, uint32_t start, uint32_t count,
+                                      lv_coord_t *column_min, lv_coord_t *column_max, uint32_t columns);
+
+/**
+ * @brief Add a frame to a running average and replace the frame with the average.
+ *
+ * The accumulator holds the average with OSCILLOSCOPE_AVERAGE_FRACTION_BITS fractional bits. Up to `weight`
+ * frames the average is the plain mean of all frames so far, after that every new frame has the weight
+ * 1 / `weight`, so noise is reduced by about the square root of `weight` while the display keeps updating.
+ *
+ * @param[in,out] accumulator Running average of every column, `columns` entries, caller owned.
+ * @param[in,out] columns New frame, replaced with the average.
+ * @param[in] count Number of columns.
+ * @param[in] frames Frames already in the accumulator, 0 to start a new average.
+ * @param[in] weight Number of frames averaged, at least 1.
+ */
+void oscilloscope_average_update(int32_t *accumulator, lv_coord_t *columns, uint32_t count, uint32_t frames,
+                                 uint32_t weight);
+
+/**
+ * @brief Reduce a pair of circular captures to an XY point cloud at the screen resolution.
+ *
+ * Both axes from 0 to OSCILLOSCOPE_XY_FULL_SCALE_MV are split into OSCILLOSCOPE_XY_GRID cells and only the
+ * first sample falling into every cell is kept, oldest first. A periodic signal retraces the same cells, so
+ * a deep capture shrinks to about the length of its curve on the screen.
+ *
+ * @param[in] x Circular capture of the X channel.
+ * @param[in] y Circular capture of the Y channel, sampled together with `x`.
+ * @param[in] length Number of samples in the captures.
+ * @param[in] start Index of the oldest sample.
+ * @param[out] points_x X of the kept points in millivolts, `max_points` entries.
+ * @param[out] points_y Y of the kept points in millivolts, `max_points` entries.
+ * @param[in] max_points Maximum number of points, later samples are dropped once reached.
+ *
+ * @return Number of points.
+ */
+uint32_t oscilloscope_xy_reduce(const uint16_t *x, const uint16_t *y, uint32_t length, uint32_t start,
+                                lv_coord_t *points_x, lv_coord_t *points_y, uint32_t max_points);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_DECIMATION_H__
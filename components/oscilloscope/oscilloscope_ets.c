@@ -0,0 +1,111 @@
+/**
+* @file oscilloscope_ets.c
+*
+* @brief Random equivalent-time sampling. Repetitive signals faster than the ADC rate are assembled from
+*        many triggered acquisitions, each placed by its own trigger phase.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_ets.h"
+#include <stddef.h>
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_ets_reset(oscilloscope_ets_t *ets)
+{
+    if(NULL != ets)
+    {
+        memset(ets, 0, sizeof(*ets));
+    }
+}
+
+void oscilloscope_ets_add(oscilloscope_ets_t *ets, const uint16_t *capture, uint32_t length, uint32_t start,
+                          int32_t first_offset_ns, uint32_t sample_period_ns, uint32_t column_ns)
+{
+    if((NULL == ets) || (NULL == capture) || (0 == column_ns))
+    {
+        return;
+    }
+
+    int64_t frame_ns = (int64_t)column_ns * OSCILLOSCOPE_ETS_COLUMNS;
+    int64_t time_ns = first_offset_ns;
+    uint32_t read = start;
+
+    for(uint32_t n = 0; n < length; n++, time_ns += sample_period_ns)
+    {
+        uint16_t sample = capture[read];
+        if(length == ++read)
+        {
+            read = 0;
+        }
+
+        if((0 > time_ns) || (frame_ns <= time_ns))
+        {
+            continue;
+        }
+
+        uint32_t column = (uint32_t)(time_ns / column_ns);
+        if(0 == ets->count[column]++)
+        {
+            ets->filled++;
+        }
+        ets->sum[column] += sample;
+    }
+}
+
+bool oscilloscope_ets_complete(const oscilloscope_ets_t *ets)
+{
+    return (NULL != ets) && (OSCILLOSCOPE_ETS_COLUMNS == ets->filled);
+}
+
+void oscilloscope_ets_resolve(const oscilloscope_ets_t *ets, lv_coord_t *columns)
+{
+    if((NULL == ets) || (NULL == columns))
+    {
+        return;
+    }
+
+    int32_t previous = -1;  // Last column with samples
+    for(uint32_t c = 0; c < OSCILLOSCOPE_ETS_COLUMNS; c++)
+    {
+        if(0 == ets->count[c])
+        {
+            continue;
+        }
+
+        columns[c] = (lv_coord_t)((ets->sum[c] + ets->count[c] / 2) / ets->count[c]);
+
+        /* Fill the gap since the last column with samples, flat before the first one. */
+        for(int32_t g = previous + 1; g < (int32_t)c; g++)
+        {
+            columns[g] = (0 > previous) ? columns[c] :
+                         (lv_coord_t)(columns[previous] + ((columns[c] - columns[previous]) * (g - previous)) /
+                                                          ((int32_t)c - previous));
+        }
+        previous = (int32_t)c;
+    }
+
+    /* Flat after the last column with samples, empty frame stays at 0. */
+    for(uint32_t g = previous + 1; g < OSCILLOSCOPE_ETS_COLUMNS; g++)
+    {
+        columns[g] = (0 > previous) ? 0 : columns[previous];
+    }
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
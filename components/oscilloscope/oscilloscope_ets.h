@@ -0,0 +1,80 @@
+/**
+* @file oscilloscope_ets.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_ETS_H__
+#define __OSCILLOSCOPE_ETS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_ETS_COLUMNS (200U)
+//-------------------------------- DATA TYPES ---------------------------------
+/* Equivalent-time frame of one channel being assembled from triggered acquisitions. */
+typedef struct
+{
+    uint32_t sum[OSCILLOSCOPE_ETS_COLUMNS];
+    uint16_t count[OSCILLOSCOPE_ETS_COLUMNS];
+    uint32_t filled;  // Columns with at least one sample
+} oscilloscope_ets_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Start a new equivalent-time frame.
+ *
+ * @param[out] ets Frame to clear.
+ */
+void oscilloscope_ets_reset(oscilloscope_ets_t *ets);
+
+/**
+ * @brief Add one triggered acquisition to an equivalent-time frame.
+ *
+ * Every sample is placed in the column its time falls in, relative to the left edge of the frame. As the
+ * trigger phase of every acquisition differs, the samples of many acquisitions interleave on a grid finer
+ * than the sample period.
+ *
+ * @param[in,out] ets Frame being assembled.
+ * @param[in] capture Circular capture buffer of the acquisition.
+ * @param[in] length Number of samples in the capture buffer.
+ * @param[in] start Index of the oldest sample.
+ * @param[in] first_offset_ns Time of the oldest sample after the left edge of the frame, may be negative.
+ * @param[in] sample_period_ns Time between two samples.
+ * @param[in] column_ns Time covered by one column.
+ */
+void oscilloscope_ets_add(oscilloscope_ets_t *ets, const uint16_t *capture, uint32_t length, uint32_t start,
+                          int32_t first_offset_ns, uint32_t sample_period_ns, uint32_t column_ns);
+
+/**
+ * @brief Check whether every column of a frame has at least one sample.
+ *
+ * @param[in] ets Frame being assembled.
+ *
+ * @return true if the frame is complete.
+ */
+bool oscilloscope_ets_complete(const oscilloscope_ets_t *ets);
+
+/**
+ * @brief Get the display columns of a frame, the mean of every column.
+ *
+ * Columns without samples are interpolated linearly between their neighbours.
+ *
+ * @param[in] ets Assembled frame.
+ * @param[out] columns Display columns, OSCILLOSCOPE_ETS_COLUMNS entries.
+ */
+void oscilloscope_ets_resolve(const oscilloscope_ets_t *ets, lv_coord_t *columns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_ETS_H__
@@ -0,0 +1,226 @@
+/**
+* @file oscilloscope_fft.c
+*
+* @brief Fixed-point (Q15) radix-2 FFT for the spectrum view of the oscilloscope. Twiddle, window and work
+*        tables are allocated statically for OSCILLOSCOPE_FFT_MAX_POINTS and reused by every transform.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_fft.h"
+#include <math.h>
+#include <stddef.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define FFT_Q15_ONE        (32767)
+#define FFT_INPUT_SHIFT    (3U)               // mV to Q15 input: 3300 mV deviation -> 26400, fits int16
+#define FFT_FULL_SCALE     (1650 << FFT_INPUT_SHIFT)
+#define FFT_PI             (3.14159265f)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief In-place Q15 radix-2 decimation-in-time transform of the work buffers.
+ *
+ * Every butterfly output is halved, so the result is scaled by 1 / points and never overflows.
+ */
+static void _fft_transform(void);
+
+/**
+ * @brief Window value at a position, 0.0 - 1.0.
+ *
+ * @param[in] window Window type.
+ * @param[in] position Sample index.
+ * @param[in] points Transform size.
+ *
+ * @return Window value.
+ */
+static float _fft_window_value(oscilloscope_fft_window_t window, uint32_t position, uint32_t points);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static int16_t twiddle_cos[OSCILLOSCOPE_FFT_MAX_POINTS / 2];
+static int16_t twiddle_sin[OSCILLOSCOPE_FFT_MAX_POINTS / 2];  // -sin, forward transform
+static int16_t window_table[OSCILLOSCOPE_FFT_MAX_POINTS];
+static int16_t work_re[OSCILLOSCOPE_FFT_MAX_POINTS];
+static int16_t work_im[OSCILLOSCOPE_FFT_MAX_POINTS];
+
+static uint32_t fft_points = 0;
+static uint32_t fft_stages = 0;
+static oscilloscope_fft_window_t fft_window = OSCILLOSCOPE_FFT_WINDOW_RECTANGULAR;
+static float fft_db_offset = 0.0f;  // 0.1 dB, full scale and window gain correction
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_fft_init(void)
+{
+    for(uint32_t k = 0; k < OSCILLOSCOPE_FFT_MAX_POINTS / 2; k++)
+    {
+        float angle = 2.0f * FFT_PI * k / OSCILLOSCOPE_FFT_MAX_POINTS;
+        twiddle_cos[k] = (int16_t)lrintf(cosf(angle) * FFT_Q15_ONE);
+        twiddle_sin[k] = (int16_t)lrintf(-sinf(angle) * FFT_Q15_ONE);
+    }
+
+    fft_points = 0;
+    oscilloscope_fft_configure(OSCILLOSCOPE_FFT_WINDOW_HANN, OSCILLOSCOPE_FFT_MAX_POINTS);
+}
+
+bool oscilloscope_fft_configure(oscilloscope_fft_window_t window, uint32_t points)
+{
+    if((OSCILLOSCOPE_FFT_MIN_POINTS > points) || (OSCILLOSCOPE_FFT_MAX_POINTS < points) || (0 != (points & (points - 1))))
+    {
+        return false;
+    }
+
+    if((points == fft_points) && (window == fft_window))
+    {
+        return true;
+    }
+
+    float gain = 0.0f;
+    for(uint32_t n = 0; n < points; n++)
+    {
+        float value = _fft_window_value(window, n, points);
+        gain += value;
+
+        int32_t q15 = lrintf(value * FFT_Q15_ONE);
+        window_table[n] = (int16_t)((FFT_Q15_ONE < q15) ? FFT_Q15_ONE : q15);
+    }
+    gain /= points;
+
+    /* Sine amplitude is 2 * |X| / gain, 0 dBFS at FFT_FULL_SCALE. */
+    fft_db_offset = 200.0f * log10f(2.0f / (gain * FFT_FULL_SCALE));
+
+    fft_stages = 0;
+    while((1U << fft_stages) < points)
+    {
+        fft_stages++;
+    }
+    fft_points = points;
+    fft_window = window;
+    return true;
+}
+
+uint32_t oscilloscope_fft_spectrum(const uint16_t *samples, lv_coord_t *columns_db, uint32_t columns)
+{
+    uint32_t bins = fft_points / 2;
+    if((NULL == samples) || (NULL == columns_db) || (0 == columns))
+    {
+        return 0;
+    }
+
+    /* Remove DC, scale to Q15 and apply the window, in bit-reversed order for the transform. */
+    int32_t sum = 0;
+    for(uint32_t n = 0; n < fft_points; n++)
+    {
+        sum += samples[n];
+    }
+    int32_t mean = sum / (int32_t)fft_points;
+
+    for(uint32_t n = 0; n < fft_points; n++)
+    {
+        uint32_t reversed = 0;
+        for(uint32_t bit = 0; bit < fft_stages; bit++)
+        {
+            reversed |= ((n >> bit) & 1U) << (fft_stages - 1 - bit);
+        }
+
+        int32_t centered = ((int32_t)samples[n] - mean) << FFT_INPUT_SHIFT;
+        work_re[reversed] = (int16_t)((centered * window_table[n]) >> 15);
+        work_im[reversed] = 0;
+    }
+
+    _fft_transform();
+
+    /* Highest power of every column, one logarithm per column. A column without a bin of its own, when there
+     * are more columns than bins, repeats the previous one. */
+    uint32_t peak_bin = 0;
+    uint32_t peak_power = 0;
+    uint32_t bin = 0;
+    for(uint32_t c = 0; c < columns; c++)
+    {
+        uint32_t column_end = ((c + 1) * bins + columns - 1) / columns;
+        uint32_t column_power = 0;
+        if(bin == column_end)
+        {
+            columns_db[c] = columns_db[c - 1];
+            continue;
+        }
+
+        for(; bin < column_end; bin++)
+        {
+            uint32_t power = (uint32_t)((int32_t)work_re[bin] * work_re[bin]) +
+                             (uint32_t)((int32_t)work_im[bin] * work_im[bin]);
+            if(power > column_power)
+            {
+                column_power = power;
+            }
+            if((0 != bin) && (power > peak_power))
+            {
+                peak_power = power;
+                peak_bin = bin;
+            }
+        }
+
+        int32_t db = OSCILLOSCOPE_FFT_DB_FLOOR;
+        if(0 != column_power)
+        {
+            db = lrintf(100.0f * log10f((float)column_power) + fft_db_offset);
+        }
+        columns_db[c] = (lv_coord_t)((OSCILLOSCOPE_FFT_DB_FLOOR > db) ? OSCILLOSCOPE_FFT_DB_FLOOR : ((0 < db) ? 0 : db));
+    }
+
+    return peak_bin;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _fft_transform(void)
+{
+    for(uint32_t length = 2; length <= fft_points; length <<= 1)
+    {
+        uint32_t half = length / 2;
+        uint32_t stride = OSCILLOSCOPE_FFT_MAX_POINTS / length;
+
+        for(uint32_t start = 0; start < fft_points; start += length)
+        {
+            for(uint32_t k = 0; k < half; k++)
+            {
+                int32_t wr = twiddle_cos[k * stride];
+                int32_t wi = twiddle_sin[k * stride];
+                uint32_t a = start + k;
+                uint32_t b = a + half;
+
+                int32_t tr = (wr * work_re[b] - wi * work_im[b]) >> 15;
+                int32_t ti = (wr * work_im[b] + wi * work_re[b]) >> 15;
+
+                work_re[b] = (int16_t)((work_re[a] - tr) >> 1);
+                work_im[b] = (int16_t)((work_im[a] - ti) >> 1);
+                work_re[a] = (int16_t)((work_re[a] + tr) >> 1);
+                work_im[a] = (int16_t)((work_im[a] + ti) >> 1);
+            }
+        }
+    }
+}
+
+static float _fft_window_value(oscilloscope_fft_window_t window, uint32_t position, uint32_t points)
+{
+    float x = 2.0f * FFT_PI * position / points;
+
+    switch(window)
+    {
+    case OSCILLOSCOPE_FFT_WINDOW_HANN:
+        return 0.5f - 0.5f * cosf(x);
+    case OSCILLOSCOPE_FFT_WINDOW_BLACKMAN:
+        return 0.42f - 0.5f * cosf(x) + 0.08f * cosf(2.0f * x);
+    case OSCILLOSCOPE_FFT_WINDOW_FLAT_TOP:
+        return 0.21557895f - 0.41663158f * cosf(x) + 0.277263158f * cosf(2.0f * x) -
+               0.083578947f * cosf(3.0f * x) + 0.006947368f * cosf(4.0f * x);
+    default:
+        return 1.0f;
+    }
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
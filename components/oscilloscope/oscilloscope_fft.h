@@ -0,0 +1,74 @@
+/**
+* @file oscilloscope_fft.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_FFT_H__
+#define __OSCILLOSCOPE_FFT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+//---------------------------------- MACROS -----------------------------------
+/* Power of 2, sizes the twiddle, window and work tables and the spectrum capture of every channel. Transforms
+ * up to 4096 points work, but every doubling above 1024 costs about 20 KB more static RAM, which a board without
+ * PSRAM does not have, so a larger size has to be set for the build. */
+#ifndef OSCILLOSCOPE_FFT_MAX_POINTS
+#define OSCILLOSCOPE_FFT_MAX_POINTS (1024U)
+#endif
+#define OSCILLOSCOPE_FFT_MIN_POINTS (16U)
+
+#define OSCILLOSCOPE_FFT_DB_SCALE (10)       // Spectrum is in 0.1 dB steps
+#define OSCILLOSCOPE_FFT_DB_FLOOR (-900)     // -90 dBFS
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum{
+    OSCILLOSCOPE_FFT_WINDOW_RECTANGULAR,
+    OSCILLOSCOPE_FFT_WINDOW_HANN,
+    OSCILLOSCOPE_FFT_WINDOW_BLACKMAN,
+    OSCILLOSCOPE_FFT_WINDOW_FLAT_TOP
+} oscilloscope_fft_window_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Build the twiddle table for OSCILLOSCOPE_FFT_MAX_POINTS. Smaller transforms reuse it with a stride.
+ */
+void oscilloscope_fft_init(void);
+
+/**
+ * @brief Select the window and transform size. Rebuilds the window table if either changed.
+ *
+ * @param[in] window Window applied before the transform.
+ * @param[in] points Transform size, a power of 2 between OSCILLOSCOPE_FFT_MIN_POINTS and OSCILLOSCOPE_FFT_MAX_POINTS.
+ *
+ * @return true if the size is valid.
+ */
+bool oscilloscope_fft_configure(oscilloscope_fft_window_t window, uint32_t points);
+
+/**
+ * @brief Compute the magnitude spectrum of a frame of millivolt samples and reduce it to display columns.
+ *
+ * The mean is removed, the window applied and a Q15 radix-2 transform run with scaling in every stage, so it
+ * can not overflow. Every column holds the highest bin it covers in 0.1 dBFS, where 0 dBFS is a sine over the
+ * full 0 - 3300 mV range, corrected for the window's coherent gain and clamped at OSCILLOSCOPE_FFT_DB_FLOOR.
+ *
+ * @param[in] samples Samples in millivolts, as many as the configured transform size.
+ * @param[out] columns_db Spectrum, `columns` entries from DC to half the sample rate.
+ * @param[in] columns Number of display columns. Columns beyond half the transform size repeat bins.
+ *
+ * @return Index of the highest bin except DC, 0 if the spectrum is empty.
+ */
+uint32_t oscilloscope_fft_spectrum(const uint16_t *samples, lv_coord_t *columns_db, uint32_t columns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_FFT_H__
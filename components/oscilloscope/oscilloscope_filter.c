@@ -0,0 +1,348 @@
+/**
+* @file oscilloscope_filter.c
+*
+* @brief Streaming filters of the acquisition pipeline: fixed-point Butterworth biquad cascades and a
+*        fixed-point windowed-sinc FIR, with the state kept from one sample, block or frame to the next.
+*        Coefficients are computed in double precision when the filter or the sample rate changes; the
+*        sample path is integer only.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_filter.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define FILTER_COEFFICIENT_BITS (30U)   // Biquad coefficients, |a1| and |b1| stay below 2
+#define FILTER_STATE_BITS       (8U)    // Fraction bits of the biquad state, keeps the rounding noise low
+#define FILTER_FIR_BITS         (15U)
+#define FILTER_MAX_RATIO        (0.45)  // Highest frequency as a part of the sample rate
+#define FILTER_BUTTERWORTH_Q    (0.70710678)
+#define FILTER_PI               (3.14159265358979)
+
+/* Q of the two sections of a 4th order Butterworth filter. */
+#define FILTER_BUTTERWORTH4_Q1  (0.54119610)
+#define FILTER_BUTTERWORTH4_Q2  (1.30656296)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum{
+    BIQUAD_LOWPASS,
+    BIQUAD_HIGHPASS,
+    BIQUAD_NOTCH
+} biquad_type_t;
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Compute the coefficients of one section, bilinear transform as in the RBJ audio EQ cookbook.
+ *
+ * @param[out] biquad Section.
+ * @param[in] type Section type.
+ * @param[in] ratio Frequency as a part of the sample rate.
+ * @param[in] q Quality factor.
+ */
+static void _filter_biquad_design(oscilloscope_biquad_t *biquad, biquad_type_t type, double ratio, double q);
+
+/**
+ * @brief Compute the Q15 taps of a windowed-sinc FIR.
+ *
+ * @param[out] taps OSCILLOSCOPE_FILTER_FIR_TAPS coefficients.
+ * @param[in] type Low-pass, high-pass or band-pass.
+ * @param[in] low Lower edge as a part of the sample rate, band-pass only.
+ * @param[in] high Cutoff or upper edge as a part of the sample rate.
+ */
+static void _filter_fir_design(int16_t *taps, oscilloscope_filter_type_t type, double low, double high);
+
+/**
+ * @brief Fill the state with the steady state of a constant input.
+ *
+ * @param[in,out] filter Filter.
+ * @param[in] sample First sample in millivolts.
+ */
+static void _filter_prime(oscilloscope_filter_t *filter, uint16_t sample);
+
+/**
+ * @brief Run one biquad section.
+ *
+ * @param[in,out] biquad Section.
+ * @param[in] x Input, millivolts Q8.
+ *
+ * @return Output, millivolts Q8.
+ */
+static inline int32_t _filter_biquad_run(oscilloscope_biquad_t *biquad, int32_t x);
+
+/**
+ * @brief Clamp an output to the millivolt range.
+ *
+ * @param[in] value Output in millivolts.
+ *
+ * @return Value within 0 - OSCILLOSCOPE_FILTER_MAX_MV.
+ */
+static inline uint16_t _filter_clamp(int32_t value);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool oscilloscope_filter_design(oscilloscope_filter_t *filter, const oscilloscope_filter_config_t *config,
+                                uint32_t sample_rate_hz)
+{
+    memset(filter, 0, sizeof(*filter));
+    if((OSCILLOSCOPE_FILTER_OFF == config->type) || (0 == sample_rate_hz))
+    {
+        return OSCILLOSCOPE_FILTER_OFF == config->type;
+    }
+
+    double rate = (double)sample_rate_hz;
+    double high = config->frequency_hz / rate;
+    double low = 0.0;
+    if(OSCILLOSCOPE_FILTER_BANDPASS == config->type)
+    {
+        low = ((double)config->frequency_hz - config->bandwidth_hz / 2.0) / rate;
+        high = ((double)config->frequency_hz + config->bandwidth_hz / 2.0) / rate;
+    }
+    else if(OSCILLOSCOPE_FILTER_NOTCH_50HZ == config->type)
+    {
+        high = OSCILLOSCOPE_FILTER_NOTCH_HZ / rate;
+    }
+
+    if((0.0 >= high) || (FILTER_MAX_RATIO < high) || ((OSCILLOSCOPE_FILTER_BANDPASS == config->type) && (0.0 >= low)))
+    {
+        return false;
+    }
+
+    filter->fir = (OSCILLOSCOPE_FILTER_FIR == config->structure) && (OSCILLOSCOPE_FILTER_NOTCH_50HZ != config->type);
+    filter->offset_mv = ((OSCILLOSCOPE_FILTER_HIGHPASS == config->type) || (OSCILLOSCOPE_FILTER_BANDPASS == config->type)) ?
+                        OSCILLOSCOPE_FILTER_AC_CENTER_MV : 0;
+
+    if(filter->fir)
+    {
+        _filter_fir_design(filter->fir_coefficient, config->type, low, high);
+    }
+    else
+    {
+        switch(config->type)
+        {
+        case OSCILLOSCOPE_FILTER_LOWPASS:
+            _filter_biquad_design(&filter->biquad[0], BIQUAD_LOWPASS, high, FILTER_BUTTERWORTH4_Q1);
+            _filter_biquad_design(&filter->biquad[1], BIQUAD_LOWPASS, high, FILTER_BUTTERWORTH4_Q2);
+            filter->sections = 2;
+            break;
+        case OSCILLOSCOPE_FILTER_HIGHPASS:
+            _filter_biquad_design(&filter->biquad[0], BIQUAD_HIGHPASS, high, FILTER_BUTTERWORTH4_Q1);
+            _filter_biquad_design(&filter->biquad[1], BIQUAD_HIGHPASS, high, FILTER_BUTTERWORTH4_Q2);
+            filter->sections = 2;
+            break;
+        case OSCILLOSCOPE_FILTER_BANDPASS:
+            /* 2nd order Butterworth high-pass at the lower edge, low-pass at the upper edge. */
+            _filter_biquad_design(&filter->biquad[0], BIQUAD_HIGHPASS, low, FILTER_BUTTERWORTH_Q);
+            _filter_biquad_design(&filter->biquad[1], BIQUAD_LOWPASS, high, FILTER_BUTTERWORTH_Q);
+            filter->sections = 2;
+            break;
+        default:
+            _filter_biquad_design(&filter->biquad[0], BIQUAD_NOTCH, high, OSCILLOSCOPE_FILTER_NOTCH_Q);
+            filter->sections = 1;
+            break;
+        }
+    }
+
+    filter->active = true;
+    return true;
+}
+
+void oscilloscope_filter_reset(oscilloscope_filter_t *filter)
+{
+    filter->primed = false;
+}
+
+uint16_t oscilloscope_filter_sample(oscilloscope_filter_t *filter, uint16_t sample)
+{
+    if(!filter->active)
+    {
+        return sample;
+    }
+    if(!filter->primed)
+    {
+        _filter_prime(filter, sample);
+    }
+
+    if(filter->fir)
+    {
+        /* Newest sample first, written twice so the window never wraps. */
+        filter->fir_position = (0 == filter->fir_position) ? (OSCILLOSCOPE_FILTER_FIR_TAPS - 1) :
+                                                             (filter->fir_position - 1);
+        filter->fir_delay[filter->fir_position] = (int16_t)sample;
+        filter->fir_delay[filter->fir_position + OSCILLOSCOPE_FILTER_FIR_TAPS] = (int16_t)sample;
+
+        const int16_t *window = &filter->fir_delay[filter->fir_position];
+        int32_t acc = 1 << (FILTER_FIR_BITS - 1);
+        for(uint32_t k = 0; k < OSCILLOSCOPE_FILTER_FIR_TAPS; k++)
+        {
+            acc += (int32_t)filter->fir_coefficient[k] * window[k];
+        }
+        return _filter_clamp((acc >> FILTER_FIR_BITS) + filter->offset_mv);
+    }
+
+    int32_t y = (int32_t)sample << FILTER_STATE_BITS;
+    for(uint32_t s = 0; s < filter->sections; s++)
+    {
+        y = _filter_biquad_run(&filter->biquad[s], y);
+    }
+    return _filter_clamp(((y + (1 << (FILTER_STATE_BITS - 1))) >> FILTER_STATE_BITS) + filter->offset_mv);
+}
+
+void oscilloscope_filter_block(oscilloscope_filter_t *filter, const uint16_t *input, uint16_t *output,
+                               uint32_t count)
+{
+    for(uint32_t n = 0; n < count; n++)
+    {
+        output[n] = oscilloscope_filter_sample(filter, input[n]);
+    }
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _filter_biquad_design(oscilloscope_biquad_t *biquad, biquad_type_t type, double ratio, double q)
+{
+    double w0 = 2.0 * FILTER_PI * ratio;
+    double cos_w0 = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    double b0, b1, b2;
+
+    switch(type)
+    {
+    case BIQUAD_LOWPASS:
+        b0 = (1.0 - cos_w0) / 2.0;
+        b1 = 1.0 - cos_w0;
+        b2 = b0;
+        break;
+    case BIQUAD_HIGHPASS:
+        b0 = (1.0 + cos_w0) / 2.0;
+        b1 = -(1.0 + cos_w0);
+        b2 = b0;
+        break;
+    default:
+        b0 = 1.0;
+        b1 = -2.0 * cos_w0;
+        b2 = 1.0;
+        break;
+    }
+
+    double a0 = 1.0 + alpha;
+    double a1 = -2.0 * cos_w0 / a0;
+    double a2 = (1.0 - alpha) / a0;
+    b0 /= a0;
+    b1 /= a0;
+    b2 /= a0;
+
+    const double scale = (double)(1UL << FILTER_COEFFICIENT_BITS);
+    biquad->b0 = (int32_t)llround(b0 * scale);
+    biquad->b1 = (int32_t)llround(b1 * scale);
+    biquad->b2 = (int32_t)llround(b2 * scale);
+    biquad->a1 = (int32_t)llround(a1 * scale);
+    biquad->a2 = (int32_t)llround(a2 * scale);
+    biquad->dc_gain = (int32_t)lround(65536.0 * (b0 + b1 + b2) / (1.0 + a1 + a2));
+}
+
+static void _filter_fir_design(int16_t *taps, oscilloscope_filter_type_t type, double low, double high)
+{
+    const int32_t middle = OSCILLOSCOPE_FILTER_FIR_TAPS / 2;
+    double h[OSCILLOSCOPE_FILTER_FIR_TAPS];
+    double sum = 0.0;
+
+    /* Low-pass at `high`, normalized to unity gain at DC. */
+    for(int32_t n = 0; n < (int32_t)OSCILLOSCOPE_FILTER_FIR_TAPS; n++)
+    {
+        double window = 0.54 - 0.46 * cos(2.0 * FILTER_PI * n / (OSCILLOSCOPE_FILTER_FIR_TAPS - 1));
+        double t = n - middle;
+        h[n] = window * ((0 == n - middle) ? 2.0 * high : sin(2.0 * FILTER_PI * high * t) / (FILTER_PI * t));
+        sum += h[n];
+    }
+    for(uint32_t n = 0; n < OSCILLOSCOPE_FILTER_FIR_TAPS; n++)
+    {
+        h[n] /= sum;
+    }
+
+    if(OSCILLOSCOPE_FILTER_HIGHPASS == type)
+    {
+        /* Spectral inversion. */
+        for(uint32_t n = 0; n < OSCILLOSCOPE_FILTER_FIR_TAPS; n++)
+        {
+            h[n] = -h[n];
+        }
+        h[middle] += 1.0;
+    }
+    else if(OSCILLOSCOPE_FILTER_BANDPASS == type)
+    {
+        /* Difference of the low-passes at the two edges. */
+        double lower[OSCILLOSCOPE_FILTER_FIR_TAPS];
+        double lower_sum = 0.0;
+        for(int32_t n = 0; n < (int32_t)OSCILLOSCOPE_FILTER_FIR_TAPS; n++)
+        {
+            double window = 0.54 - 0.46 * cos(2.0 * FILTER_PI * n / (OSCILLOSCOPE_FILTER_FIR_TAPS - 1));
+            double t = n - middle;
+            lower[n] = window * ((0 == n - middle) ? 2.0 * low : sin(2.0 * FILTER_PI * low * t) / (FILTER_PI * t));
+            lower_sum += lower[n];
+        }
+        for(uint32_t n = 0; n < OSCILLOSCOPE_FILTER_FIR_TAPS; n++)
+        {
+            h[n] -= lower[n] / lower_sum;
+        }
+    }
+
+    for(uint32_t n = 0; n < OSCILLOSCOPE_FILTER_FIR_TAPS; n++)
+    {
+        long tap = lround(h[n] * (1 << FILTER_FIR_BITS));
+        taps[n] = (int16_t)((INT16_MAX < tap) ? INT16_MAX : ((INT16_MIN > tap) ? INT16_MIN : tap));
+    }
+}
+
+static void _filter_prime(oscilloscope_filter_t *filter, uint16_t sample)
+{
+    for(uint32_t k = 0; k < 2 * OSCILLOSCOPE_FILTER_FIR_TAPS; k++)
+    {
+        filter->fir_delay[k] = (int16_t)sample;
+    }
+    filter->fir_position = 0;
+
+    int32_t x = (int32_t)sample << FILTER_STATE_BITS;
+    for(uint32_t s = 0; s < filter->sections; s++)
+    {
+        oscilloscope_biquad_t *biquad = &filter->biquad[s];
+        int32_t y = (int32_t)(((int64_t)x * biquad->dc_gain) >> 16);
+        biquad->x1 = x;
+        biquad->x2 = x;
+        biquad->y1 = y;
+        biquad->y2 = y;
+        biquad->error = 0;
+        x = y;
+    }
+
+    filter->primed = true;
+}
+
+static inline int32_t _filter_biquad_run(oscilloscope_biquad_t *biquad, int32_t x)
+{
+    /* Error feedback moves the rounding noise away from DC, where low cutoffs amplify it the most. */
+    int64_t acc = (int64_t)biquad->b0 * x + (int64_t)biquad->b1 * biquad->x1 + (int64_t)biquad->b2 * biquad->x2 -
+                  (int64_t)biquad->a1 * biquad->y1 - (int64_t)biquad->a2 * biquad->y2 + biquad->error;
+    int32_t y = (int32_t)(acc >> FILTER_COEFFICIENT_BITS);
+    biquad->error = (int32_t)(acc - ((int64_t)y << FILTER_COEFFICIENT_BITS));
+
+    biquad->x2 = biquad->x1;
+    biquad->x1 = x;
+    biquad->y2 = biquad->y1;
+    biquad->y1 = y;
+    return y;
+}
+
+static inline uint16_t _filter_clamp(int32_t value)
+{
+    value = (0 > value) ? 0 : value;
+    return (uint16_t)((OSCILLOSCOPE_FILTER_MAX_MV < value) ? OSCILLOSCOPE_FILTER_MAX_MV : value);
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
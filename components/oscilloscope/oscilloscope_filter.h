@@ -0,0 +1,118 @@
+/**
+* @file oscilloscope_filter.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_FILTER_H__
+#define __OSCILLOSCOPE_FILTER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_FILTER_SECTIONS     (2U)     // Biquads per cascade, 4th order
+#define OSCILLOSCOPE_FILTER_FIR_TAPS     (31U)    // Odd, linear phase for every type
+#define OSCILLOSCOPE_FILTER_NOTCH_HZ     (50U)
+#define OSCILLOSCOPE_FILTER_NOTCH_Q      (5.0f)   // 10 Hz wide at -3 dB
+#define OSCILLOSCOPE_FILTER_AC_CENTER_MV (1650)   // Zero of the high-pass and band-pass outputs
+#define OSCILLOSCOPE_FILTER_MAX_MV       (3300)   // Outputs are clamped to 0 - 3300 mV
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum{
+    OSCILLOSCOPE_FILTER_OFF,
+    OSCILLOSCOPE_FILTER_LOWPASS,
+    OSCILLOSCOPE_FILTER_HIGHPASS,
+    OSCILLOSCOPE_FILTER_BANDPASS,
+    OSCILLOSCOPE_FILTER_NOTCH_50HZ
+} oscilloscope_filter_type_t;
+
+typedef enum{
+    OSCILLOSCOPE_FILTER_IIR,  // Butterworth biquad cascade, for cutoffs down to a small part of the sample rate
+    OSCILLOSCOPE_FILTER_FIR   // Hamming windowed sinc, linear phase, for cutoffs above about 1/20 of the rate
+} oscilloscope_filter_structure_t;
+
+typedef struct
+{
+    oscilloscope_filter_type_t type;
+    oscilloscope_filter_structure_t structure;  // The notch is always a biquad
+    uint32_t frequency_hz;                      // Cutoff, or center of the band-pass
+    uint32_t bandwidth_hz;                      // Band-pass only
+} oscilloscope_filter_config_t;
+
+/* Direct form I biquad, coefficients Q30, state in millivolts Q8. */
+typedef struct
+{
+    int32_t b0, b1, b2;
+    int32_t a1, a2;     // Sign as in y = b0 x0 + b1 x1 + b2 x2 - a1 y1 - a2 y2
+    int32_t dc_gain;    // Q16, to start from the steady state
+    int32_t x1, x2;
+    int32_t y1, y2;
+    int32_t error;      // Bits dropped from the last output, fed back into the next one
+} oscilloscope_biquad_t;
+
+typedef struct
+{
+    bool active;        // false passes samples through
+    bool fir;
+    bool primed;        // State holds the steady state of the first sample
+    int32_t offset_mv;  // Added to the output, OSCILLOSCOPE_FILTER_AC_CENTER_MV without DC
+    uint32_t sections;
+    oscilloscope_biquad_t biquad[OSCILLOSCOPE_FILTER_SECTIONS];
+    int16_t fir_coefficient[OSCILLOSCOPE_FILTER_FIR_TAPS];      // Q15
+    int16_t fir_delay[2 * OSCILLOSCOPE_FILTER_FIR_TAPS];        // Doubled, every window is contiguous
+    uint32_t fir_position;
+} oscilloscope_filter_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Compute the coefficients of a filter and clear its state. Floating point, not for the sample path.
+ *
+ * @param[out] filter Filter to configure.
+ * @param[in] config Type, structure and frequencies.
+ * @param[in] sample_rate_hz Rate of the samples the filter will see.
+ *
+ * @return false if the frequencies do not fit below 0.45 of the sample rate. The filter then passes
+ *         samples through, as it does when the type is off.
+ */
+bool oscilloscope_filter_design(oscilloscope_filter_t *filter, const oscilloscope_filter_config_t *config,
+                                uint32_t sample_rate_hz);
+
+/**
+ * @brief Clear the state, the next sample starts the filter from its steady state.
+ *
+ * @param[in,out] filter Filter.
+ */
+void oscilloscope_filter_reset(oscilloscope_filter_t *filter);
+
+/**
+ * @brief Filter one sample, keeping the state for the next one.
+ *
+ * @param[in,out] filter Filter.
+ * @param[in] sample Input in millivolts.
+ *
+ * @return Output in millivolts.
+ */
+uint16_t oscilloscope_filter_sample(oscilloscope_filter_t *filter, uint16_t sample);
+
+/**
+ * @brief Filter a block of samples, keeping the state for the next block. May work in place.
+ *
+ * @param[in,out] filter Filter.
+ * @param[in] input Input in millivolts.
+ * @param[out] output Output in millivolts.
+ * @param[in] count Number of samples.
+ */
+void oscilloscope_filter_block(oscilloscope_filter_t *filter, const uint16_t *input, uint16_t *output,
+                               uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_FILTER_H__
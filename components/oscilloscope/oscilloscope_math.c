@@ -0,0 +1,103 @@
+/**
+* @file oscilloscope_math.c
+*
+* @brief Math trace of the oscilloscope, computed by the sampler on the display columns of a frame. Results
+*        are scaled to fit the 0 - 3.3 V chart; signed results are centered on OSCILLOSCOPE_MATH_ZERO_MV.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_math.h"
+
+//---------------------------------- MACROS -----------------------------------
+/* Product: a * b / 3300 as ((a * b) >> 8) * (2^26 / 3300) >> 18, exact to 0.1 mV and within 32 bits. */
+#define MATH_PRODUCT_PRESHIFT   (8U)
+#define MATH_PRODUCT_RECIPROCAL (20336)
+#define MATH_PRODUCT_SHIFT      (18U)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Clamp a value to the chart range.
+ *
+ * @param[in] value Value in displayed millivolts.
+ *
+ * @return Value within 0 - OSCILLOSCOPE_MATH_FULL_SCALE_MV.
+ */
+static inline lv_coord_t _math_clamp(int32_t value);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_math_compute(oscilloscope_math_t operation, const lv_coord_t *a, const lv_coord_t *b,
+                               lv_coord_t *result, uint32_t count)
+{
+    switch(operation)
+    {
+    case OSCILLOSCOPE_MATH_ADD:
+        for(uint32_t n = 0; n < count; n++)
+        {
+            result[n] = _math_clamp(((int32_t)a[n] + b[n]) >> 1);
+        }
+        break;
+    case OSCILLOSCOPE_MATH_SUBTRACT:
+        for(uint32_t n = 0; n < count; n++)
+        {
+            result[n] = _math_clamp(OSCILLOSCOPE_MATH_ZERO_MV + (((int32_t)a[n] - b[n]) >> 1));
+        }
+        break;
+    case OSCILLOSCOPE_MATH_MULTIPLY:
+        for(uint32_t n = 0; n < count; n++)
+        {
+            int32_t product = (_math_clamp(a[n]) * _math_clamp(b[n])) >> MATH_PRODUCT_PRESHIFT;
+            result[n] = _math_clamp((product * MATH_PRODUCT_RECIPROCAL) >> MATH_PRODUCT_SHIFT);
+        }
+        break;
+    case OSCILLOSCOPE_MATH_DERIVATIVE:
+    {
+        /* Central difference over two columns, one-sided at the edges. */
+        const int32_t gain = OSCILLOSCOPE_MATH_DERIVATIVE_GAIN / 2;
+        result[0] = _math_clamp(OSCILLOSCOPE_MATH_ZERO_MV + 2 * gain * ((int32_t)a[1] - a[0]));
+        for(uint32_t n = 1; n < count - 1; n++)
+        {
+            result[n] = _math_clamp(OSCILLOSCOPE_MATH_ZERO_MV + gain * ((int32_t)a[n + 1] - a[n - 1]));
+        }
+        result[count - 1] = _math_clamp(OSCILLOSCOPE_MATH_ZERO_MV + 2 * gain * ((int32_t)a[count - 1] - a[count - 2]));
+        break;
+    }
+    case OSCILLOSCOPE_MATH_INTEGRAL:
+    {
+        /* Without the mean, the integral of a periodic signal stays on the screen. */
+        int32_t sum = 0;
+        for(uint32_t n = 0; n < count; n++)
+        {
+            sum += a[n];
+        }
+        int32_t mean = sum / (int32_t)count;
+
+        int32_t integral = 0;
+        for(uint32_t n = 0; n < count; n++)
+        {
+            integral += (int32_t)a[n] - mean;
+            result[n] = _math_clamp(OSCILLOSCOPE_MATH_ZERO_MV + (integral >> OSCILLOSCOPE_MATH_INTEGRAL_SHIFT));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static inline lv_coord_t _math_clamp(int32_t value)
+{
+    value = (0 > value) ? 0 : value;
+    return (lv_coord_t)((OSCILLOSCOPE_MATH_FULL_SCALE_MV < value) ? OSCILLOSCOPE_MATH_FULL_SCALE_MV : value);
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,54 @@
+/**
+* @file oscilloscope_math.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_MATH_H__
+#define __OSCILLOSCOPE_MATH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include "lvgl.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_MATH_FULL_SCALE_MV   (3300)  // Results are clamped to 0 - full scale
+#define OSCILLOSCOPE_MATH_ZERO_MV         (1650)  // Zero of the signed results
+#define OSCILLOSCOPE_MATH_DERIVATIVE_GAIN (8)     // Displayed mV per mV of change per column
+#define OSCILLOSCOPE_MATH_INTEGRAL_SHIFT  (5U)    // Displayed mV per 32 mV x columns
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum{
+    OSCILLOSCOPE_MATH_OFF,
+    OSCILLOSCOPE_MATH_ADD,         // (a + b) / 2
+    OSCILLOSCOPE_MATH_SUBTRACT,    // (a - b) / 2, zero in the middle
+    OSCILLOSCOPE_MATH_MULTIPLY,    // a * b / 3.3 V
+    OSCILLOSCOPE_MATH_DERIVATIVE,  // Of a, zero in the middle
+    OSCILLOSCOPE_MATH_INTEGRAL     // Of a without its mean, zero in the middle
+} oscilloscope_math_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Compute a math trace from time aligned display columns, in displayed millivolts.
+ *
+ * Integer only, with no division in the loops. The two-input operations are plain element-wise loops
+ * the compiler can unroll and vectorize.
+ *
+ * @param[in] operation Operation, OSCILLOSCOPE_MATH_OFF leaves the result untouched.
+ * @param[in] a First input in millivolts, CH1.
+ * @param[in] b Second input in millivolts, CH2. Not read by the derivative and the integral.
+ * @param[out] result Math trace, `count` entries.
+ * @param[in] count Number of columns, at least 2.
+ */
+void oscilloscope_math_compute(oscilloscope_math_t operation, const lv_coord_t *a, const lv_coord_t *b,
+                               lv_coord_t *result, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_MATH_H__
@@ -0,0 +1,250 @@
+/**
+* @file oscilloscope_measure.c
+*
+* @brief Automatic measurements of oscilloscope captures: min, max, mean, RMS, frequency, period, duty
+*        cycle and 10 - 90 % rise and fall time, computed in one streaming pass with integer arithmetic.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_measure.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define MEASURE_SUBSAMPLE_SHIFT (8U)   // Crossing instants in 1/256 of a sample
+#define MEASURE_HYSTERESIS_DIV  (20U)  // Edge hysteresis is 5 % of the amplitude
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Instant at which the signal crosses a level between two samples.
+ *
+ * @param[in] n Index of the sample after the crossing.
+ * @param[in] previous Sample before the crossing.
+ * @param[in] value Sample after the crossing.
+ * @param[in] level Crossed level, between `previous` and `value`.
+ *
+ * @return Crossing instant in 1/256 of a sample.
+ */
+static uint32_t _measure_crossing(uint32_t n, int32_t previous, int32_t value, int32_t level);
+
+/**
+ * @brief Integer square root.
+ *
+ * @param[in] value Radicand.
+ *
+ * @return Largest integer whose square does not exceed `value`.
+ */
+static uint32_t _measure_sqrt(uint64_t value);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_measure(const uint16_t *capture, uint32_t length, uint32_t start, uint32_t sample_period_ns,
+                          const oscilloscope_measure_levels_t *levels, oscilloscope_measurements_t *result)
+{
+    if((NULL == capture) || (NULL == levels) || (NULL == result) || (0 == length))
+    {
+        return;
+    }
+
+    bool timing = (levels->low < levels->high);
+    uint32_t sum = 0;
+    uint64_t sum_squares = 0;
+    uint16_t min = UINT16_MAX;
+    uint16_t max = 0;
+
+    /* Edge state. Rising edges are counted on mid_high, the signal is low again below mid_low. */
+    bool high = true;
+    uint32_t rising_edges = 0;
+    uint32_t first_edge = 0;
+    uint32_t last_edge = 0;
+    uint32_t above_mid = 0;
+    uint32_t above_mid_first = 0;
+    uint32_t above_mid_last = 0;
+    uint32_t first_edge_sample = 0;
+    uint32_t last_edge_sample = 0;
+
+    /* Transition state. A rise starts when the signal leaves the low level and ends at the high level. */
+    uint32_t transition_start = 0;
+    bool rising = false;
+    bool falling = false;
+    uint32_t rise_sum = 0;
+    uint32_t rise_count = 0;
+    uint32_t fall_sum = 0;
+    uint32_t fall_count = 0;
+
+    uint32_t read = start;
+    int32_t previous = capture[start];
+    int32_t mid = ((int32_t)levels->mid_low + levels->mid_high) / 2;
+
+    for(uint32_t n = 0; n < length; n++)
+    {
+        uint16_t sample = capture[read];
+        int32_t value = sample;
+        if(length == ++read)
+        {
+            read = 0;
+        }
+
+        sum += sample;
+        sum_squares += (uint32_t)sample * sample;
+        if(sample < min)
+        {
+            min = sample;
+        }
+        if(sample > max)
+        {
+            max = sample;
+        }
+
+        if(!timing)
+        {
+            continue;
+        }
+
+        if(value >= mid)
+        {
+            above_mid++;
+        }
+
+        if(!high && (value >= levels->mid_high))
+        {
+            high = true;
+            last_edge = _measure_crossing(n, previous, value, levels->mid_high);
+            last_edge_sample = n;
+            above_mid_last = above_mid;
+            if(0 == rising_edges++)
+            {
+                first_edge = last_edge;
+                first_edge_sample = n;
+                above_mid_first = above_mid;
+            }
+        }
+        else if(high && (value <= levels->mid_low))
+        {
+            high = false;
+        }
+
+        if((previous <= levels->low) && (value > levels->low))
+        {
+            transition_start = _measure_crossing(n, previous, value, levels->low);
+            rising = true;
+            falling = false;
+        }
+        else if((previous >= levels->high) && (value < levels->high))
+        {
+            transition_start = _measure_crossing(n, previous, value, levels->high);
+            falling = true;
+            rising = false;
+        }
+
+        if(rising && (value >= levels->high))
+        {
+            rise_sum += _measure_crossing(n, previous, value, levels->high) - transition_start;
+            rise_count++;
+            rising = false;
+        }
+        else if(falling && (value <= levels->low))
+        {
+            fall_sum += _measure_crossing(n, previous, value, levels->low) - transition_start;
+            fall_count++;
+            falling = false;
+        }
+
+        previous = value;
+    }
+
+    result->min_mv = min;
+    result->max_mv = max;
+    result->mean_mv = (uint16_t)(sum / length);
+    result->rms_mv = (uint16_t)_measure_sqrt(sum_squares / length);
+
+    result->period_ns = 0;
+    result->frequency_mhz = 0;
+    result->duty_permille = 0;
+    if(1 < rising_edges)
+    {
+        uint64_t span_ns = ((uint64_t)(last_edge - first_edge) * sample_period_ns) >> MEASURE_SUBSAMPLE_SHIFT;
+        result->period_ns = (uint32_t)(span_ns / (rising_edges - 1));
+        if(0 != span_ns)
+        {
+            result->frequency_mhz = (uint32_t)((1000000000000ULL * (rising_edges - 1)) / span_ns);
+        }
+        if(last_edge_sample != first_edge_sample)
+        {
+            result->duty_permille = (uint16_t)(((above_mid_last - above_mid_first) * 1000U) /
+                                               (last_edge_sample - first_edge_sample));
+        }
+    }
+
+    result->rise_time_ns = (0 < rise_count) ?
+        (uint32_t)((((uint64_t)rise_sum * sample_period_ns) / rise_count) >> MEASURE_SUBSAMPLE_SHIFT) : 0;
+    result->fall_time_ns = (0 < fall_count) ?
+        (uint32_t)((((uint64_t)fall_sum * sample_period_ns) / fall_count) >> MEASURE_SUBSAMPLE_SHIFT) : 0;
+}
+
+void oscilloscope_measure_levels(const oscilloscope_measurements_t *result, oscilloscope_measure_levels_t *levels)
+{
+    if((NULL == result) || (NULL == levels))
+    {
+        return;
+    }
+
+    uint32_t amplitude = result->max_mv - result->min_mv;
+    uint32_t mid = result->min_mv + amplitude / 2;
+    uint32_t hysteresis = amplitude / MEASURE_HYSTERESIS_DIV;
+
+    levels->low = (uint16_t)(result->min_mv + amplitude / 10);
+    levels->high = (uint16_t)(result->max_mv - amplitude / 10);
+    levels->mid_low = (uint16_t)(mid - hysteresis);
+    levels->mid_high = (uint16_t)(mid + hysteresis);
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint32_t _measure_crossing(uint32_t n, int32_t previous, int32_t value, int32_t level)
+{
+    if(value == previous)
+    {
+        return n << MEASURE_SUBSAMPLE_SHIFT;
+    }
+
+    /* Linear interpolation from the previous sample, only evaluated at crossings. */
+    uint32_t fraction = (uint32_t)(((level - previous) << MEASURE_SUBSAMPLE_SHIFT) / (value - previous));
+    return ((n - 1) << MEASURE_SUBSAMPLE_SHIFT) + fraction;
+}
+
+static uint32_t _measure_sqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while(bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while(0 != bit)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,75 @@
+/**
+* @file oscilloscope_measure.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_MEASURE_H__
+#define __OSCILLOSCOPE_MEASURE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+/* Reference levels of the timing measurements, in millivolts. */
+typedef struct
+{
+    uint16_t low;        // 10 %
+    uint16_t mid_low;    // 50 % minus hysteresis, falling edge
+    uint16_t mid_high;   // 50 % plus hysteresis, rising edge
+    uint16_t high;       // 90 %
+} oscilloscope_measure_levels_t;
+
+typedef struct
+{
+    uint16_t min_mv;
+    uint16_t max_mv;
+    uint16_t mean_mv;
+    uint16_t rms_mv;         // Including DC
+    uint32_t period_ns;      // 0 if fewer than two rising edges
+    uint32_t frequency_mhz;  // Millihertz, 0 if fewer than two rising edges
+    uint16_t duty_permille;  // Part of the period at or above 50 %
+    uint32_t rise_time_ns;   // 10 % to 90 %, 0 if no complete rising edge
+    uint32_t fall_time_ns;   // 90 % to 10 %, 0 if no complete falling edge
+} oscilloscope_measurements_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Measure a circular capture in a single pass.
+ *
+ * Samples are read once, oldest first, starting at `start` and wrapping at `length`. Only integer
+ * accumulators are updated per sample; the divisions and the square root run once per capture. Edges and
+ * 10 - 90 % transitions are found against `levels`, which the caller derives from the previous capture
+ * with oscilloscope_measure_levels(), so no second pass over the samples is needed. Crossing instants are
+ * interpolated between samples.
+ *
+ * @param[in] capture Circular capture buffer, millivolts.
+ * @param[in] length Number of samples in the capture buffer.
+ * @param[in] start Index of the oldest sample.
+ * @param[in] sample_period_ns Time between two samples.
+ * @param[in] levels Reference levels, timing measurements are skipped if `low` is not below `high`.
+ * @param[out] result Measurements.
+ */
+void oscilloscope_measure(const uint16_t *capture, uint32_t length, uint32_t start, uint32_t sample_period_ns,
+                          const oscilloscope_measure_levels_t *levels, oscilloscope_measurements_t *result);
+
+/**
+ * @brief Derive the reference levels of the next capture from the minimum and maximum of this one.
+ *
+ * @param[in] result Measurements of the last capture.
+ * @param[out] levels Reference levels for the next capture.
+ */
+void oscilloscope_measure_levels(const oscilloscope_measurements_t *result, oscilloscope_measure_levels_t *levels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_MEASURE_H__
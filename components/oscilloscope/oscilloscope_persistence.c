@@ -0,0 +1,174 @@
+/**
+* @file oscilloscope_persistence.c
+*
+* @brief Intensity graded persistence: every captured sample is a hit on a pixel of the plot area, and the
+*        hits fade out over the following frames. The buffer is the pixel data of an 8 bit indexed canvas,
+*        so rare events stay visible between the frames that show the usual trace.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_persistence.h"
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define PERSISTENCE_FADE_SHORT    (192U)  // x/256 per frame
+#define PERSISTENCE_FADE_LONG     (243U)
+#define PERSISTENCE_LANES         (0x00FF00FFUL)  // Every other byte of a word, 16 bits per lane
+#define PERSISTENCE_MIN_ALPHA     (96U)   // Of the faintest hit, over the grid
+#define PERSISTENCE_SEGMENT       (64U)   // Palette entries per color ramp
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Row of a voltage, clamped to the buffer.
+ *
+ * @param[in] buffer Buffer.
+ * @param[in] voltage Voltage in millivolts.
+ *
+ * @return Row index, 0 at the top.
+ */
+static inline int32_t _persistence_row(const oscilloscope_persistence_buffer_t *buffer, uint16_t voltage);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_persistence_configure(oscilloscope_persistence_buffer_t *buffer, uint8_t *intensity,
+                                        uint32_t width, uint32_t height, int32_t min_mv, int32_t max_mv)
+{
+    buffer->intensity = intensity;
+    buffer->width = width;
+    buffer->height = height;
+    buffer->min_mv = min_mv;
+    buffer->max_mv = max_mv;
+    buffer->row_scale = ((height - 1) << 16) / (uint32_t)((max_mv > min_mv) ? (max_mv - min_mv) : 1);
+    oscilloscope_persistence_clear(buffer);
+}
+
+void oscilloscope_persistence_clear(oscilloscope_persistence_buffer_t *buffer)
+{
+    memset(buffer->intensity, 0, buffer->width * buffer->height);
+}
+
+void oscilloscope_persistence_fade(oscilloscope_persistence_buffer_t *buffer, oscilloscope_persistence_t mode)
+{
+    uint32_t factor;
+    switch(mode)
+    {
+    case OSCILLOSCOPE_PERSISTENCE_SHORT:
+        factor = PERSISTENCE_FADE_SHORT;
+        break;
+    case OSCILLOSCOPE_PERSISTENCE_LONG:
+        factor = PERSISTENCE_FADE_LONG;
+        break;
+    default:
+        return;
+    }
+
+    /* Two pixels per multiply, each in a 16 bit lane: 255 x 255 never carries into the next one. */
+    uint32_t pixels = buffer->width * buffer->height;
+    uint32_t *word = (uint32_t *)buffer->intensity;
+    for(uint32_t n = 0; n < pixels / 4; n++)
+    {
+        uint32_t even = ((word[n] & PERSISTENCE_LANES) * factor) >> 8;
+        uint32_t odd = ((word[n] >> 8) & PERSISTENCE_LANES) * factor;
+        word[n] = (even & PERSISTENCE_LANES) | (odd & ~PERSISTENCE_LANES);
+    }
+    for(uint32_t n = pixels & ~3U; n < pixels; n++)
+    {
+        buffer->intensity[n] = (uint8_t)((buffer->intensity[n] * factor) >> 8);
+    }
+}
+
+void oscilloscope_persistence_accumulate(oscilloscope_persistence_buffer_t *buffer, const uint16_t *capture,
+                                         uint32_t count, uint32_t start)
+{
+    const uint32_t width = buffer->width;
+    const uint32_t column_step = ((width - 1) << 16) / (count - 1);  // Q16 columns per sample
+    uint32_t column = 0;
+    uint32_t index = start;
+    int32_t previous = _persistence_row(buffer, capture[start]);
+
+    for(uint32_t n = 0; n < count; n++)
+    {
+        int32_t row = _persistence_row(buffer, capture[index]);
+
+        /* The sample and the pixels between it and the previous one, the previous pixel excluded. */
+        int32_t top = row;
+        int32_t bottom = row;
+        if(row > previous)
+        {
+            top = previous + 1;
+        }
+        else if(row < previous)
+        {
+            bottom = previous - 1;
+        }
+
+        uint8_t *pixel = &buffer->intensity[(uint32_t)top * width + (column >> 16)];
+        for(int32_t r = top; r <= bottom; r++)
+        {
+            uint32_t sum = *pixel + OSCILLOSCOPE_PERSISTENCE_HIT;
+            *pixel = (uint8_t)((UINT8_MAX < sum) ? UINT8_MAX : sum);
+            pixel += width;
+        }
+
+        previous = row;
+        column += column_step;
+        if(++index == count)
+        {
+            index = 0;
+        }
+    }
+}
+
+void oscilloscope_persistence_palette(lv_color32_t *palette)
+{
+    palette[0].full = 0;
+    for(uint32_t i = 1; i < OSCILLOSCOPE_PERSISTENCE_PALETTE; i++)
+    {
+        /* Blue, cyan, green, yellow, red. */
+        uint32_t ramp = (i % PERSISTENCE_SEGMENT) * 255U / (PERSISTENCE_SEGMENT - 1);
+        uint8_t red = 0, green = 0, blue = 0;
+        switch(i / PERSISTENCE_SEGMENT)
+        {
+        case 0:
+            green = (uint8_t)ramp;
+            blue = 255;
+            break;
+        case 1:
+            green = 255;
+            blue = (uint8_t)(255U - ramp);
+            break;
+        case 2:
+            red = (uint8_t)ramp;
+            green = 255;
+            break;
+        default:
+            red = 255;
+            green = (uint8_t)(255U - ramp);
+            break;
+        }
+
+        uint32_t alpha = PERSISTENCE_MIN_ALPHA + i * 4U;
+        palette[i].ch.red = red;
+        palette[i].ch.green = green;
+        palette[i].ch.blue = blue;
+        palette[i].ch.alpha = (uint8_t)((255U < alpha) ? 255U : alpha);
+    }
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static inline int32_t _persistence_row(const oscilloscope_persistence_buffer_t *buffer, uint16_t voltage)
+{
+    int32_t row = ((buffer->max_mv - (int32_t)voltage) * (int32_t)buffer->row_scale + (1 << 15)) >> 16;
+    row = (0 > row) ? 0 : row;
+    return ((int32_t)buffer->height <= row) ? ((int32_t)buffer->height - 1) : row;
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
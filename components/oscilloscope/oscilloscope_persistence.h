@@ -0,0 +1,99 @@
+/**
+* @file oscilloscope_persistence.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_PERSISTENCE_H__
+#define __OSCILLOSCOPE_PERSISTENCE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include "lvgl.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_PERSISTENCE_MAX_WIDTH  (220U)  // Chart size, the plot area is smaller
+#define OSCILLOSCOPE_PERSISTENCE_MAX_HEIGHT (130U)
+#define OSCILLOSCOPE_PERSISTENCE_PALETTE    (256U)  // Entries, the intensity is the palette index
+#define OSCILLOSCOPE_PERSISTENCE_HIT        (32U)   // Intensity added by one sample
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum{
+    OSCILLOSCOPE_PERSISTENCE_OFF,
+    OSCILLOSCOPE_PERSISTENCE_SHORT,    // Intensity x 0.75 per frame
+    OSCILLOSCOPE_PERSISTENCE_LONG,     // Intensity x 0.95 per frame
+    OSCILLOSCOPE_PERSISTENCE_INFINITE  // No fade, cleared on timebase and range changes
+} oscilloscope_persistence_t;
+
+/* Intensity per pixel of the plot area, row 0 at the top. */
+typedef struct
+{
+    uint8_t *intensity;    // width x height, 4 byte aligned
+    uint32_t width;
+    uint32_t height;
+    int32_t min_mv;        // Chart range mapped to the rows
+    int32_t max_mv;
+    uint32_t row_scale;    // Q16 rows per mV
+} oscilloscope_persistence_buffer_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Set the size and the vertical range of a buffer and clear it.
+ *
+ * @param[out] buffer Buffer to configure.
+ * @param[in] intensity Pixel memory, width x height bytes, 4 byte aligned.
+ * @param[in] width Plot area width in pixels, at least 2.
+ * @param[in] height Plot area height in pixels, at least 2.
+ * @param[in] min_mv Voltage at the bottom row.
+ * @param[in] max_mv Voltage at the top row.
+ */
+void oscilloscope_persistence_configure(oscilloscope_persistence_buffer_t *buffer, uint8_t *intensity,
+                                        uint32_t width, uint32_t height, int32_t min_mv, int32_t max_mv);
+
+/**
+ * @brief Set every pixel to zero intensity.
+ *
+ * @param[in,out] buffer Buffer.
+ */
+void oscilloscope_persistence_clear(oscilloscope_persistence_buffer_t *buffer);
+
+/**
+ * @brief Decay every pixel by the factor of the mode, once per frame. Four pixels per 32 bit word.
+ *
+ * @param[in,out] buffer Buffer.
+ * @param[in] mode Persistence mode, off and infinite leave the buffer untouched.
+ */
+void oscilloscope_persistence_fade(oscilloscope_persistence_buffer_t *buffer, oscilloscope_persistence_t mode);
+
+/**
+ * @brief Add the hits of a capture, stretched over the full width.
+ *
+ * Every sample adds OSCILLOSCOPE_PERSISTENCE_HIT to its pixel, saturating at 255, and to the pixels
+ * joining it to the previous sample in the same column, so steep edges stay connected. Integer only,
+ * with no division in the loop.
+ *
+ * @param[in,out] buffer Buffer.
+ * @param[in] capture Circular capture buffer in millivolts.
+ * @param[in] count Number of samples in the capture, at least 2.
+ * @param[in] start Index of the oldest sample.
+ */
+void oscilloscope_persistence_accumulate(oscilloscope_persistence_buffer_t *buffer, const uint16_t *capture,
+                                         uint32_t count, uint32_t start);
+
+/**
+ * @brief Fill the palette of an indexed canvas: zero intensity transparent, then blue through green
+ *        and yellow to red for the most frequent hits.
+ *
+ * @param[out] palette OSCILLOSCOPE_PERSISTENCE_PALETTE entries.
+ */
+void oscilloscope_persistence_palette(lv_color32_t *palette);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_PERSISTENCE_H__
@@ -0,0 +1,232 @@
+/**
+* @file oscilloscope_record.c
+*
+* @brief Deep-memory record of the oscilloscope. The sampler appends every kept sample to a per-channel
+*        ring much longer than a display frame; while acquisition is stopped the record can be zoomed and
+*        panned through.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_record.h"
+#include "oscilloscope_decimation.h"
+#include "esp_heap_caps.h"
+#include <stddef.h>
+
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Time held by the record, the shortest of all recorded channels.
+ *
+ * @return Time in microseconds.
+ */
+static uint32_t _record_length_us(void);
+
+/**
+ * @brief Clamp the view to the record.
+ */
+static void _record_view_clamp(void);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+#if !CONFIG_SPIRAM
+static uint16_t record_memory[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_RECORD_POINTS];
+#endif
+static uint16_t *record[OSCILLOSCOPE_CHANNEL_COUNT];
+static uint32_t record_head[OSCILLOSCOPE_CHANNEL_COUNT];    // Next write position
+static uint32_t record_count[OSCILLOSCOPE_CHANNEL_COUNT];   // Samples held, saturates at OSCILLOSCOPE_RECORD_POINTS
+static uint32_t record_period_us[OSCILLOSCOPE_CHANNEL_COUNT];
+
+/* View, touched by the GUI task only while acquisition is stopped. */
+static uint32_t view_span_us = 0;
+static uint32_t view_end_us = 0;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool oscilloscope_record_init(void)
+{
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(NULL != record[i])
+        {
+            continue;
+        }
+#if CONFIG_SPIRAM
+        record[i] = heap_caps_malloc(OSCILLOSCOPE_RECORD_POINTS * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+        if(NULL == record[i])
+        {
+            return false;
+        }
+#else
+        record[i] = record_memory[i];
+#endif
+    }
+    return true;
+}
+
+void oscilloscope_record_reset(const uint32_t sample_period_us[OSCILLOSCOPE_CHANNEL_COUNT])
+{
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        record_head[i] = 0;
+        record_count[i] = 0;
+        record_period_us[i] = sample_period_us[i];
+    }
+}
+
+void oscilloscope_record_push(oscilloscope_channel_id_t channel, uint16_t voltage)
+{
+    uint16_t *samples = record[channel];
+    if(NULL == samples)
+    {
+        return;
+    }
+
+    samples[record_head[channel]] = voltage;
+    if(OSCILLOSCOPE_RECORD_POINTS == ++record_head[channel])
+    {
+        record_head[channel] = 0;
+    }
+    if(OSCILLOSCOPE_RECORD_POINTS > record_count[channel])
+    {
+        record_count[channel]++;
+    }
+}
+
+bool oscilloscope_record_view_reset(void)
+{
+    /* One screen of the slowest channel, at the newest sample. */
+    view_span_us = 0;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if((0 != record_count[i]) && (record_period_us[i] * OSCILLOSCOPE_RECORD_COLUMNS > view_span_us))
+        {
+            view_span_us = record_period_us[i] * OSCILLOSCOPE_RECORD_COLUMNS;
+        }
+    }
+    view_end_us = 0;
+    _record_view_clamp();
+
+    return 0 != view_span_us;
+}
+
+void oscilloscope_record_zoom(oscilloscope_zoom_t zoom)
+{
+    /* Keep the center of the screen in place. */
+    uint32_t center_us = view_end_us + view_span_us / 2;
+
+    if(OSCILLOSCOPE_ZOOM_IN == zoom)
+    {
+        view_span_us /= 2;
+    }
+    else
+    {
+        view_span_us *= 2;
+    }
+
+    view_end_us = (center_us > view_span_us / 2) ? center_us - view_span_us / 2 : 0;
+    _record_view_clamp();
+}
+
+void oscilloscope_record_pan(bool newer)
+{
+    if(newer)
+    {
+        view_end_us = (view_end_us > view_span_us / 2) ? view_end_us - view_span_us / 2 : 0;
+    }
+    else
+    {
+        view_end_us += view_span_us / 2;
+    }
+    _record_view_clamp();
+}
+
+void oscilloscope_record_render(oscilloscope_record_view_t *view)
+{
+    if(NULL == view)
+    {
+        return;
+    }
+
+    view->envelope = false;
+    view->span_us = view_span_us;
+    view->end_us = view_end_us;
+    view->length_us = _record_length_us();
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        view->enabled[i] = (NULL != record[i]) && (0 != record_count[i]) && (0 != record_period_us[i]);
+        if(!view->enabled[i])
+        {
+            continue;
+        }
+
+        /* Slice of the ring on the screen, newest sample at the right edge minus the pan offset. */
+        uint32_t count = view_span_us / record_period_us[i];
+        uint32_t skip = view_end_us / record_period_us[i];
+        if(0 == count)
+        {
+            count = 1;
+        }
+        if(record_count[i] < skip + count)
+        {
+            skip = (record_count[i] > count) ? record_count[i] - count : 0;
+            count = record_count[i] - skip;
+        }
+
+        uint32_t start = (record_head[i] + OSCILLOSCOPE_RECORD_POINTS - skip - count) % OSCILLOSCOPE_RECORD_POINTS;
+        oscilloscope_minmax_reduce_range(record[i], OSCILLOSCOPE_RECORD_POINTS, start, count, view->column_min[i],
+                                         view->column_max[i], OSCILLOSCOPE_RECORD_COLUMNS);
+        view->envelope = view->envelope || (OSCILLOSCOPE_RECORD_COLUMNS < count);
+    }
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint32_t _record_length_us(void)
+{
+    uint32_t length_us = UINT32_MAX;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if((0 != record_count[i]) && (0 != record_period_us[i]) && (record_count[i] * record_period_us[i] < length_us))
+        {
+            length_us = record_count[i] * record_period_us[i];
+        }
+    }
+    return (UINT32_MAX == length_us) ? 0 : length_us;
+}
+
+static void _record_view_clamp(void)
+{
+    uint32_t length_us = _record_length_us();
+    uint32_t min_span_us = UINT32_MAX;
+
+    /* At least one sample per column of the fastest channel, at most the whole record. */
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if((0 != record_count[i]) && (0 != record_period_us[i]) &&
+           (record_period_us[i] * OSCILLOSCOPE_RECORD_COLUMNS < min_span_us))
+        {
+            min_span_us = record_period_us[i] * OSCILLOSCOPE_RECORD_COLUMNS;
+        }
+    }
+    if(min_span_us > view_span_us)
+    {
+        view_span_us = min_span_us;
+    }
+    if(length_us < view_span_us)
+    {
+        view_span_us = length_us;
+    }
+    if(view_end_us + view_span_us > length_us)
+    {
+        view_end_us = length_us - view_span_us;
+    }
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,101 @@
+/**
+* @file oscilloscope_record.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_RECORD_H__
+#define __OSCILLOSCOPE_RECORD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "oscilloscope.h"
+//---------------------------------- MACROS -----------------------------------
+#ifdef CONFIG_OSCILLOSCOPE_RECORD_POINTS
+#define OSCILLOSCOPE_RECORD_POINTS ((uint32_t)CONFIG_OSCILLOSCOPE_RECORD_POINTS)  // Per channel, see Kconfig
+#elif CONFIG_SPIRAM
+#define OSCILLOSCOPE_RECORD_POINTS (65536U)  // Per channel, in PSRAM
+#else
+#define OSCILLOSCOPE_RECORD_POINTS (4096U)   // Per channel, static in internal RAM
+#endif
+#define OSCILLOSCOPE_RECORD_COLUMNS (200U)
+//-------------------------------- DATA TYPES ---------------------------------
+/* Zoomed and panned view of the record, reduced to display columns. */
+typedef struct
+{
+    lv_coord_t column_max[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_RECORD_COLUMNS];
+    lv_coord_t column_min[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_RECORD_COLUMNS];
+    bool enabled[OSCILLOSCOPE_CHANNEL_COUNT];
+    bool envelope;        // More than one sample per column in some channel
+    uint32_t span_us;     // Time shown on the screen
+    uint32_t end_us;      // Time from the right edge of the screen to the newest sample
+    uint32_t length_us;   // Time held by the record
+} oscilloscope_record_view_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Allocate the record, in PSRAM when it is enabled.
+ *
+ * @return true if successful.
+ */
+bool oscilloscope_record_init(void);
+
+/**
+ * @brief Clear the record and set the sample period of every channel. Called by the sampler on timebase changes.
+ *
+ * @param[in] sample_period_us Sample period of every channel, 0 for channels not recorded.
+ */
+void oscilloscope_record_reset(const uint32_t sample_period_us[OSCILLOSCOPE_CHANNEL_COUNT]);
+
+/**
+ * @brief Append a kept sample of a channel, overwriting the oldest one when the record is full.
+ *        Called by the sampler.
+ *
+ * @param[in] channel Channel the sample belongs to.
+ * @param[in] voltage Sample in millivolts.
+ */
+void oscilloscope_record_push(oscilloscope_channel_id_t channel, uint16_t voltage);
+
+/**
+ * @brief Show the newest screen of the record. Called while acquisition is stopped.
+ *
+ * @return true if the record holds samples.
+ */
+bool oscilloscope_record_view_reset(void);
+
+/**
+ * @brief Halve or double the time on the screen around its center. Called while acquisition is stopped.
+ *
+ * @param[in] zoom Zoom direction.
+ */
+void oscilloscope_record_zoom(oscilloscope_zoom_t zoom);
+
+/**
+ * @brief Move the screen by half its width. Called while acquisition is stopped.
+ *
+ * @param[in] newer `true` to move towards the newest sample.
+ */
+void oscilloscope_record_pan(bool newer);
+
+/**
+ * @brief Reduce the samples on the screen to display columns, the minimum and maximum of every column.
+ *
+ * A single pass over the samples on the screen only, so zooming and panning stay interactive.
+ *
+ * @param[out] view Columns and position of the view.
+ */
+void oscilloscope_record_render(oscilloscope_record_view_t *view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_RECORD_H__
@@ -0,0 +1,253 @@
+/**
+* @file oscilloscope_screenshot.c
+*
+* @brief Compact format of oscilloscope screenshots. Neighbouring columns of a waveform differ by little, so
+*        every column is stored as the difference to the previous one, zigzag mapped and written as a
+*        little-endian base-128 varint. The lowest bit of every varint tells a difference (0) from a run of
+*        repeated columns (1), so flat parts and empty channels take a byte per up to 64 columns and most
+*        other columns a single byte instead of two.
+*
+*        Layout, little endian:
+*        magic (4) | version (1) | channel mask (1) | acquisition (1) | reserved (1) | sequence (4) |
+*        chart min mV (2) | chart max mV (2) | columns (2), then for every channel in the mask
+*        sampling rate (4) | column ns (4) | payload length (2) | payload.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_screenshot.h"
+
+//---------------------------------- MACROS -----------------------------------
+#define SCREENSHOT_MAGIC   (0x5353434FUL)  // "OCSS"
+#define SCREENSHOT_VERSION (1U)
+#define SCREENSHOT_RUN     (1U)   // Token flag, run of columns equal to the previous one
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Write a little-endian value.
+ *
+ * @param[out] buffer Output.
+ * @param[in] value Value to write.
+ * @param[in] bytes Number of bytes, 1 - 4.
+ *
+ * @return Position after the value.
+ */
+static uint8_t *_screenshot_put(uint8_t *buffer, uint32_t value, uint32_t bytes);
+
+/**
+ * @brief Read a little-endian value.
+ *
+ * @param[in] buffer Input.
+ * @param[in] bytes Number of bytes, 1 - 4.
+ *
+ * @return Value.
+ */
+static uint32_t _screenshot_get(const uint8_t *buffer, uint32_t bytes);
+
+/**
+ * @brief Write a varint.
+ *
+ * @param[out] buffer Output.
+ * @param[in] value Value to write.
+ *
+ * @return Position after the varint.
+ */
+static uint8_t *_screenshot_put_varint(uint8_t *buffer, uint32_t value);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+size_t oscilloscope_screenshot_encode(const oscilloscope_screenshot_t *screenshot, uint8_t *buffer)
+{
+    uint8_t *out = buffer;
+
+    out = _screenshot_put(out, SCREENSHOT_MAGIC, 4);
+    out = _screenshot_put(out, SCREENSHOT_VERSION, 1);
+    out = _screenshot_put(out, screenshot->channel_mask, 1);
+    out = _screenshot_put(out, screenshot->acquisition, 1);
+    out = _screenshot_put(out, 0, 1);
+    out = _screenshot_put(out, screenshot->sequence, 4);
+    out = _screenshot_put(out, (uint16_t)screenshot->chart_min_mv, 2);
+    out = _screenshot_put(out, (uint16_t)screenshot->chart_max_mv, 2);
+    out = _screenshot_put(out, OSCILLOSCOPE_SCREENSHOT_COLUMNS, 2);
+
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(0 == (screenshot->channel_mask & (1U << i)))
+        {
+            continue;
+        }
+
+        out = _screenshot_put(out, screenshot->sampling_rate[i], 4);
+        out = _screenshot_put(out, screenshot->column_ns[i], 4);
+        uint8_t *payload_length = out;
+        out += 2;
+
+        uint8_t *payload = out;
+        int32_t previous = 0;
+        uint32_t run = 0;
+        for(uint32_t c = 0; c < OSCILLOSCOPE_SCREENSHOT_COLUMNS; c++)
+        {
+            int32_t delta = (int32_t)screenshot->column[i][c] - previous;
+            previous = screenshot->column[i][c];
+            if(0 == delta)
+            {
+                run++;
+                continue;
+            }
+
+            if(0 != run)
+            {
+                out = _screenshot_put_varint(out, ((run - 1) << 1) | SCREENSHOT_RUN);
+                run = 0;
+            }
+            uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+            out = _screenshot_put_varint(out, zigzag << 1);
+        }
+        if(0 != run)
+        {
+            out = _screenshot_put_varint(out, ((run - 1) << 1) | SCREENSHOT_RUN);
+        }
+        _screenshot_put(payload_length, (uint32_t)(out - payload), 2);
+    }
+
+    return (size_t)(out - buffer);
+}
+
+bool oscilloscope_screenshot_decode(const uint8_t *buffer, size_t length, oscilloscope_screenshot_t *screenshot)
+{
+    if(!oscilloscope_screenshot_sequence(buffer, length, &screenshot->sequence) ||
+       (OSCILLOSCOPE_SCREENSHOT_COLUMNS != _screenshot_get(&buffer[16], 2)))
+    {
+        return false;
+    }
+
+    screenshot->channel_mask = buffer[5];
+    screenshot->acquisition = buffer[6];
+    screenshot->chart_min_mv = (lv_coord_t)(int16_t)_screenshot_get(&buffer[12], 2);
+    screenshot->chart_max_mv = (lv_coord_t)(int16_t)_screenshot_get(&buffer[14], 2);
+
+    const uint8_t *in = &buffer[OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE];
+    const uint8_t *end = &buffer[length];
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        if(0 == (screenshot->channel_mask & (1U << i)))
+        {
+            screenshot->sampling_rate[i] = 0;
+            screenshot->column_ns[i] = 0;
+            for(uint32_t c = 0; c < OSCILLOSCOPE_SCREENSHOT_COLUMNS; c++)
+            {
+                screenshot->column[i][c] = LV_CHART_POINT_NONE;
+            }
+            continue;
+        }
+
+        if(10 > end - in)
+        {
+            return false;
+        }
+        screenshot->sampling_rate[i] = _screenshot_get(in, 4);
+        screenshot->column_ns[i] = _screenshot_get(&in[4], 4);
+        uint32_t payload_length = _screenshot_get(&in[8], 2);
+        in += 10;
+        if(payload_length > (uint32_t)(end - in))
+        {
+            return false;
+        }
+
+        const uint8_t *payload_end = in + payload_length;
+        int32_t previous = 0;
+        uint32_t c = 0;
+        while(c < OSCILLOSCOPE_SCREENSHOT_COLUMNS)
+        {
+            uint32_t token = 0;
+            uint32_t shift = 0;
+            do
+            {
+                if((in == payload_end) || (21U < shift))
+                {
+                    return false;
+                }
+                token |= (uint32_t)(*in & 0x7FU) << shift;
+                shift += 7;
+            } while(0 != (*in++ & 0x80U));
+
+            uint32_t count = 1;
+            if(0 != (token & SCREENSHOT_RUN))
+            {
+                count = (token >> 1) + 1;
+                if(count > OSCILLOSCOPE_SCREENSHOT_COLUMNS - c)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                uint32_t zigzag = token >> 1;
+                previous += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1U);
+            }
+
+            for(; 0 != count; count--)
+            {
+                screenshot->column[i][c++] = (lv_coord_t)previous;
+            }
+        }
+        if(in != payload_end)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool oscilloscope_screenshot_sequence(const uint8_t *buffer, size_t length, uint32_t *sequence)
+{
+    if((OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE > length) || (SCREENSHOT_MAGIC != _screenshot_get(buffer, 4)) ||
+       (SCREENSHOT_VERSION != buffer[4]))
+    {
+        return false;
+    }
+
+    *sequence = _screenshot_get(&buffer[8], 4);
+    return true;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint8_t *_screenshot_put(uint8_t *buffer, uint32_t value, uint32_t bytes)
+{
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+    return &buffer[bytes];
+}
+
+static uint32_t _screenshot_get(const uint8_t *buffer, uint32_t bytes)
+{
+    uint32_t value = 0;
+    for(uint32_t i = 0; i < bytes; i++)
+    {
+        value |= (uint32_t)buffer[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint8_t *_screenshot_put_varint(uint8_t *buffer, uint32_t value)
+{
+    while(0x80U <= value)
+    {
+        *buffer++ = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    *buffer++ = (uint8_t)value;
+    return buffer;
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
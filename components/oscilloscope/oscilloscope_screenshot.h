@@ -0,0 +1,79 @@
+/**
+* @file oscilloscope_screenshot.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_SCREENSHOT_H__
+#define __OSCILLOSCOPE_SCREENSHOT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "oscilloscope.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_SCREENSHOT_COLUMNS (200U)  // Display columns of every channel
+
+/* Fixed header, then per stored channel 10 bytes of metadata and at most 3 bytes per column. */
+#define OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE  (18U)
+#define OSCILLOSCOPE_SCREENSHOT_CHANNEL_SIZE (10U + 3U * OSCILLOSCOPE_SCREENSHOT_COLUMNS)
+#define OSCILLOSCOPE_SCREENSHOT_ENCODED_MAX  (OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE + \
+                                              OSCILLOSCOPE_CHANNEL_COUNT * OSCILLOSCOPE_SCREENSHOT_CHANNEL_SIZE)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    uint32_t sequence;                 // Increases with every saved screenshot
+    uint8_t channel_mask;              // Bit per stored channel
+    uint8_t acquisition;               // oscilloscope_acquisition_t at the time of the screenshot
+    lv_coord_t chart_min_mv;           // Vertical range of the chart
+    lv_coord_t chart_max_mv;
+    uint32_t sampling_rate[OSCILLOSCOPE_CHANNEL_COUNT]; // Timebase, us per column setting
+    uint32_t column_ns[OSCILLOSCOPE_CHANNEL_COUNT];     // Time covered by one column
+    lv_coord_t column[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_SCREENSHOT_COLUMNS]; // mV, LV_CHART_POINT_NONE if empty
+} oscilloscope_screenshot_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Compress a screenshot. Columns of every stored channel are written as zigzag varint deltas.
+ *
+ * @param[in] screenshot Screenshot to compress.
+ * @param[out] buffer Output, at least OSCILLOSCOPE_SCREENSHOT_ENCODED_MAX bytes.
+ *
+ * @return Number of bytes written.
+ */
+size_t oscilloscope_screenshot_encode(const oscilloscope_screenshot_t *screenshot, uint8_t *buffer);
+
+/**
+ * @brief Decompress a screenshot. Channels that are not stored are filled with LV_CHART_POINT_NONE.
+ *
+ * @param[in] buffer Compressed screenshot.
+ * @param[in] length Number of bytes in the buffer.
+ * @param[out] screenshot Decompressed screenshot.
+ *
+ * @return true if the buffer holds a complete screenshot of this format.
+ */
+bool oscilloscope_screenshot_decode(const uint8_t *buffer, size_t length, oscilloscope_screenshot_t *screenshot);
+
+/**
+ * @brief Read only the sequence number of a compressed screenshot.
+ *
+ * @param[in] buffer Compressed screenshot, at least OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE bytes.
+ * @param[in] length Number of bytes in the buffer.
+ * @param[out] sequence Sequence number.
+ *
+ * @return true if the header is valid.
+ */
+bool oscilloscope_screenshot_sequence(const uint8_t *buffer, size_t length, uint32_t *sequence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_SCREENSHOT_H__
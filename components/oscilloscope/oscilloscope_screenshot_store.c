@@ -0,0 +1,351 @@
+/**
+* @file oscilloscope_screenshot_store.c
+*
+* @brief Screenshots kept in a ring of files on the SPIFFS "storage" partition. Compression and flash access
+*        run in a task on the core the GUI does not use; the GUI only hands over and picks up copies.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_screenshot_store.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "storage.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdio.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define STORE_TASK_CORE       (0)    // GUI task runs on core 1
+#define STORE_TASK_PRIORITY   (3U)
+#define STORE_TASK_STACK      (4 * 1024)
+
+#define STORE_PATH_LENGTH     (24U)
+
+#define STORE_NOTIFY_SAVE     (1U << 0)
+#define STORE_NOTIFY_LOAD     (1U << 1)
+
+#define TAG "OSCILLOSCOPE STORE"
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Task mounting the filesystem, then serving save and load requests.
+ *
+ * @param[in] pvParameters Unused parameter for task creation.
+ */
+static void _store_task(void *pvParameters);
+
+/**
+ * @brief Mount the partition and read the sequence number of every slot.
+ *
+ * @return true if the filesystem is mounted.
+ */
+static bool _store_mount(void);
+
+/**
+ * @brief Compress the pending screenshot and write it over the oldest slot.
+ */
+static void _store_save(void);
+
+/**
+ * @brief Read and decompress the requested screenshot.
+ *
+ * @return true if successful.
+ */
+static bool _store_load(void);
+
+/**
+ * @brief Slot holding a screenshot of a given age.
+ *
+ * @param[in] age 0 for the newest screenshot.
+ *
+ * @return Slot index, OSCILLOSCOPE_SCREENSHOT_SLOTS if there is no such screenshot.
+ */
+static uint32_t _store_slot_by_age(uint32_t age);
+
+/**
+ * @brief File name of a slot.
+ *
+ * @param[out] path Buffer of STORE_PATH_LENGTH characters.
+ * @param[in] slot Slot index.
+ */
+static void _store_path(char *path, uint32_t slot);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static TaskHandle_t store_task_handle = NULL;
+static volatile bool store_mounted = false;
+static volatile bool save_busy = false;
+static volatile bool load_busy = false;
+static volatile bool load_ready = false;
+static volatile uint32_t stored_count = 0;
+static uint32_t load_age = 0;
+
+/* Touched by the task only once mounted. */
+static uint32_t slot_sequence[OSCILLOSCOPE_SCREENSHOT_SLOTS];  // 0 for an empty slot
+static uint32_t last_sequence = 0;
+static uint8_t encoded[OSCILLOSCOPE_SCREENSHOT_ENCODED_MAX];
+
+/* Written by the GUI while the task is idle, read by the task while busy and the other way round. */
+static oscilloscope_screenshot_t save_buffer;
+static oscilloscope_screenshot_t load_buffer;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool oscilloscope_screenshot_store_init(void)
+{
+    if(NULL != store_task_handle)
+    {
+        return true;
+    }
+
+    if(pdPASS != xTaskCreatePinnedToCore(_store_task, "Screenshot store", STORE_TASK_STACK, NULL,
+                                         STORE_TASK_PRIORITY, &store_task_handle, STORE_TASK_CORE))
+    {
+        store_task_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool oscilloscope_screenshot_store_save(const oscilloscope_screenshot_t *screenshot)
+{
+    if(!store_mounted || save_busy)
+    {
+        return false;
+    }
+
+    save_buffer = *screenshot;
+    save_busy = true;
+    xTaskNotify(store_task_handle, STORE_NOTIFY_SAVE, eSetBits);
+    return true;
+}
+
+bool oscilloscope_screenshot_store_load(uint32_t age)
+{
+    if(!store_mounted || load_busy || (age >= stored_count))
+    {
+        return false;
+    }
+
+    load_age = age;
+    load_ready = false;
+    load_busy = true;
+    xTaskNotify(store_task_handle, STORE_NOTIFY_LOAD, eSetBits);
+    return true;
+}
+
+bool oscilloscope_screenshot_store_loading(void)
+{
+    return load_busy;
+}
+
+bool oscilloscope_screenshot_store_acquire(const oscilloscope_screenshot_t **screenshot)
+{
+    if(!load_ready)
+    {
+        return false;
+    }
+
+    load_ready = false;
+    *screenshot = &load_buffer;
+    return true;
+}
+
+uint32_t oscilloscope_screenshot_store_count(void)
+{
+    return stored_count;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _store_task(void *pvParameters)
+{
+    if(!_store_mount())
+    {
+        store_task_handle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    store_mounted = true;
+
+    for(;;)
+    {
+        uint32_t requests = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &requests, portMAX_DELAY);
+
+        if(0 != (requests & STORE_NOTIFY_SAVE))
+        {
+            _store_save();
+            save_busy = false;
+        }
+        if(0 != (requests & STORE_NOTIFY_LOAD))
+        {
+            load_ready = _store_load();
+            load_busy = false;
+        }
+    }
+}
+
+static bool _store_mount(void)
+{
+    /* Shared with the arbitrary waveforms of the waveform generator. */
+    if(!storage_mount())
+    {
+        return false;
+    }
+
+    uint32_t count = 0;
+    for(uint32_t slot = 0; slot < OSCILLOSCOPE_SCREENSHOT_SLOTS; slot++)
+    {
+        char path[STORE_PATH_LENGTH];
+        _store_path(path, slot);
+        slot_sequence[slot] = 0;
+
+        FILE *file = fopen(path, "rb");
+        if(NULL == file)
+        {
+            continue;
+        }
+
+        uint32_t sequence = 0;
+        size_t length = fread(encoded, 1, OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE, file);
+        fclose(file);
+        if(oscilloscope_screenshot_sequence(encoded, length, &sequence) && (0 != sequence))
+        {
+            slot_sequence[slot] = sequence;
+            count++;
+            if(sequence > last_sequence)
+            {
+                last_sequence = sequence;
+            }
+        }
+    }
+
+    stored_count = count;
+    ESP_LOGI(TAG, "%u screenshots stored", (unsigned)count);
+    return true;
+}
+
+static void _store_save(void)
+{
+    /* Empty slots first, then the oldest screenshot. */
+    uint32_t slot = 0;
+    for(uint32_t i = 1; i < OSCILLOSCOPE_SCREENSHOT_SLOTS; i++)
+    {
+        if(slot_sequence[i] < slot_sequence[slot])
+        {
+            slot = i;
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    save_buffer.sequence = last_sequence + 1;
+    size_t length = oscilloscope_screenshot_encode(&save_buffer, encoded);
+    int64_t encoded_us = esp_timer_get_time();
+
+    char path[STORE_PATH_LENGTH];
+    _store_path(path, slot);
+    FILE *file = fopen(path, "wb");
+    if(NULL == file)
+    {
+        ESP_LOGE(TAG, "Opening %s failed", path);
+        return;
+    }
+    size_t written = fwrite(encoded, 1, length, file);
+    fclose(file);
+
+    if(written != length)
+    {
+        /* Partial file fails to decode, the slot counts as empty. */
+        ESP_LOGE(TAG, "Writing %s failed", path);
+        if(0 != slot_sequence[slot])
+        {
+            stored_count--;
+        }
+        slot_sequence[slot] = 0;
+        return;
+    }
+
+    if(0 == slot_sequence[slot])
+    {
+        stored_count++;
+    }
+    slot_sequence[slot] = save_buffer.sequence;
+    last_sequence = save_buffer.sequence;
+
+    ESP_LOGI(TAG, "Screenshot %u saved to slot %u: %u bytes, encode %d us, write %d us",
+             (unsigned)last_sequence, (unsigned)slot, (unsigned)length, (int)(encoded_us - start_us),
+             (int)(esp_timer_get_time() - encoded_us));
+}
+
+static bool _store_load(void)
+{
+    uint32_t slot = _store_slot_by_age(load_age);
+    if(OSCILLOSCOPE_SCREENSHOT_SLOTS == slot)
+    {
+        return false;
+    }
+
+    char path[STORE_PATH_LENGTH];
+    _store_path(path, slot);
+    FILE *file = fopen(path, "rb");
+    if(NULL == file)
+    {
+        ESP_LOGE(TAG, "Opening %s failed", path);
+        return false;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    size_t length = fread(encoded, 1, sizeof(encoded), file);
+    fclose(file);
+    int64_t read_us = esp_timer_get_time();
+
+    if(!oscilloscope_screenshot_decode(encoded, length, &load_buffer))
+    {
+        ESP_LOGE(TAG, "%s is corrupted", path);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Screenshot %u loaded from slot %u: read %d us, decode %d us", (unsigned)load_buffer.sequence,
+             (unsigned)slot, (int)(read_us - start_us), (int)(esp_timer_get_time() - read_us));
+    return true;
+}
+
+static uint32_t _store_slot_by_age(uint32_t age)
+{
+    uint32_t slot = OSCILLOSCOPE_SCREENSHOT_SLOTS;
+    uint32_t newer = UINT32_MAX;
+
+    for(uint32_t n = 0; n <= age; n++)
+    {
+        /* Newest screenshot older than the previous pick. */
+        slot = OSCILLOSCOPE_SCREENSHOT_SLOTS;
+        for(uint32_t i = 0; i < OSCILLOSCOPE_SCREENSHOT_SLOTS; i++)
+        {
+            if((0 != slot_sequence[i]) && (slot_sequence[i] < newer) &&
+               ((OSCILLOSCOPE_SCREENSHOT_SLOTS == slot) || (slot_sequence[i] > slot_sequence[slot])))
+            {
+                slot = i;
+            }
+        }
+
+        if(OSCILLOSCOPE_SCREENSHOT_SLOTS == slot)
+        {
+            break;
+        }
+        newer = slot_sequence[slot];
+    }
+
+    return slot;
+}
+
+static void _store_path(char *path, uint32_t slot)
+{
+    snprintf(path, STORE_PATH_LENGTH, STORAGE_BASE_PATH "/shot%02u.bin", (unsigned)slot);
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
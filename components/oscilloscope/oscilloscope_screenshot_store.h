@@ -0,0 +1,82 @@
+/**
+* @file oscilloscope_screenshot_store.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_SCREENSHOT_STORE_H__
+#define __OSCILLOSCOPE_SCREENSHOT_STORE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "oscilloscope_screenshot.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_SCREENSHOT_SLOTS (16U)  // Oldest screenshot is overwritten when all are used
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Start the store task. The filesystem is mounted and the slots are scanned by the task, so this
+ *        returns immediately even when the partition has to be formatted first.
+ *
+ * @return true if successful.
+ */
+bool oscilloscope_screenshot_store_init(void);
+
+/**
+ * @brief Queue a screenshot to be compressed and written to the next slot. Never blocks.
+ *
+ * The screenshot is copied, its sequence number is assigned by the store.
+ *
+ * @param[in] screenshot Screenshot to save.
+ *
+ * @return true if taken, false if the store is not mounted yet or still writing the previous screenshot.
+ */
+bool oscilloscope_screenshot_store_save(const oscilloscope_screenshot_t *screenshot);
+
+/**
+ * @brief Queue reading a stored screenshot. Never blocks, the result is taken with
+ *        oscilloscope_screenshot_store_acquire().
+ *
+ * @param[in] age 0 for the newest screenshot, 1 for the one before it and so on.
+ *
+ * @return true if taken, false if there is no such screenshot or a load is in progress.
+ */
+bool oscilloscope_screenshot_store_load(uint32_t age);
+
+/**
+ * @brief Check if a load is still in progress.
+ *
+ * @return true until the requested screenshot is read or the read failed.
+ */
+bool oscilloscope_screenshot_store_loading(void);
+
+/**
+ * @brief Take the loaded screenshot, if any.
+ *
+ * @param[out] screenshot Loaded screenshot, valid until the next load is requested.
+ *
+ * @return true if a new screenshot was loaded.
+ */
+bool oscilloscope_screenshot_store_acquire(const oscilloscope_screenshot_t **screenshot);
+
+/**
+ * @brief Number of stored screenshots.
+ *
+ * @return Number of used slots.
+ */
+uint32_t oscilloscope_screenshot_store_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_SCREENSHOT_STORE_H__
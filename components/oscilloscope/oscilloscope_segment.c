@@ -0,0 +1,106 @@
+/**
+* @file oscilloscope_segment.c
+*
+* @brief Segmented memory: a sequence of short triggered captures, each with its own trigger time. The
+*        sampler copies every complete capture into the next segment and re-arms at once, so bursts of
+*        events close to each other are all kept. The segments are browsed once the sequence is complete.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_segment.h"
+#include "esp_heap_caps.h"
+#include <stddef.h>
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define SEGMENT_SIZE (OSCILLOSCOPE_CHANNEL_COUNT * OSCILLOSCOPE_SEGMENT_POINTS)  // Samples of one segment
+#if CONFIG_SPIRAM
+#define SEGMENT_MEMORY_CAPS (MALLOC_CAP_SPIRAM)
+#else
+#define SEGMENT_MEMORY_CAPS (MALLOC_CAP_8BIT)
+#endif
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint16_t *volatile segments = NULL;
+static int64_t segment_timestamp_us[OSCILLOSCOPE_SEGMENT_MAX];
+static bool segment_captured[OSCILLOSCOPE_SEGMENT_MAX][OSCILLOSCOPE_CHANNEL_COUNT];
+static uint32_t segment_target = 0;
+static uint32_t segment_stored = 0;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool oscilloscope_segment_init(void)
+{
+    if(NULL != segments)
+    {
+        return true;
+    }
+    segments = heap_caps_malloc(OSCILLOSCOPE_SEGMENT_MAX * SEGMENT_SIZE * sizeof(uint16_t), SEGMENT_MEMORY_CAPS);
+    return NULL != segments;
+}
+
+void oscilloscope_segment_reset(uint32_t count)
+{
+    segment_target = (OSCILLOSCOPE_SEGMENT_MAX < count) ? OSCILLOSCOPE_SEGMENT_MAX : count;
+    segment_stored = 0;
+}
+
+bool oscilloscope_segment_store(const uint16_t *const capture[OSCILLOSCOPE_CHANNEL_COUNT],
+                                const uint32_t start[OSCILLOSCOPE_CHANNEL_COUNT], int64_t timestamp_us)
+{
+    if((NULL == segments) || (segment_stored >= segment_target))
+    {
+        return true;
+    }
+
+    /* Unrolled, oldest sample first: two copies per channel. */
+    uint16_t *segment = &segments[segment_stored * SEGMENT_SIZE];
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        segment_captured[segment_stored][i] = (NULL != capture[i]);
+        if(NULL == capture[i])
+        {
+            continue;
+        }
+
+        uint32_t older = OSCILLOSCOPE_SEGMENT_POINTS - start[i];
+        uint16_t *data = &segment[i * OSCILLOSCOPE_SEGMENT_POINTS];
+        memcpy(data, &capture[i][start[i]], older * sizeof(uint16_t));
+        memcpy(&data[older], capture[i], start[i] * sizeof(uint16_t));
+    }
+
+    segment_timestamp_us[segment_stored] = timestamp_us;
+    segment_stored++;
+    return segment_stored >= segment_target;
+}
+
+uint32_t oscilloscope_segment_count(void)
+{
+    return segment_stored;
+}
+
+const uint16_t *oscilloscope_segment_data(uint32_t segment, oscilloscope_channel_id_t channel)
+{
+    if((segment >= segment_stored) || (OSCILLOSCOPE_CHANNEL_COUNT <= channel) || !segment_captured[segment][channel])
+    {
+        return NULL;
+    }
+    return &segments[segment * SEGMENT_SIZE + channel * OSCILLOSCOPE_SEGMENT_POINTS];
+}
+
+int64_t oscilloscope_segment_timestamp_us(uint32_t segment)
+{
+    return (segment < segment_stored) ? segment_timestamp_us[segment] : 0;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,93 @@
+/**
+* @file oscilloscope_segment.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_SEGMENT_H__
+#define __OSCILLOSCOPE_SEGMENT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "oscilloscope.h"
+//---------------------------------- MACROS -----------------------------------
+#ifdef CONFIG_OSCILLOSCOPE_SEGMENT_MAX
+#define OSCILLOSCOPE_SEGMENT_MAX    ((uint32_t)CONFIG_OSCILLOSCOPE_SEGMENT_MAX)  // See Kconfig
+#elif CONFIG_SPIRAM
+#define OSCILLOSCOPE_SEGMENT_MAX    (256U)  // In PSRAM
+#else
+#define OSCILLOSCOPE_SEGMENT_MAX    (16U)   // In internal RAM
+#endif
+#define OSCILLOSCOPE_SEGMENT_POINTS (200U)  // Per channel and segment, one per display column
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Allocate the segment memory, in PSRAM when it is enabled. Called the first time a sequence is
+ *        requested, the memory is kept from then on since the sampler may be storing into it.
+ *
+ * @return true if successful.
+ */
+bool oscilloscope_segment_init(void);
+
+/**
+ * @brief Drop the stored segments and start a sequence. Called by the sampler.
+ *
+ * @param[in] count Segments in the sequence, 2 - OSCILLOSCOPE_SEGMENT_MAX.
+ */
+void oscilloscope_segment_reset(uint32_t count);
+
+/**
+ * @brief Copy a complete capture of every channel into the next segment. Called by the sampler right
+ *        before it re-arms the trigger, so it only copies.
+ *
+ * @param[in] capture Circular capture buffer of every channel of OSCILLOSCOPE_SEGMENT_POINTS samples, NULL
+ *                    for channels not captured.
+ * @param[in] start Index of the oldest sample of every channel.
+ * @param[in] timestamp_us Time of the trigger sample.
+ *
+ * @return true if the sequence is complete.
+ */
+bool oscilloscope_segment_store(const uint16_t *const capture[OSCILLOSCOPE_CHANNEL_COUNT],
+                                const uint32_t start[OSCILLOSCOPE_CHANNEL_COUNT], int64_t timestamp_us);
+
+/**
+ * @brief Number of segments stored in the current sequence.
+ *
+ * @return Segments stored.
+ */
+uint32_t oscilloscope_segment_count(void);
+
+/**
+ * @brief Samples of one channel of a segment, oldest first. Read while acquisition is stopped.
+ *
+ * @param[in] segment Segment index, 0 for the first one of the sequence.
+ * @param[in] channel Channel.
+ *
+ * @return OSCILLOSCOPE_SEGMENT_POINTS samples in millivolts, NULL if the channel was not captured.
+ */
+const uint16_t *oscilloscope_segment_data(uint32_t segment, oscilloscope_channel_id_t channel);
+
+/**
+ * @brief Trigger time of a segment.
+ *
+ * @param[in] segment Segment index.
+ *
+ * @return Time of the trigger sample in microseconds.
+ */
+int64_t oscilloscope_segment_timestamp_us(uint32_t segment);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_SEGMENT_H__
@@ -0,0 +1,192 @@
+/**
+* @file oscilloscope_spectrum.c
+*
+* @brief Spectrum view of the oscilloscope. Captures from the sampler are transformed by a task pinned to
+*        the core the GUI does not run on, and complete spectra are handed to the renderer through a
+*        triple buffer.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_spectrum.h"
+#include "oscilloscope_triple_buffer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define SPECTRUM_TASK_CORE      (0)    // GUI task runs on core 1
+#define SPECTRUM_TASK_PRIORITY  (4U)
+#define SPECTRUM_TASK_STACK     (3 * 1024)
+#define SPECTRUM_LOG_PERIOD     (100U) // Log the transform time every 100 spectra
+
+#define TAG "OSCILLOSCOPE SPECTRUM"
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Task transforming the submitted captures and publishing the spectra.
+ *
+ * @param[in] pvParameters Unused parameter for task creation.
+ */
+static void _oscilloscope_spectrum_task(void *pvParameters);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static TaskHandle_t spectrum_task_handle = NULL;
+static volatile bool spectrum_busy = false;
+static volatile oscilloscope_fft_window_t spectrum_window = OSCILLOSCOPE_FFT_WINDOW_HANN;
+static volatile uint32_t spectrum_points = OSCILLOSCOPE_SPECTRUM_MAX_POINTS;
+
+/* Written by the sampler while the task is idle, read by the task while busy. */
+static uint16_t spectrum_input[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_SPECTRUM_MAX_POINTS];
+static uint32_t spectrum_input_points = OSCILLOSCOPE_SPECTRUM_MAX_POINTS;
+static bool spectrum_input_enabled[OSCILLOSCOPE_CHANNEL_COUNT];
+static uint32_t spectrum_input_period_us[OSCILLOSCOPE_CHANNEL_COUNT];
+
+static oscilloscope_spectrum_t spectra[OSCILLOSCOPE_TRIPLE_BUFFER_SLOTS];
+static oscilloscope_triple_buffer_t spectrum_buffer;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool oscilloscope_spectrum_init(void)
+{
+    if(NULL != spectrum_task_handle)
+    {
+        return true;
+    }
+
+    oscilloscope_fft_init();
+    oscilloscope_triple_buffer_init(&spectrum_buffer);
+
+    if(pdPASS != xTaskCreatePinnedToCore(_oscilloscope_spectrum_task, "Oscilloscope FFT", SPECTRUM_TASK_STACK, NULL,
+                                         SPECTRUM_TASK_PRIORITY, &spectrum_task_handle, SPECTRUM_TASK_CORE))
+    {
+        spectrum_task_handle = NULL;
+        return false;
+    }
+    return true;
+}
+
+void oscilloscope_spectrum_window_set(oscilloscope_fft_window_t window)
+{
+    spectrum_window = window;
+}
+
+bool oscilloscope_spectrum_points_set(uint32_t points)
+{
+    if((OSCILLOSCOPE_SPECTRUM_MIN_POINTS > points) || (OSCILLOSCOPE_SPECTRUM_MAX_POINTS < points) ||
+       (0 != (points & (points - 1))))
+    {
+        return false;
+    }
+
+    spectrum_points = points;
+    return true;
+}
+
+uint32_t oscilloscope_spectrum_points_get(void)
+{
+    return spectrum_points;
+}
+
+bool oscilloscope_spectrum_submit(const uint16_t *const capture[OSCILLOSCOPE_CHANNEL_COUNT],
+                                  const uint32_t start[OSCILLOSCOPE_CHANNEL_COUNT], uint32_t length,
+                                  const uint32_t sample_period_us[OSCILLOSCOPE_CHANNEL_COUNT])
+{
+    uint32_t points = spectrum_points;
+    if((NULL == spectrum_task_handle) || spectrum_busy || (points > length))
+    {
+        return false;
+    }
+
+    /* Newest samples of the transform size, oldest first. */
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        spectrum_input_enabled[i] = (NULL != capture[i]);
+        if(!spectrum_input_enabled[i])
+        {
+            continue;
+        }
+
+        uint32_t read = (start[i] + length - points) % length;
+        uint32_t first = length - read;
+        if(first > points)
+        {
+            first = points;
+        }
+        memcpy(spectrum_input[i], &capture[i][read], first * sizeof(uint16_t));
+        memcpy(&spectrum_input[i][first], capture[i], (points - first) * sizeof(uint16_t));
+        spectrum_input_period_us[i] = sample_period_us[i];
+    }
+
+    spectrum_input_points = points;
+    spectrum_busy = true;
+    xTaskNotifyGive(spectrum_task_handle);
+    return true;
+}
+
+bool oscilloscope_spectrum_acquire(const oscilloscope_spectrum_t **spectrum)
+{
+    if(!oscilloscope_triple_buffer_acquire(&spectrum_buffer))
+    {
+        return false;
+    }
+
+    *spectrum = &spectra[oscilloscope_triple_buffer_front(&spectrum_buffer)];
+    return true;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _oscilloscope_spectrum_task(void *pvParameters)
+{
+    uint32_t transforms = 0;
+    int64_t transform_time_us = 0;
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        oscilloscope_fft_configure(spectrum_window, spectrum_input_points);
+        oscilloscope_spectrum_t *spectrum = &spectra[oscilloscope_triple_buffer_back(&spectrum_buffer)];
+
+        for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+        {
+            spectrum->enabled[i] = spectrum_input_enabled[i];
+            if(!spectrum->enabled[i])
+            {
+                continue;
+            }
+
+            int64_t start_us = esp_timer_get_time();
+            uint32_t peak_bin = oscilloscope_fft_spectrum(spectrum_input[i], spectrum->column_db[i],
+                                                          OSCILLOSCOPE_SPECTRUM_COLUMNS);
+            transform_time_us += esp_timer_get_time() - start_us;
+            transforms++;
+
+            /* Bin spacing is the sample rate divided by the transform size. */
+            uint64_t sample_rate_mhz = 1000000000ULL / spectrum_input_period_us[i];
+            spectrum->peak_frequency_hz[i] = (uint32_t)((peak_bin * sample_rate_mhz) /
+                                                        (spectrum_input_points * 1000ULL));
+            spectrum->span_hz[i] = (uint32_t)(sample_rate_mhz / 2000U);
+        }
+
+        spectrum_busy = false;
+        oscilloscope_triple_buffer_publish(&spectrum_buffer);
+
+        if(SPECTRUM_LOG_PERIOD <= transforms)
+        {
+            ESP_LOGI(TAG, "%u point FFT: %d us", (unsigned)spectrum_input_points,
+                     (int)(transform_time_us / transforms));
+            transforms = 0;
+            transform_time_us = 0;
+        }
+    }
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,95 @@
+/**
+* @file oscilloscope_spectrum.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_SPECTRUM_H__
+#define __OSCILLOSCOPE_SPECTRUM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "oscilloscope.h"
+#include "oscilloscope_fft.h"
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_SPECTRUM_MAX_POINTS (OSCILLOSCOPE_FFT_MAX_POINTS)  // Largest transform, sizes the captures
+#define OSCILLOSCOPE_SPECTRUM_MIN_POINTS (256U)
+#define OSCILLOSCOPE_SPECTRUM_COLUMNS (200U)                         // Display columns
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    lv_coord_t column_db[OSCILLOSCOPE_CHANNEL_COUNT][OSCILLOSCOPE_SPECTRUM_COLUMNS]; // 0.1 dBFS
+    bool enabled[OSCILLOSCOPE_CHANNEL_COUNT];
+    uint32_t peak_frequency_hz[OSCILLOSCOPE_CHANNEL_COUNT];
+    uint32_t span_hz[OSCILLOSCOPE_CHANNEL_COUNT];                                     // Half the sample rate
+} oscilloscope_spectrum_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Build the FFT tables and start the spectrum task on the core not used by the GUI.
+ *
+ * @return true if successful.
+ */
+bool oscilloscope_spectrum_init(void);
+
+/**
+ * @brief Select the FFT window, applied from the next transform.
+ *
+ * @param[in] window Window type.
+ */
+void oscilloscope_spectrum_window_set(oscilloscope_fft_window_t window);
+
+/**
+ * @brief Select the transform size, applied from the next submitted capture. The largest size by default.
+ *
+ * @param[in] points Power of 2 between OSCILLOSCOPE_SPECTRUM_MIN_POINTS and OSCILLOSCOPE_SPECTRUM_MAX_POINTS.
+ *
+ * @return true if the size is valid.
+ */
+bool oscilloscope_spectrum_points_set(uint32_t points);
+
+/**
+ * @brief Get the transform size, which is also the number of samples the sampler has to capture.
+ *
+ * @return Samples per transform.
+ */
+uint32_t oscilloscope_spectrum_points_get(void);
+
+/**
+ * @brief Hand complete captures to the spectrum task. Called by the sampler, never blocks.
+ *
+ * The captures are copied, oldest sample first, only if the previous transform is finished. Otherwise the
+ * frame is skipped, so the sampler never waits for the FFT.
+ *
+ * @param[in] capture Circular capture buffer of every channel, `NULL` for channels not to transform.
+ * @param[in] start Index of the oldest sample of every channel.
+ * @param[in] length Length of the capture buffers, at least the transform size.
+ * @param[in] sample_period_us Sample period of every channel.
+ *
+ * @return true if the captures were taken.
+ */
+bool oscilloscope_spectrum_submit(const uint16_t *const capture[OSCILLOSCOPE_CHANNEL_COUNT],
+                                  const uint32_t start[OSCILLOSCOPE_CHANNEL_COUNT], uint32_t length,
+                                  const uint32_t sample_period_us[OSCILLOSCOPE_CHANNEL_COUNT]);
+
+/**
+ * @brief Take the newest spectrum, if any. Called by the renderer only.
+ *
+ * @param[out] spectrum Newest spectrum, valid until the next successful call.
+ *
+ * @return true if a new spectrum was taken.
+ */
+bool oscilloscope_spectrum_acquire(const oscilloscope_spectrum_t **spectrum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_SPECTRUM_H__
@@ -0,0 +1,65 @@
+/**
+* @file oscilloscope_trigger.c
+*
+* @brief Trigger comparator of the oscilloscope. Edge triggers use a hysteresis band around the level
+*        so noise on a slow edge does not trigger more than once.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_trigger.h"
+#include <stddef.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_TRIGGER_MAX_LEVEL (UINT16_MAX)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_trigger_configure(oscilloscope_trigger_t *trigger, oscilloscope_trigger_type_t type,
+                                    uint16_t level, uint16_t hysteresis)
+{
+    if(NULL == trigger)
+    {
+        return;
+    }
+
+    trigger->type = type;
+    trigger->level = level;
+
+    switch(type)
+    {
+    case OSCILLOSCOPE_TRIGGER_RISING:
+        trigger->rearm_level = (level > hysteresis) ? level - hysteresis : 0;
+        break;
+    case OSCILLOSCOPE_TRIGGER_FALLING:
+        trigger->rearm_level = (OSCILLOSCOPE_TRIGGER_MAX_LEVEL - level > hysteresis) ? level + hysteresis :
+                                                                                      OSCILLOSCOPE_TRIGGER_MAX_LEVEL;
+        break;
+    default:
+        trigger->rearm_level = level;
+        break;
+    }
+
+    oscilloscope_trigger_reset(trigger);
+}
+
+void oscilloscope_trigger_reset(oscilloscope_trigger_t *trigger)
+{
+    if(NULL != trigger)
+    {
+        trigger->armed = false;
+    }
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
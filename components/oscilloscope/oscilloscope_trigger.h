@@ -0,0 +1,108 @@
+/**
+* @file oscilloscope_trigger.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_TRIGGER_H__
+#define __OSCILLOSCOPE_TRIGGER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum{
+    OSCILLOSCOPE_TRIGGER_NONE,        // Free run, every sample triggers
+    OSCILLOSCOPE_TRIGGER_RISING,      // Signal crosses the level going up
+    OSCILLOSCOPE_TRIGGER_FALLING,     // Signal crosses the level going down
+    OSCILLOSCOPE_TRIGGER_LEVEL_HIGH,  // Signal is at or above the level
+    OSCILLOSCOPE_TRIGGER_LEVEL_LOW    // Signal is at or below the level
+} oscilloscope_trigger_type_t;
+
+typedef struct
+{
+    oscilloscope_trigger_type_t type;
+    uint16_t level;       // Trigger level in millivolts
+    uint16_t rearm_level; // Edge triggers fire only after the signal has been past this level (hysteresis)
+    bool armed;
+} oscilloscope_trigger_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Configure a trigger comparator.
+ *
+ * @param[out] trigger Comparator to configure.
+ * @param[in] type Trigger type.
+ * @param[in] level Trigger level in millivolts.
+ * @param[in] hysteresis How far (in millivolts) the signal has to move away from the level before an edge
+ *                       trigger can fire again. Filters out noise around the level.
+ */
+void oscilloscope_trigger_configure(oscilloscope_trigger_t *trigger, oscilloscope_trigger_type_t type,
+                                    uint16_t level, uint16_t hysteresis);
+
+/**
+ * @brief Reset the comparator state. The first edge after this call is only detected after the signal
+ *        has been on the other side of the hysteresis band.
+ *
+ * @param[in,out] trigger Comparator to reset.
+ */
+void oscilloscope_trigger_reset(oscilloscope_trigger_t *trigger);
+
+/**
+ * @brief Pass one sample through the trigger comparator.
+ *
+ * Runs inline in the sampling path: one or two compares per sample and no division.
+ *
+ * @param[in,out] trigger Comparator.
+ * @param[in] sample Sample in millivolts.
+ *
+ * @return true if the sample triggers.
+ */
+static inline bool oscilloscope_trigger_process(oscilloscope_trigger_t *trigger, uint16_t sample)
+{
+    switch(trigger->type)
+    {
+    case OSCILLOSCOPE_TRIGGER_RISING:
+        if(sample <= trigger->rearm_level)
+        {
+            trigger->armed = true;
+        }
+        else if(trigger->armed && (sample >= trigger->level))
+        {
+            trigger->armed = false;
+            return true;
+        }
+        return false;
+    case OSCILLOSCOPE_TRIGGER_FALLING:
+        if(sample >= trigger->rearm_level)
+        {
+            trigger->armed = true;
+        }
+        else if(trigger->armed && (sample <= trigger->level))
+        {
+            trigger->armed = false;
+            return true;
+        }
+        return false;
+    case OSCILLOSCOPE_TRIGGER_LEVEL_HIGH:
+        return sample >= trigger->level;
+    case OSCILLOSCOPE_TRIGGER_LEVEL_LOW:
+        return sample <= trigger->level;
+    default:
+        return true;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_TRIGGER_H__
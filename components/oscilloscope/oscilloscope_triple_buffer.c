@@ -0,0 +1,71 @@
+/**
+* @file oscilloscope_triple_buffer.c
+*
+* @brief Lock-free triple buffer index logic for handing complete buffers from one writer to one reader.
+*        The writer never waits for the reader and the reader never sees a partially written buffer.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "oscilloscope_triple_buffer.h"
+#include <stddef.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define TRIPLE_BUFFER_INDEX_MASK (0x03U)
+#define TRIPLE_BUFFER_FRESH      (0x04U)  // Middle slot was published and not yet acquired
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void oscilloscope_triple_buffer_init(oscilloscope_triple_buffer_t *buffer)
+{
+    if(NULL == buffer)
+    {
+        return;
+    }
+
+    buffer->back = 0;
+    buffer->front = 2;
+    atomic_store(&buffer->middle, 1);
+}
+
+uint8_t oscilloscope_triple_buffer_back(const oscilloscope_triple_buffer_t *buffer)
+{
+    return buffer->back;
+}
+
+void oscilloscope_triple_buffer_publish(oscilloscope_triple_buffer_t *buffer)
+{
+    uint_fast8_t previous = atomic_exchange(&buffer->middle, buffer->back | TRIPLE_BUFFER_FRESH);
+    buffer->back = previous & TRIPLE_BUFFER_INDEX_MASK;
+}
+
+bool oscilloscope_triple_buffer_acquire(oscilloscope_triple_buffer_t *buffer)
+{
+    if(0 == (atomic_load(&buffer->middle) & TRIPLE_BUFFER_FRESH))
+    {
+        return false;
+    }
+
+    /* Only the writer can change middle in between and it keeps it fresh, so the exchange always gets a new slot. */
+    uint_fast8_t previous = atomic_exchange(&buffer->middle, buffer->front);
+    buffer->front = previous & TRIPLE_BUFFER_INDEX_MASK;
+    return true;
+}
+
+uint8_t oscilloscope_triple_buffer_front(const oscilloscope_triple_buffer_t *buffer)
+{
+    return buffer->front;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
+
@@ -0,0 +1,82 @@
+/**
+* @file oscilloscope_triple_buffer.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __OSCILLOSCOPE_TRIPLE_BUFFER_H__
+#define __OSCILLOSCOPE_TRIPLE_BUFFER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+//---------------------------------- MACROS -----------------------------------
+#define OSCILLOSCOPE_TRIPLE_BUFFER_SLOTS (3U)
+//-------------------------------- DATA TYPES ---------------------------------
+/* Indexes into an array of OSCILLOSCOPE_TRIPLE_BUFFER_SLOTS buffers owned by the user. */
+typedef struct
+{
+    uint8_t back;           // Owned by the writer
+    uint8_t front;          // Owned by the reader
+    atomic_uint_fast8_t middle; // Exchanged between writer and reader, with a flag if it holds a new buffer
+} oscilloscope_triple_buffer_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Initialize a triple buffer. The writer starts on slot 0, the reader on slot 2.
+ *
+ * @param[out] buffer Triple buffer to initialize.
+ */
+void oscilloscope_triple_buffer_init(oscilloscope_triple_buffer_t *buffer);
+
+/**
+ * @brief Get the slot the writer fills. Called by the writer only.
+ *
+ * @param[in] buffer Triple buffer.
+ *
+ * @return Slot index.
+ */
+uint8_t oscilloscope_triple_buffer_back(const oscilloscope_triple_buffer_t *buffer);
+
+/**
+ * @brief Publish the filled back slot and get a free one. Called by the writer only, never blocks.
+ *
+ * A published slot that the reader has not picked up yet is given back to the writer, so the reader
+ * always gets the newest complete buffer.
+ *
+ * @param[in,out] buffer Triple buffer.
+ */
+void oscilloscope_triple_buffer_publish(oscilloscope_triple_buffer_t *buffer);
+
+/**
+ * @brief Take the newest published slot, if any. Called by the reader only, never blocks.
+ *
+ * The slot returned by `oscilloscope_triple_buffer_front()` is not touched by the writer until the next call.
+ *
+ * @param[in,out] buffer Triple buffer.
+ *
+ * @return true if a new slot was taken, false if nothing was published since the last call.
+ */
+bool oscilloscope_triple_buffer_acquire(oscilloscope_triple_buffer_t *buffer);
+
+/**
+ * @brief Get the slot the reader holds. Called by the reader only.
+ *
+ * @param[in] buffer Triple buffer.
+ *
+ * @return Slot index.
+ */
+uint8_t oscilloscope_triple_buffer_front(const oscilloscope_triple_buffer_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __OSCILLOSCOPE_TRIPLE_BUFFER_H__
@@ -0,0 +1,71 @@
+/**
+* @file storage.c
+*
+* @brief SPIFFS "storage" partition shared by the arbitrary waveform store and the oscilloscope screenshot
+*        store. Whichever needs it first mounts it, once, with room for the open files of both.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "storage.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_spiffs.h"
+#include "esp_log.h"
+
+//---------------------------------- MACROS -----------------------------------
+#define TAG "STORAGE"
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static SemaphoreHandle_t storage_mutex = NULL;
+static bool storage_mounted = false;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+esp_err_t storage_init(void)
+{
+    if(NULL == storage_mutex)
+    {
+        storage_mutex = xSemaphoreCreateMutex();
+    }
+    return (NULL != storage_mutex) ? ESP_OK : ESP_FAIL;
+}
+
+bool storage_mount(void)
+{
+    if((NULL == storage_mutex) || (pdTRUE != xSemaphoreTake(storage_mutex, portMAX_DELAY)))
+    {
+        return false;
+    }
+
+    if(!storage_mounted)
+    {
+        esp_vfs_spiffs_conf_t conf = {
+            .base_path = STORAGE_BASE_PATH,
+            .partition_label = STORAGE_PARTITION_LABEL,
+            .max_files = STORAGE_MAX_FILES,
+            .format_if_mount_failed = true,
+        };
+
+        esp_err_t err = esp_vfs_spiffs_register(&conf);
+        storage_mounted = (ESP_OK == err);
+        if(!storage_mounted)
+        {
+            ESP_LOGE(TAG, "Mounting partition \"%s\" failed: %s", STORAGE_PARTITION_LABEL, esp_err_to_name(err));
+        }
+    }
+
+    bool mounted = storage_mounted;
+    xSemaphoreGive(storage_mutex);
+    return mounted;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
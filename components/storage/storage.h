@@ -0,0 +1,51 @@
+/**
+* @file storage.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __STORAGE_H__
+#define __STORAGE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include "esp_err.h"
+
+//---------------------------------- MACROS -----------------------------------
+/* Host tests point it at a directory of their own. */
+#ifndef STORAGE_BASE_PATH
+#define STORAGE_BASE_PATH       "/spiffs"
+#endif
+#define STORAGE_PARTITION_LABEL "storage"
+#define STORAGE_MAX_FILES       (4U)  // Open at once, by all users together
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Prepares the shared mount. Must be called once, before any user of the partition is started.
+ *
+ * @return esp_err_t ESP_OK if everything is ok, ESP_FAIL else
+ */
+esp_err_t storage_init(void);
+
+/**
+ * @brief Mounts the "storage" partition at STORAGE_BASE_PATH on first use, formatting it if it can not be
+ *        mounted. Safe to call from any task; the first call may take seconds while the partition is formatted.
+ *
+ * @return true if the partition is mounted.
+ */
+bool storage_mount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __STORAGE_H__
@@ -0,0 +1,214 @@
+/**
+* @file waveform_awg.c
+*
+* @brief Arbitrary waveforms: images uploaded by a transport are validated and kept as files on the
+*        SPIFFS "storage" partition, one file per slot. A slot is read straight into the table the
+*        generator outputs from, so switching between stored waveforms is one short file read.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "waveform_awg.h"
+#include "storage.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define AWG_PATH_LENGTH     (sizeof(STORAGE_BASE_PATH) + 16U)   // "/awgNN.bin" and room to spare
+
+#define TAG "WAVEFORM AWG"
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Path of the file of a slot.
+ * 
+ * @param path Output, AWG_PATH_LENGTH characters.
+ * @param slot Slot.
+ * @param suffix "bin" for the stored image, "tmp" while it is written.
+ */
+static void _awg_path(char *path, uint32_t slot, const char *suffix);
+
+/**
+ * @brief Reads a little endian field of the header.
+ * 
+ * @param data Field.
+ * @param size Size of the field in bytes, up to 4.
+ * @return uint32_t Value.
+ */
+static uint32_t _awg_field(const uint8_t *data, uint32_t size);
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+/* Image being received, written by the transport task only. */
+static uint8_t *upload = NULL;  // Only while an upload is in progress
+static uint32_t upload_slot = WAVEFORM_AWG_SLOTS;
+static uint32_t upload_received = 0;
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool waveform_awg_validate(const uint8_t *image, uint32_t size)
+{
+    if((NULL == image) || (WAVEFORM_AWG_HEADER_SIZE > size))
+    {
+        return false;
+    }
+
+    uint32_t length = _awg_field(&image[4], 2);
+    if((WAVEFORM_AWG_MAGIC != _awg_field(image, 4)) || (0 != _awg_field(&image[6], 2)) ||
+       (WAVEFORM_AWG_MIN_POINTS > length) || (WAVEFORM_AWG_MAX_POINTS < length) ||
+       ((WAVEFORM_AWG_HEADER_SIZE + length) != size))
+    {
+        return false;
+    }
+
+    /* Every byte is a valid DAC code, so the CRC is the last check. */
+    return _awg_field(&image[8], 4) == esp_rom_crc32_le(0, &image[WAVEFORM_AWG_HEADER_SIZE], length);
+}
+
+esp_err_t waveform_awg_store(uint32_t slot, const uint8_t *image, uint32_t size)
+{
+    if((WAVEFORM_AWG_SLOTS <= slot) || !waveform_awg_validate(image, size))
+    {
+        ESP_LOGE(TAG, "Invalid image for slot %u", (unsigned)slot);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(!storage_mount())
+    {
+        return ESP_FAIL;
+    }
+
+    /* Written aside and renamed, so a load never sees half an image. */
+    char temporary[AWG_PATH_LENGTH];
+    char path[AWG_PATH_LENGTH];
+    _awg_path(temporary, slot, "tmp");
+    _awg_path(path, slot, "bin");
+
+    FILE *file = fopen(temporary, "wb");
+    if(NULL == file)
+    {
+        ESP_LOGE(TAG, "Opening %s failed", temporary);
+        return ESP_FAIL;
+    }
+    size_t written = fwrite(image, 1, size, file);
+    fclose(file);
+    if(written != size)
+    {
+        ESP_LOGE(TAG, "Writing %s failed", temporary);
+        remove(temporary);
+        return ESP_FAIL;
+    }
+
+    remove(path);
+    if(0 != rename(temporary, path))
+    {
+        ESP_LOGE(TAG, "Renaming %s failed", temporary);
+        remove(temporary);
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Slot %u stored, %u points", (unsigned)slot, (unsigned)_awg_field(&image[4], 2));
+    return ESP_OK;
+}
+
+esp_err_t waveform_awg_receive(uint32_t slot, uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total)
+{
+    if(0 == offset)
+    {
+        upload_slot = slot;
+        upload_received = 0;
+        if(NULL == upload)
+        {
+            upload = heap_caps_malloc(WAVEFORM_AWG_IMAGE_MAX, MALLOC_CAP_8BIT);
+        }
+    }
+    if((NULL == upload) || (WAVEFORM_AWG_SLOTS <= slot) || (slot != upload_slot) || (offset != upload_received) ||
+       (WAVEFORM_AWG_IMAGE_MAX < total) || ((offset + length) > total))
+    {
+        /* Out of order, too large or no memory: drop the upload, the next chunk at offset 0 starts over. */
+        upload_slot = WAVEFORM_AWG_SLOTS;
+        heap_caps_free(upload);
+        upload = NULL;
+        ESP_LOGE(TAG, "Upload to slot %u dropped at offset %u", (unsigned)slot, (unsigned)offset);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(&upload[offset], data, length);
+    upload_received += length;
+    if(upload_received < total)
+    {
+        return ESP_OK;
+    }
+
+    upload_slot = WAVEFORM_AWG_SLOTS;
+    esp_err_t err = waveform_awg_store(slot, upload, total);
+    heap_caps_free(upload);
+    upload = NULL;
+    return err;
+}
+
+esp_err_t waveform_awg_load(uint32_t slot, uint8_t *points, uint32_t *length)
+{
+    if(WAVEFORM_AWG_SLOTS <= slot)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(!storage_mount())
+    {
+        return ESP_FAIL;
+    }
+
+    char path[AWG_PATH_LENGTH];
+    _awg_path(path, slot, "bin");
+    FILE *file = fopen(path, "rb");
+    if(NULL == file)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* The points go straight to the output table, the CRC is checked there. */
+    uint8_t header[WAVEFORM_AWG_HEADER_SIZE];
+    uint32_t count = 0;
+    bool valid = (WAVEFORM_AWG_HEADER_SIZE == fread(header, 1, WAVEFORM_AWG_HEADER_SIZE, file)) &&
+                 (WAVEFORM_AWG_MAGIC == _awg_field(header, 4));
+    if(valid)
+    {
+        count = _awg_field(&header[4], 2);
+        valid = (WAVEFORM_AWG_MIN_POINTS <= count) && (WAVEFORM_AWG_MAX_POINTS >= count) &&
+                (count == fread(points, 1, count, file)) &&
+                (_awg_field(&header[8], 4) == esp_rom_crc32_le(0, points, count));
+    }
+    fclose(file);
+
+    if(!valid)
+    {
+        ESP_LOGE(TAG, "Slot %u is corrupted", (unsigned)slot);
+        return ESP_FAIL;
+    }
+    *length = count;
+    return ESP_OK;
+}
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _awg_path(char *path, uint32_t slot, const char *suffix)
+{
+    snprintf(path, AWG_PATH_LENGTH, STORAGE_BASE_PATH "/awg%02u.%s", (unsigned)slot, suffix);
+}
+
+static uint32_t _awg_field(const uint8_t *data, uint32_t size)
+{
+    uint32_t value = 0;
+    for(uint32_t i = 0; i < size; i++)
+    {
+        value |= (uint32_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
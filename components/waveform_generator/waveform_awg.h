@@ -0,0 +1,85 @@
+/**
+* @file waveform_awg.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __WAVEFORM_AWG_H__
+#define __WAVEFORM_AWG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+//---------------------------------- MACROS -----------------------------------
+#define WAVEFORM_AWG_SLOTS       (8U)
+#define WAVEFORM_AWG_MIN_POINTS  (16U)
+#define WAVEFORM_AWG_MAX_POINTS  (4096U)
+#define WAVEFORM_AWG_MAGIC       (0x31475741UL)   // "AWG1", little endian
+#define WAVEFORM_AWG_HEADER_SIZE (12U)
+#define WAVEFORM_AWG_IMAGE_MAX   (WAVEFORM_AWG_HEADER_SIZE + WAVEFORM_AWG_MAX_POINTS)
+//-------------------------------- DATA TYPES ---------------------------------
+/*
+ * Image of an arbitrary waveform as uploaded and as stored, little endian:
+ *   uint32_t magic     WAVEFORM_AWG_MAGIC
+ *   uint16_t length    Points of one period, WAVEFORM_AWG_MIN_POINTS - WAVEFORM_AWG_MAX_POINTS
+ *   uint16_t reserved  0
+ *   uint32_t crc       CRC-32 (IEEE) of the points
+ *   uint8_t  points[length]  DAC codes, played as they are
+ */
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Checks an image: magic, length, size and CRC.
+ * 
+ * @param image Image.
+ * @param size Size of the image in bytes.
+ * @return true if the image is valid.
+ */
+bool waveform_awg_validate(const uint8_t *image, uint32_t size);
+
+/**
+ * @brief Validates an image and writes it to a slot, replacing the one stored there. Blocks while
+ *        the file is written.
+ * 
+ * @param slot Slot, below WAVEFORM_AWG_SLOTS.
+ * @param image Image.
+ * @param size Size of the image in bytes.
+ * @return esp_err_t ESP_OK if stored, ESP_ERR_INVALID_ARG for an invalid image, ESP_FAIL else
+ */
+esp_err_t waveform_awg_store(uint32_t slot, const uint8_t *image, uint32_t size);
+
+/**
+ * @brief Takes an image in chunks, as a transport delivers it, and stores it once complete. One upload
+ *        at a time, a chunk at offset 0 starts a new one.
+ * 
+ * @param slot Slot, below WAVEFORM_AWG_SLOTS.
+ * @param offset Offset of the chunk in the image.
+ * @param data Chunk.
+ * @param length Length of the chunk in bytes.
+ * @param total Size of the whole image in bytes.
+ * @return esp_err_t ESP_OK if taken (and stored, with the last chunk), an error else
+ */
+esp_err_t waveform_awg_receive(uint32_t slot, uint32_t offset, const uint8_t *data, uint32_t length, uint32_t total);
+
+/**
+ * @brief Reads the points of a stored waveform and checks them again.
+ * 
+ * @param slot Slot, below WAVEFORM_AWG_SLOTS.
+ * @param points Output, WAVEFORM_AWG_MAX_POINTS bytes.
+ * @param length Output, points of one period.
+ * @return esp_err_t ESP_OK if read, ESP_ERR_NOT_FOUND for an empty slot, ESP_FAIL else
+ */
+esp_err_t waveform_awg_load(uint32_t slot, uint8_t *points, uint32_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WAVEFORM_AWG_H__
@@ -9,7 +9,10 @@
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "waveform_generator.h"
+#include "waveform_sine.h"
+#include "waveform_awg.h"
 #include "led.h"
+#include "esp_heap_caps.h"
 
 //---------------------------------- MACROS -----------------------------------
 #define RESOLUTION_1_MHZ   (1000000)
@@ -20,6 +23,12 @@
 
 #define TICKS_TO_WAIT      (10U)
 
+#define SAMPLE_RATE_HZ     (RESOLUTION_1_MHZ / TIMER_INTR_US)   // DAC updates per second
+
+#define SWEEP_INCREMENT_SHIFT (32U)   // Fraction bits of the swept phase increment
+#define SWEEP_PRODUCT_SHIFT   (24U)   // Of them dropped before the log sweep multiply, so it fits 64 bits
+#define SWEEP_GROWTH_BITS     (25U)   // Significant bits of the log sweep growth
+
 //-------------------------------- DATA TYPES ---------------------------------
 typedef struct {
     waveform_t    waveform;
@@ -32,6 +41,34 @@ typedef struct {
 
 EventGroupHandle_t event_gruop_handle[DAC_CHANNEL_MAX] = {NULL, NULL};
 
+/* One period of the output, read by the ISR at the phase of each sample. */
+typedef struct {
+    const uint8_t *data;
+    uint32_t      length;
+    int32_t       offset;   // Middle of the table range, amplitude modulation scales around it
+    uint8_t       high;     // Highest value
+    bool          square;   // Built-in square wave, pulse width modulation applies
+    int64_t       duty;     // Square: phase where the output goes low, up to 2^32
+} waveform_table_t;
+
+/* Modulation as the ISR runs it, computed by the task. */
+typedef struct {
+    waveform_modulation_t       modulation;
+    waveform_modulation_shape_t shape;
+    uint32_t                    increment;   // Phase of the modulating waveform per sample
+    int32_t                     depth;       // AM, FM: depth in Q15. PWM: duty swing in phase / 2^16
+} waveform_modulation_plan_t;
+
+/* Sweep as the ISR runs it, computed by the task. */
+typedef struct {
+    waveform_sweep_t sweep;
+    int64_t          start;     // Phase increment at the start frequency, Q32
+    int64_t          step;      // Linear: added to the increment per sample, Q32. Log: relative growth per sample
+    uint32_t         shift;     // Log: fraction bits of step, at least SWEEP_PRODUCT_SHIFT
+    uint32_t         samples;   // Samples of one sweep
+    uint32_t         dwell;     // Samples at the start frequency before every sweep
+} waveform_sweep_plan_t;
+
 typedef enum {
     WAVEFORM_GENERATOR_STATE_STARTED,
     WAVEFORM_GENERATOR_STATE_STOPPED,
@@ -41,8 +78,58 @@ typedef enum {
  * @brief Prepare values to be writen on DAC pin in the next period (calculates all data points for one signal period).
  * 
  * @param dac_channel One of two DAC channels (currently hardcoded to DAC_CHANNEL_TO_USE).
+ * @param data Table to fill, POINT_ARR_LEN points.
+ */
+static void _prepare_data(dac_channel_t dac_channel, uint8_t *data);
+
+/**
+ * @brief Hands a table to the ISR. While the output runs, the ISR adopts it at the end of the current period.
+ *        Called with no table pending.
+ * 
+ * @param table Table to output.
+ * @param running true if the timer is running.
+ */
+static void _table_publish(const waveform_table_t *table, bool running);
+
+/**
+ * @brief Phase step per DAC update for a frequency.
+ * 
+ * @param frequency Frequency in Hz
+ * @return uint32_t Phase increment, a full period is 2^32
+ */
+static uint32_t _phase_increment(uint32_t frequency);
+
+/**
+ * @brief Computes the sweep plan of the set sweep and hands it to the ISR, which starts it with the next sample.
+ * 
+ * @param running true if the timer is running.
+ */
+static void _sweep_publish(bool running);
+
+/**
+ * @brief Computes the modulation plan of the set modulation and hands it to the ISR, which starts it
+ *        with the next sample.
+ * 
+ * @param running true if the timer is running.
+ */
+static void _modulation_publish(bool running);
+
+/**
+ * @brief Fills the levels of a table: middle, highest value and the duty cycle of a square wave.
+ * 
+ * @param table Table with data and length set.
+ * @param square true for a built-in square wave.
  */
-static void _prepare_data(dac_channel_t dac_channel);
+static void _table_levels(waveform_table_t *table, bool square);
+
+/**
+ * @brief Value of the modulating waveform.
+ * 
+ * @param shape Shape.
+ * @param phase Phase of the modulating waveform, a full period is 2^32.
+ * @return int32_t Value in Q15, -WAVEFORM_SINE_MAX to WAVEFORM_SINE_MAX.
+ */
+static inline int32_t _modulation_value(waveform_modulation_shape_t shape, uint32_t phase);
 
 static void _waveform_generator_task_ch1(void *pvParameters);
 
@@ -67,9 +154,13 @@ esp_err_t _init_timer();
 /**
  * @brief Generatees waveform with provided parameters.
  * 
+ * A new frequency only changes the phase increment, so the output keeps its phase. A new shape, amplitude
+ * or duty cycle is built into the table the ISR is not reading.
+ * 
  * @param dac_channel One of two DAC channels (currently hardcoded to DAC_CHANNEL_TO_USE).
+ * @param running true if the output is running, the new table then starts at the next period boundary.
  */
-esp_err_t _genarate_waveform(dac_channel_t dac_channel);
+esp_err_t _genarate_waveform(dac_channel_t dac_channel, bool running);
 
 /**
  * @brief Timer callback.
@@ -79,12 +170,58 @@ esp_err_t _genarate_waveform(dac_channel_t dac_channel);
  */
 static bool IRAM_ATTR _on_timer_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data);
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
-static uint32_t g_index = 0;
 static gptimer_handle_t gptimer = NULL;
 
-static uint32_t raw_val[POINT_ARR_LEN];   // Used to store raw values
-
-static uint32_t output_point_number[DAC_CHANNEL_MAX];
+static uint8_t raw_val[2][POINT_ARR_LEN];   // Front and back table of the built-in waveforms
+static uint32_t raw_val_back = 0;           // Table the task builds into, the ISR reads the other one
+
+/* Arbitrary waveforms are read from flash into these and output from there. Allocated with the first
+   arbitrary waveform and kept, the ISR may be reading one of them. */
+static uint8_t (*awg_table)[WAVEFORM_AWG_MAX_POINTS] = NULL;
+static uint32_t awg_back = 0;
+static volatile uint32_t awg_slot = 0;
+static volatile bool awg_reload = false;
+
+/* Output path state. The task writes the back table and the increment, the ISR owns the phase and the front. */
+static waveform_table_t table_front = {.data = raw_val[1], .length = POINT_ARR_LEN};
+static volatile waveform_table_t table_back;
+static volatile bool table_pending = false;       // Back table waits for the next period boundary
+static volatile uint32_t phase_increment = 0;
+static uint32_t phase = 0;
+
+/* Parameters of the last built table, a frequency change alone does not rebuild it. */
+static waveform_t built_waveform = WAVEFORM_COUNT;
+static uint32_t built_amplitude_mv = 0;
+static uint32_t built_duty_cycle = 0;
+
+/* Sweep set by the user, turned into a plan by the task. */
+static waveform_sweep_t sweep_type = WAVEFORM_SWEEP_OFF;
+static uint32_t sweep_start_frequency = MIN_FREQUENCY;
+static uint32_t sweep_stop_frequency = MAX_FREQUENCY;
+static uint32_t sweep_duration_ms = MIN_SWEEP_TIME_MS;
+static uint32_t sweep_dwell_ms = 0;
+static volatile bool sweep_dirty = false;
+
+/* Sweep in the output path. The task writes the next plan, the ISR owns the rest. */
+static volatile waveform_sweep_plan_t sweep_next;
+static volatile bool sweep_pending = false;
+static waveform_sweep_plan_t sweep_plan = {.sweep = WAVEFORM_SWEEP_OFF};
+static int64_t sweep_increment = 0;   // Q32
+static uint32_t sweep_left = 0;
+static uint32_t dwell_left = 0;
+
+/* Modulation set by the user, turned into a plan by the task. */
+static waveform_modulation_t modulation_type = WAVEFORM_MODULATION_OFF;
+static waveform_modulation_shape_t modulation_shape = WAVEFORM_MODULATION_SHAPE_SINE;
+static uint32_t modulation_rate = MIN_MODULATION_RATE;
+static uint32_t modulation_depth = 0;
+static volatile bool modulation_dirty = false;
+
+/* Modulation in the output path. The task writes the next plan, the ISR owns the rest. */
+static volatile waveform_modulation_plan_t modulation_next;
+static volatile bool modulation_pending = false;
+static waveform_modulation_plan_t modulation_plan = {.modulation = WAVEFORM_MODULATION_OFF};
+static uint32_t modulation_phase = 0;
 
 static waveform_generator_t waveform_generator[DAC_CHANNEL_MAX] = { // set to inital (default) values
     {
@@ -117,7 +254,7 @@ esp_err_t waveform_generator_init(dac_channel_t dac_channel)
         return ESP_FAIL;
     }
 
-    if(pdPASS !=  xTaskCreatePinnedToCore(_waveform_generator_task_ch1, "CHANNEL_1 WAVEFORM GENERATOR", 1024, 0, 5, 
+    if(pdPASS !=  xTaskCreatePinnedToCore(_waveform_generator_task_ch1, "CHANNEL_1 WAVEFORM GENERATOR", 3 * 1024, 0, 5, 
                                             &(waveform_generator[DAC_CHANNEL_TO_USE].task_handle), 0))
     {
         ESP_LOGE("WAVEFORM GENERATOR INIT: ", "Failed to create freeRTOS task!");
@@ -154,6 +291,7 @@ esp_err_t waveform_generator_set_waveform(dac_channel_t dac_channel, waveform_t
         return ESP_FAIL;
     }
     waveform_generator[DAC_CHANNEL_TO_USE].waveform = waveform;
+    awg_reload = (WAVEFORM_ARBITRARY == waveform);
 
     xEventGroupSetBits(event_gruop_handle[DAC_CHANNEL_TO_USE], BIT_UPDATE);
 
@@ -201,33 +339,242 @@ esp_err_t waveform_generator_set_duty_cycle_percenatge(dac_channel_t dac_channel
 
     return ESP_OK;
 }
+
+esp_err_t waveform_generator_set_arbitrary(dac_channel_t dac_channel, uint32_t slot)
+{
+    if(WAVEFORM_AWG_SLOTS <= slot)
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid arbitrary waveform slot!");
+        return ESP_FAIL;
+    }
+    awg_slot = slot;
+    awg_reload = true;
+    waveform_generator[DAC_CHANNEL_TO_USE].waveform = WAVEFORM_ARBITRARY;
+
+    xEventGroupSetBits(event_gruop_handle[DAC_CHANNEL_TO_USE], BIT_UPDATE);
+
+    return ESP_OK;
+}
+
+esp_err_t waveform_generator_set_sweep(dac_channel_t dac_channel, waveform_sweep_t sweep, uint32_t start_frequency,
+                                       uint32_t stop_frequency, uint32_t sweep_time_ms, uint32_t dwell_time_ms)
+{
+    if(WAVEFORM_SWEEP_COUNT <= sweep)
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid sweep type!");
+        return ESP_FAIL;
+    }
+    if((WAVEFORM_SWEEP_OFF != sweep) &&
+       ((MIN_FREQUENCY > start_frequency) || (MAX_FREQUENCY < start_frequency) ||
+        (MIN_FREQUENCY > stop_frequency) || (MAX_FREQUENCY < stop_frequency) || (start_frequency == stop_frequency)))
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid sweep frequencies!");
+        return ESP_FAIL;
+    }
+    if((WAVEFORM_SWEEP_OFF != sweep) &&
+       ((MIN_SWEEP_TIME_MS > sweep_time_ms) || (MAX_SWEEP_TIME_MS < sweep_time_ms) || (MAX_DWELL_TIME_MS < dwell_time_ms)))
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid sweep or dwell time!");
+        return ESP_FAIL;
+    }
+
+    sweep_type = sweep;
+    sweep_start_frequency = start_frequency;
+    sweep_stop_frequency = stop_frequency;
+    sweep_duration_ms = sweep_time_ms;
+    sweep_dwell_ms = dwell_time_ms;
+    sweep_dirty = true;
+
+    xEventGroupSetBits(event_gruop_handle[DAC_CHANNEL_TO_USE], BIT_UPDATE);
+
+    return ESP_OK;
+}
+
+esp_err_t waveform_generator_set_modulation(dac_channel_t dac_channel, waveform_modulation_t modulation,
+                                            uint32_t depth_percentage)
+{
+    if(WAVEFORM_MODULATION_COUNT <= modulation)
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid modulation type!");
+        return ESP_FAIL;
+    }
+    if(100 < depth_percentage)
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid modulation depth!");
+        return ESP_FAIL;
+    }
+
+    modulation_type = modulation;
+    modulation_depth = depth_percentage;
+    modulation_dirty = true;
+
+    xEventGroupSetBits(event_gruop_handle[DAC_CHANNEL_TO_USE], BIT_UPDATE);
+
+    return ESP_OK;
+}
+
+esp_err_t waveform_generator_set_modulation_source(dac_channel_t dac_channel, waveform_modulation_shape_t shape,
+                                                   uint32_t rate)
+{
+    if(WAVEFORM_MODULATION_SHAPE_COUNT <= shape)
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid modulation shape!");
+        return ESP_FAIL;
+    }
+    if((MIN_MODULATION_RATE > rate) || (MAX_MODULATION_RATE < rate))
+    {
+        ESP_LOGE("WAVEFORM GEN: ", "Invalid modulation rate!");
+        return ESP_FAIL;
+    }
+
+    modulation_shape = shape;
+    modulation_rate = rate;
+    modulation_dirty = true;
+
+    xEventGroupSetBits(event_gruop_handle[DAC_CHANNEL_TO_USE], BIT_UPDATE);
+
+    return ESP_OK;
+}
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
-static void _prepare_data(dac_channel_t dac_channel)
+static void _prepare_data(dac_channel_t dac_channel, uint8_t *data)
 {
     uint32_t amplitude_dac = (uint32_t)(((float)waveform_generator[DAC_CHANNEL_TO_USE].amplitude_mv / VDD) * AMP_DAC_MAX_VALUE);
-    uint32_t square_duration = (uint32_t)(output_point_number[DAC_CHANNEL_TO_USE] * ((float)waveform_generator[DAC_CHANNEL_TO_USE].duty_cycle_percentage / 100));
-    g_index = 0;
+    uint32_t square_duration = (uint32_t)(POINT_ARR_LEN * ((float)waveform_generator[DAC_CHANNEL_TO_USE].duty_cycle_percentage / 100));
+    uint32_t sine_step = waveform_sine_phase(1, POINT_ARR_LEN);
 
-    for (int i = 0; i < output_point_number[DAC_CHANNEL_TO_USE]; i ++) {
+    for (int i = 0; i < POINT_ARR_LEN; i ++) {
         switch (waveform_generator[DAC_CHANNEL_TO_USE].waveform)
         {
             case WAVEFORM_SINE:
-                raw_val[i] = (int)((sin( i * CONST_PERIOD_2_PI / output_point_number[DAC_CHANNEL_TO_USE] ) + 1) * (double)(amplitude_dac) / 2 + 0.5);
+                data[i] = (amplitude_dac * (uint32_t)(waveform_sine_q15(i * sine_step) + WAVEFORM_SINE_MAX) +
+                           WAVEFORM_SINE_MAX) / (2 * WAVEFORM_SINE_MAX);
                 break;
             case WAVEFORM_TRIANGLE:
-                raw_val[i] = (i > (output_point_number[DAC_CHANNEL_TO_USE]  / 2)) ? (2 * amplitude_dac * (output_point_number[DAC_CHANNEL_TO_USE]  - i) / output_point_number[DAC_CHANNEL_TO_USE] ) : (2 * amplitude_dac * i / output_point_number[DAC_CHANNEL_TO_USE] );
+                data[i] = (i > (POINT_ARR_LEN / 2)) ? (2 * amplitude_dac * (POINT_ARR_LEN - i) / POINT_ARR_LEN) : (2 * amplitude_dac * i / POINT_ARR_LEN);
                 break;
             case WAVEFORM_SAWTOOTH:
-                raw_val[i] = (i == output_point_number[DAC_CHANNEL_TO_USE] ) ? 0 : (i * amplitude_dac / output_point_number[DAC_CHANNEL_TO_USE] );
+                data[i] = i * amplitude_dac / POINT_ARR_LEN;
                 break;
             case WAVEFORM_SQUARE:
-                raw_val[i] = (i < square_duration) ? amplitude_dac : 0;
+                data[i] = (i < square_duration) ? amplitude_dac : 0;
                 break;
             default: break;       
         }
     }
 }
 
+static void _table_publish(const waveform_table_t *table, bool running)
+{
+    if(!running)
+    {
+        /* Timer stopped, the ISR is not reading. */
+        table_front = *table;
+        phase = 0;
+        table_pending = false;
+        return;
+    }
+
+    /* The table must be complete in memory before the ISR may adopt it. */
+    table_back = *table;
+    __sync_synchronize();
+    table_pending = true;
+}
+
+static uint32_t _phase_increment(uint32_t frequency)
+{
+    return (uint32_t)((((uint64_t)frequency << 32) + SAMPLE_RATE_HZ / 2) / SAMPLE_RATE_HZ);
+}
+
+static void _sweep_publish(bool running)
+{
+    waveform_sweep_plan_t plan = {.sweep = sweep_type};
+
+    if(WAVEFORM_SWEEP_OFF != plan.sweep)
+    {
+        int64_t stop = (int64_t)_phase_increment(sweep_stop_frequency) << SWEEP_INCREMENT_SHIFT;
+        plan.start = (int64_t)_phase_increment(sweep_start_frequency) << SWEEP_INCREMENT_SHIFT;
+        plan.samples = sweep_duration_ms * (SAMPLE_RATE_HZ / 1000);
+        plan.dwell = sweep_dwell_ms * (SAMPLE_RATE_HZ / 1000);
+
+        if(WAVEFORM_SWEEP_LINEAR == plan.sweep)
+        {
+            plan.step = (stop - plan.start) / (int64_t)plan.samples;
+        }
+        else
+        {
+            /* Increment x (1 + growth) every sample reaches the stop frequency after all samples. Computed
+               once per set sweep, the ISR only multiplies. The scale keeps SWEEP_GROWTH_BITS of the growth
+               for slow sweeps as well as fast ones. */
+            double growth = pow((double)sweep_stop_frequency / sweep_start_frequency, 1.0 / plan.samples) - 1.0;
+            plan.shift = SWEEP_PRODUCT_SHIFT;
+            while((62U > plan.shift) && (fabs(growth) * ldexp(1.0, plan.shift + 1) < ldexp(1.0, SWEEP_GROWTH_BITS)))
+            {
+                plan.shift++;
+            }
+            plan.step = llround(ldexp(growth, plan.shift));
+        }
+    }
+
+    /* The ISR adopts a plan with its next sample, a stopped timer not at all. */
+    while(running && sweep_pending)
+    {
+        vTaskDelay(1);
+    }
+    sweep_next = plan;
+    __sync_synchronize();
+    sweep_pending = true;
+}
+
+static void _modulation_publish(bool running)
+{
+    waveform_modulation_plan_t plan = {
+        .modulation = modulation_type,
+        .shape = modulation_shape,
+        .increment = _phase_increment(modulation_rate),
+    };
+
+    if(WAVEFORM_MODULATION_PWM == plan.modulation)
+    {
+        plan.depth = (int32_t)(((uint64_t)modulation_depth << 16) / 100);
+    }
+    else
+    {
+        plan.depth = (int32_t)(modulation_depth * WAVEFORM_SINE_MAX / 100);
+    }
+
+    /* The ISR adopts a plan with its next sample, a stopped timer not at all. */
+    while(running && modulation_pending)
+    {
+        vTaskDelay(1);
+    }
+    modulation_next = plan;
+    __sync_synchronize();
+    modulation_pending = true;
+}
+
+static void _table_levels(waveform_table_t *table, bool square)
+{
+    uint8_t low = UINT8_MAX;
+    uint8_t high = 0;
+    uint32_t high_count = 0;
+
+    for(uint32_t i = 0; i < table->length; i++)
+    {
+        low = (table->data[i] < low) ? table->data[i] : low;
+        if(table->data[i] > high)
+        {
+            high = table->data[i];
+            high_count = 0;
+        }
+        high_count += (table->data[i] == high);
+    }
+
+    table->offset = ((int32_t)low + high) / 2;
+    table->high = high;
+    table->square = square;
+    table->duty = ((int64_t)high_count << 32) / table->length;
+}
+
 static void _waveform_generator_task_ch1(void *pvParameters)
 {
     waveform_generator_state_t state = WAVEFORM_GENERATOR_STATE_STOPPED;
@@ -251,7 +598,7 @@ static void _waveform_generator_task_ch1(void *pvParameters)
                     if(0 != (uxBits & BIT_START))
                     {
                         state = WAVEFORM_GENERATOR_STATE_STARTED;
-                        _genarate_waveform(DAC_CHANNEL_TO_USE);
+                        _genarate_waveform(DAC_CHANNEL_TO_USE, false);
                         led_pattern_run(LED_GREEN, LED_PATTERN_FASTBLINK, 0);
                         gptimer_start(gptimer);
                     }
@@ -264,10 +611,16 @@ static void _waveform_generator_task_ch1(void *pvParameters)
                         state = WAVEFORM_GENERATOR_STATE_STOPPED;
                         led_pattern_run(LED_GREEN, LED_PATTERN_KEEP_ON, 0);
                         gptimer_stop(gptimer);
+                        /* A table published just before the stop is adopted here, the ISR will not wrap again. */
+                        if(table_pending)
+                        {
+                            table_front = table_back;
+                            table_pending = false;
+                        }
                     }
                     else if(0 != (uxBits & BIT_UPDATE))
                     {
-                        _genarate_waveform(DAC_CHANNEL_TO_USE);
+                        _genarate_waveform(DAC_CHANNEL_TO_USE, true);
                     }
                     break;
                 }
@@ -336,7 +689,7 @@ esp_err_t _init_timer()
         .on_alarm = _on_timer_alarm_cb,
     };
 
-    err = gptimer_register_event_callbacks(gptimer, &cbs, raw_val);
+    err = gptimer_register_event_callbacks(gptimer, &cbs, NULL);
     if(ESP_OK != err)
     {
         return err;
@@ -345,7 +698,7 @@ esp_err_t _init_timer()
     err = gptimer_set_alarm_action(gptimer, &alarm_config);
     if(ESP_OK != err)
     {
-        return err;dac_output_voltage(DAC_CHANNEL_TO_USE, raw_val[g_index]);
+        return err;
     }
 
     err = gptimer_enable(gptimer);
@@ -357,28 +710,183 @@ esp_err_t _init_timer()
     return ESP_OK;
 }
 
-esp_err_t _genarate_waveform(dac_channel_t dac_channel)
+esp_err_t _genarate_waveform(dac_channel_t dac_channel, bool running)
 {
-    output_point_number[DAC_CHANNEL_TO_USE] =  (int)(RESOLUTION_1_MHZ / (TIMER_INTR_US * waveform_generator[DAC_CHANNEL_TO_USE].frequency) + 0.5);
-    if(output_point_number[DAC_CHANNEL_TO_USE] > POINT_ARR_LEN)
+    waveform_generator_t *generator = &waveform_generator[DAC_CHANNEL_TO_USE];
+
+    /* Applied by the next sample, from the phase the output is at. */
+    phase_increment = _phase_increment(generator->frequency);
+    if(!running || sweep_dirty)
     {
-        ESP_LOGE("WAVEFORM GENERATOR: ", "The frequency is too low!");
-        return ESP_FAIL;
+        sweep_dirty = false;
+        _sweep_publish(running);
+    }
+    if(!running || modulation_dirty)
+    {
+        modulation_dirty = false;
+        _modulation_publish(running);
+    }
+
+    bool rebuild = !running || (built_waveform != generator->waveform);
+    if(WAVEFORM_ARBITRARY == generator->waveform)
+    {
+        rebuild |= awg_reload;
+    }
+    else
+    {
+        rebuild |= (built_amplitude_mv != generator->amplitude_mv) || (built_duty_cycle != generator->duty_cycle_percentage);
+    }
+    if(!rebuild)
+    {
+        return ESP_OK;
+    }
+
+    /* Rebuilt only when the ISR has adopted the previous table, so it never reads a table being written.
+       That takes one period at most, 1 ms at MIN_FREQUENCY. A stopped timer adopts nothing and reads nothing. */
+    while(running && table_pending)
+    {
+        vTaskDelay(1);
+    }
+
+    waveform_table_t table;
+    if(WAVEFORM_ARBITRARY == generator->waveform)
+    {
+        /* Read straight into the table the ISR will output, of the length stored. */
+        uint32_t slot = awg_slot;
+        uint32_t length = 0;
+        awg_reload = false;
+        if(NULL == awg_table)
+        {
+            awg_table = heap_caps_malloc(2 * WAVEFORM_AWG_MAX_POINTS, MALLOC_CAP_8BIT);
+            if(NULL == awg_table)
+            {
+                ESP_LOGE("WAVEFORM GENERATOR: ", "Failed to allocate the arbitrary waveform tables!");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        esp_err_t err = waveform_awg_load(slot, awg_table[awg_back], &length);
+        if(ESP_OK != err)
+        {
+            ESP_LOGE("WAVEFORM GENERATOR: ", "Failed to load arbitrary waveform %u!", (unsigned)slot);
+            return err;
+        }
+        table.data = awg_table[awg_back];
+        table.length = length;
+        awg_back ^= 1;
+    }
+    else
+    {
+        _prepare_data(DAC_CHANNEL_TO_USE, raw_val[raw_val_back]);
+        table.data = raw_val[raw_val_back];
+        table.length = POINT_ARR_LEN;
+        raw_val_back ^= 1;
     }
+    _table_levels(&table, WAVEFORM_SQUARE == generator->waveform);
+    _table_publish(&table, running);
 
-    _prepare_data(DAC_CHANNEL_TO_USE);
+    built_waveform = generator->waveform;
+    built_amplitude_mv = generator->amplitude_mv;
+    built_duty_cycle = generator->duty_cycle_percentage;
 
     return ESP_OK;
 }
 
+static inline int32_t _modulation_value(waveform_modulation_shape_t shape, uint32_t phase)
+{
+    switch(shape)
+    {
+        case WAVEFORM_MODULATION_SHAPE_SQUARE:
+            return (phase < 0x80000000UL) ? WAVEFORM_SINE_MAX : -WAVEFORM_SINE_MAX;
+        case WAVEFORM_MODULATION_SHAPE_TRIANGLE:
+        {
+            int32_t rise = (int32_t)(phase >> 16);   // 0 - 65535 over the period
+            return 2 * ((rise < 32768) ? rise : (65535 - rise)) - WAVEFORM_SINE_MAX;
+        }
+        default:
+            return waveform_sine_q15(phase);
+    }
+}
+
 //---------------------------- INTERRUPT HANDLERS -----------------------------
 static bool IRAM_ATTR _on_timer_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data)
 {
-    if (g_index >= output_point_number[DAC_CHANNEL_TO_USE]) {
-        g_index = 0;
+    uint32_t increment = phase_increment;
+    int32_t modulation = 0;
+
+    if(sweep_pending)
+    {
+        sweep_plan = sweep_next;
+        sweep_pending = false;
+        sweep_increment = sweep_plan.start;
+        sweep_left = sweep_plan.samples;
+        dwell_left = sweep_plan.dwell;
+    }
+
+    /* Sweep: dwell at the start, step the increment every sample, start over. The phase is never touched. */
+    if(WAVEFORM_SWEEP_OFF != sweep_plan.sweep)
+    {
+        if(0 != dwell_left)
+        {
+            dwell_left--;
+        }
+        else if(0 != sweep_left)
+        {
+            sweep_increment += (WAVEFORM_SWEEP_LINEAR == sweep_plan.sweep) ? sweep_plan.step :
+                               (((sweep_increment >> SWEEP_PRODUCT_SHIFT) * sweep_plan.step) >> (sweep_plan.shift - SWEEP_PRODUCT_SHIFT));
+            sweep_left--;
+        }
+        else
+        {
+            sweep_increment = sweep_plan.start;
+            sweep_left = sweep_plan.samples;
+            dwell_left = sweep_plan.dwell;
+        }
+        increment = (uint32_t)(sweep_increment >> SWEEP_INCREMENT_SHIFT);
+    }
+
+    if(modulation_pending)
+    {
+        modulation_plan = modulation_next;
+        modulation_pending = false;
+    }
+    if(WAVEFORM_MODULATION_OFF != modulation_plan.modulation)
+    {
+        modulation_phase += modulation_plan.increment;
+        modulation = _modulation_value(modulation_plan.shape, modulation_phase);
+    }
+    if(WAVEFORM_MODULATION_FM == modulation_plan.modulation)
+    {
+        /* Increment x (1 + depth x modulation), the phase stays continuous. */
+        int32_t deviation = (modulation_plan.depth * modulation) >> 15;
+        increment = (uint32_t)((int64_t)increment + (((int64_t)increment * deviation) >> 15));
+    }
+
+    uint32_t previous = phase;
+    phase += increment;
+
+    /* Period boundary: a pending table starts here, at phase 0 of its period. */
+    if((phase < previous) && table_pending)
+    {
+        table_front = table_back;
+        table_pending = false;
+    }
+
+    /* Index = phase x length / 2^32, one 32 x 32 bit multiply. */
+    int32_t value = table_front.data[((uint64_t)phase * table_front.length) >> 32];
+
+    if(WAVEFORM_MODULATION_AM == modulation_plan.modulation)
+    {
+        /* Gain from 1 at the top of the modulating waveform to 1 - depth at its bottom, around the middle. */
+        int32_t gain = WAVEFORM_SINE_MAX - ((modulation_plan.depth * (WAVEFORM_SINE_MAX - modulation)) >> 16);
+        value = table_front.offset + (((value - table_front.offset) * gain) >> 15);
+    }
+    else if((WAVEFORM_MODULATION_PWM == modulation_plan.modulation) && table_front.square)
+    {
+        /* The square wave is compared against a moving duty instead of read from the table. */
+        int64_t duty = table_front.duty + (((int64_t)modulation_plan.depth * modulation) << 1);
+        value = ((int64_t)phase < duty) ? table_front.high : 0;
     }
-    dac_output_voltage(DAC_CHANNEL_TO_USE, raw_val[g_index]);
-    g_index++;
+    dac_output_voltage(DAC_CHANNEL_TO_USE, (uint8_t)value);
 
     return false;
 }
@@ -32,12 +32,18 @@ extern "C" {
 #define TIMER_INTR_US      (8U)                               // Execution time of each ISR interval in micro-seconds
 #define POINT_ARR_LEN      (200U)                             // Length of points array
 #define VDD                (3300U)                            // VDD is 3.3V, 3300mV
-#define CONST_PERIOD_2_PI  (6.2832)
 #define AMP_DAC_MAX_VALUE  (255U)                             // Amplitude of DAC voltage. If it's more than 256 will causes dac_output_voltage() output 0.
 
 #define MIN_FREQUENCY      (1000U)  //these values have to be tested
 #define MAX_FREQUENCY      (10000U) 
 
+#define MIN_SWEEP_TIME_MS  (100U)
+#define MAX_SWEEP_TIME_MS  (100000U)
+#define MAX_DWELL_TIME_MS  (10000U)
+
+#define MIN_MODULATION_RATE (1U)    // Hz, sub-audio
+#define MAX_MODULATION_RATE (20U)
+
 #define BIT_START          (1 << 0)
 #define BIT_STOP           (1 << 1)
 #define BIT_UPDATE         (1 << 3)
@@ -51,10 +57,36 @@ typedef enum {
     WAVEFORM_TRIANGLE,
     WAVEFORM_SAWTOOTH,
     WAVEFORM_SQUARE,
+    WAVEFORM_ARBITRARY,   // Stored table, see waveform_awg.h
 
     WAVEFORM_COUNT
 } waveform_t;
 
+typedef enum {
+    WAVEFORM_SWEEP_OFF,      // Fixed frequency
+    WAVEFORM_SWEEP_LINEAR,   // Same number of Hz per second
+    WAVEFORM_SWEEP_LOG,      // Same number of octaves per second
+
+    WAVEFORM_SWEEP_COUNT
+} waveform_sweep_t;
+
+typedef enum {
+    WAVEFORM_MODULATION_OFF,
+    WAVEFORM_MODULATION_AM,    // Envelope between 100 % and (100 - depth) % of the amplitude
+    WAVEFORM_MODULATION_FM,    // Peak deviation of depth % of the carrier frequency
+    WAVEFORM_MODULATION_PWM,   // Square wave only, duty cycle swings by depth percentage points
+
+    WAVEFORM_MODULATION_COUNT
+} waveform_modulation_t;
+
+typedef enum {
+    WAVEFORM_MODULATION_SHAPE_SINE,
+    WAVEFORM_MODULATION_SHAPE_SQUARE,
+    WAVEFORM_MODULATION_SHAPE_TRIANGLE,
+
+    WAVEFORM_MODULATION_SHAPE_COUNT
+} waveform_modulation_shape_t;
+
 extern EventGroupHandle_t event_gruop_handle[DAC_CHANNEL_MAX];
 //---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
 /**
@@ -116,6 +148,60 @@ esp_err_t waveform_generator_set_amplitude_mv(dac_channel_t dac_channel, uint32_
  */
 esp_err_t waveform_generator_set_duty_cycle_percenatge(dac_channel_t dac_channel, uint32_t duty_cycle_percenatge);
 
+/**
+ * @brief Switches the output to an arbitrary waveform stored in a slot, at the current frequency. The slot
+ *        is read again on every call, so a waveform uploaded to the playing slot is picked up.
+ * 
+ * The points are DAC codes and are played as they are, the amplitude and the duty cycle do not apply.
+ * 
+ * @param dac_channel Channel to update
+ * @param slot Slot of the waveform, below WAVEFORM_AWG_SLOTS
+ * @return esp_err_t ESP_OK is everything is ok, ESP_FAIL else
+ */
+esp_err_t waveform_generator_set_arbitrary(dac_channel_t dac_channel, uint32_t slot);
+
+/**
+ * @brief Sets a repeating frequency sweep (chirp): the output stays at the start frequency for the dwell
+ *        time, sweeps to the stop frequency in the sweep time, then starts over. The sweep runs in the
+ *        output ISR on the phase increment, so the phase is continuous throughout, also when it starts over.
+ * 
+ * While a sweep is set the frequency set by waveform_generator_set_frequency() is not used.
+ * 
+ * @param dac_channel Channel to update
+ * @param sweep Sweep type, WAVEFORM_SWEEP_OFF to return to the set frequency
+ * @param start_frequency Frequency at the start [MIN_FREQUENCY, MAX_FREQUENCY], above or below the stop frequency
+ * @param stop_frequency Frequency at the end [MIN_FREQUENCY, MAX_FREQUENCY]
+ * @param sweep_time_ms Time of one sweep [MIN_SWEEP_TIME_MS, MAX_SWEEP_TIME_MS]
+ * @param dwell_time_ms Time at the start frequency before every sweep [0, MAX_DWELL_TIME_MS]
+ * @return esp_err_t ESP_OK is everything is ok, ESP_FAIL else
+ */
+esp_err_t waveform_generator_set_sweep(dac_channel_t dac_channel, waveform_sweep_t sweep, uint32_t start_frequency,
+                                       uint32_t stop_frequency, uint32_t sweep_time_ms, uint32_t dwell_time_ms);
+
+/**
+ * @brief Sets the modulation of the carrier by the internal modulating waveform. Computed per sample in
+ *        the output ISR, in integers.
+ * 
+ * @param dac_channel Channel to update
+ * @param modulation Modulation type, WAVEFORM_MODULATION_OFF for none
+ * @param depth_percentage Modulation depth [0, 100], see waveform_modulation_t
+ * @return esp_err_t ESP_OK is everything is ok, ESP_FAIL else
+ */
+esp_err_t waveform_generator_set_modulation(dac_channel_t dac_channel, waveform_modulation_t modulation,
+                                            uint32_t depth_percentage);
+
+/**
+ * @brief Sets the internal modulating waveform. It runs on while the modulation changes, so it has no
+ *        phase jump either.
+ * 
+ * @param dac_channel Channel to update
+ * @param shape Shape of the modulating waveform
+ * @param rate Frequency of the modulating waveform [MIN_MODULATION_RATE, MAX_MODULATION_RATE]
+ * @return esp_err_t ESP_OK is everything is ok, ESP_FAIL else
+ */
+esp_err_t waveform_generator_set_modulation_source(dac_channel_t dac_channel, waveform_modulation_shape_t shape,
+                                                   uint32_t rate);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,41 @@
+/**
+* @file waveform_sine.c
+*
+* @brief Quarter-wave sine table in Q15, shared by the generator and the preview in the GUI. The compiler
+*        evaluates every entry, nothing is computed at run time.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "waveform_sine.h"
+
+//---------------------------------- MACROS -----------------------------------
+#define SINE_HALF_PI  (1.57079632679489662)
+
+/* sin(x) on [0, pi/2] as its Taylor series up to x^13, below 1e-9 off, a constant expression. */
+#define SINE_X(i)     ((double)(i) * SINE_HALF_PI / WAVEFORM_SINE_QUARTER)
+#define SINE_X2(i)    (SINE_X(i) * SINE_X(i))
+#define SINE(i)       (SINE_X(i) * (1 - SINE_X2(i) / 6 * (1 - SINE_X2(i) / 20 * (1 - SINE_X2(i) / 42 *  \
+                      (1 - SINE_X2(i) / 72 * (1 - SINE_X2(i) / 110 * (1 - SINE_X2(i) / 156)))))))
+#define SINE_Q15(i)   ((int16_t)(SINE(i) * WAVEFORM_SINE_MAX + 0.5))
+
+#define SINE_4(i)     SINE_Q15(i), SINE_Q15((i) + 1), SINE_Q15((i) + 2), SINE_Q15((i) + 3)
+#define SINE_16(i)    SINE_4(i), SINE_4((i) + 4), SINE_4((i) + 8), SINE_4((i) + 12)
+#define SINE_64(i)    SINE_16(i), SINE_16((i) + 16), SINE_16((i) + 32), SINE_16((i) + 48)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+const int16_t waveform_sine_quarter[WAVEFORM_SINE_QUARTER + 1] = {
+    SINE_64(0), SINE_64(64), SINE_64(128), SINE_64(192), SINE_Q15(WAVEFORM_SINE_QUARTER)
+};
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
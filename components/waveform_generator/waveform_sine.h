@@ -0,0 +1,67 @@
+/**
+* @file waveform_sine.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __WAVEFORM_SINE_H__
+#define __WAVEFORM_SINE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+#define WAVEFORM_SINE_QUARTER (256U)    // Table steps per quarter period, 1024 per period
+#define WAVEFORM_SINE_MAX     (32767)   // Q15 full scale
+//-------------------------------- DATA TYPES ---------------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+extern const int16_t waveform_sine_quarter[WAVEFORM_SINE_QUARTER + 1];
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Sine of a phase, looked up in the quarter-wave table and mirrored into the other three quarters.
+ *        Integer only, usable from an ISR.
+ * 
+ * @param phase Phase, a full period is 2^32.
+ * @return int32_t Sine in Q15, -WAVEFORM_SINE_MAX to WAVEFORM_SINE_MAX.
+ */
+static inline int32_t waveform_sine_q15(uint32_t phase)
+{
+    uint32_t step = (phase + (1UL << 21)) >> 22;      // Nearest of 1024 steps, wraps to 0 past the last one
+    uint32_t index = step & (WAVEFORM_SINE_QUARTER - 1);
+    int32_t value;
+
+    if(0 == (step & WAVEFORM_SINE_QUARTER))
+    {
+        value = waveform_sine_quarter[index];
+    }
+    else
+    {
+        value = waveform_sine_quarter[WAVEFORM_SINE_QUARTER - index];
+    }
+    return (step & (2 * WAVEFORM_SINE_QUARTER)) ? -value : value;
+}
+
+/**
+ * @brief Phase of a point of a table of one period, or with point 1 the phase step between points.
+ * 
+ * @param point Point index.
+ * @param length Points per period.
+ * @return uint32_t Phase, a full period is 2^32.
+ */
+static inline uint32_t waveform_sine_phase(uint32_t point, uint32_t length)
+{
+    return (uint32_t)(((uint64_t)point << 32) / length);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WAVEFORM_SINE_H__
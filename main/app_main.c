@@ -15,6 +15,7 @@
 #include "waveform_generator.h"
 #include "temp_humidity.h"
 #include "gui.h"
+#include "storage.h"
 
 #include "blesa_wifi.h"  // temproary for testing, delete afterwards
 
@@ -34,6 +35,12 @@
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 void app_main(void)
 {
+    /* Before the waveform generator and the GUI, which both keep files on the storage partition. */
+    if(ESP_OK != storage_init())
+    {
+        ESP_LOGE("MAIN: ", "Storage initialization failed!");
+    }
+
     if(TEMP_HUMIDITY_STATUS_OK != temp_humidity_initialize())
     {
         ESP_LOGE("MAIN: ", "Tempearature and humidity sensors initialization failed!");
@@ -0,0 +1,434 @@
+/**
+* @file host_stubs.c
+*
+* @brief Host implementations of the ESP-IDF and FreeRTOS calls made by the modules under test. Nothing here
+*        runs in the background: the tests call the timer callbacks themselves.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_stubs.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "esp_adc/adc_continuous.h"
+#include "soc/soc_caps.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "driver/dac.h"
+#include "driver/gptimer.h"
+#include "led.h"
+#include "storage.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define CRC32_POLYNOMIAL (0xEDB88320U)
+
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t items[];
+} host_queue_t;
+
+struct adc_continuous_ctx_t
+{
+    adc_continuous_evt_cbs_t callbacks;
+    void *user_data;
+    bool started;
+    uint32_t pool_size;
+    uint32_t pool_length;
+    uint32_t frame_size;
+    uint8_t pool[];
+};
+
+//------------------------------- GLOBAL DATA ---------------------------------
+volatile uint8_t host_dac_value = 0;
+void (*host_task_delay_hook)(void) = NULL;
+uint32_t host_task_notifications = 0;
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static adc_continuous_handle_t host_adc_continuous = NULL;
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+const char *esp_err_to_name(esp_err_t code)
+{
+    return (ESP_OK == code) ? "ESP_OK" : "ESP_FAIL";
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for(uint32_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for(uint32_t bit = 0; bit < 8U; bit++)
+        {
+            crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id)
+{
+    (void)task;
+    (void)name;
+    (void)stack_depth;
+    (void)parameters;
+    (void)priority;
+    (void)created_task;
+    (void)core_id;
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    (void)ticks;
+    if(NULL != host_task_delay_hook)
+    {
+        host_task_delay_hook();
+    }
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks)
+{
+    (void)clear_count_on_exit;
+    (void)ticks;
+    uint32_t count = host_task_notifications;
+    host_task_notifications = 0;
+    return count;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken)
+{
+    (void)task;
+    host_task_notifications++;
+    if(NULL != higher_priority_task_woken)
+    {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    host_queue_t *queue = calloc(1, sizeof(host_queue_t) + length * item_size);
+    if(NULL != queue)
+    {
+        queue->length = length;
+        queue->item_size = item_size;
+    }
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    (void)ticks;
+    host_queue_t *q = queue;
+    if(q->count == q->length)
+    {
+        return pdFALSE;
+    }
+    memcpy(&q->items[((q->head + q->count) % q->length) * q->item_size], item, q->item_size);
+    q->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    (void)ticks;
+    host_queue_t *q = queue;
+    if(0U == q->count)
+    {
+        return pdFALSE;
+    }
+    memcpy(item, &q->items[q->head * q->item_size], q->item_size);
+    q->head = (q->head + 1U) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    free(queue);
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    static int event_group;
+    return &event_group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, EventBits_t bits)
+{
+    (void)event_group;
+    return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks)
+{
+    (void)event_group;
+    (void)clear_on_exit;
+    (void)wait_for_all;
+    (void)ticks;
+    return bits;
+}
+
+esp_err_t dac_output_enable(dac_channel_t channel)
+{
+    (void)channel;
+    return ESP_OK;
+}
+
+esp_err_t dac_output_voltage(dac_channel_t channel, uint8_t dac_value)
+{
+    (void)channel;
+    host_dac_value = dac_value;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_new_timer(const gptimer_config_t *config, gptimer_handle_t *ret_timer)
+{
+    (void)config;
+    *ret_timer = NULL;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t *cbs,
+                                           void *user_data)
+{
+    (void)timer;
+    (void)cbs;
+    (void)user_data;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t *config)
+{
+    (void)timer;
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer)
+{
+    (void)timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer)
+{
+    (void)timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer)
+{
+    (void)timer;
+    return ESP_OK;
+}
+
+led_err_t led_pattern_run(led_name_t led, led_pattern_t led_pattern, uint32_t timeout_ms)
+{
+    (void)led;
+    (void)led_pattern;
+    (void)timeout_ms;
+    return LED_ERR_NONE;
+}
+
+esp_err_t adc_oneshot_new_unit(const adc_oneshot_unit_init_cfg_t *init_config, adc_oneshot_unit_handle_t *ret_unit)
+{
+    static int unit;
+    (void)init_config;
+    *ret_unit = &unit;
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_config_channel(adc_oneshot_unit_handle_t handle, adc_channel_t channel,
+                                     const adc_oneshot_chan_cfg_t *config)
+{
+    (void)handle;
+    (void)channel;
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_read(adc_oneshot_unit_handle_t handle, adc_channel_t channel, int *out_raw)
+{
+    (void)handle;
+    (void)channel;
+    *out_raw = 0;
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_del_unit(adc_oneshot_unit_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config,
+                                    adc_continuous_handle_t *ret_handle)
+{
+    adc_continuous_handle_t handle = calloc(1, sizeof(struct adc_continuous_ctx_t) + hdl_config->max_store_buf_size);
+    if(NULL == handle)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    handle->pool_size = hdl_config->max_store_buf_size;
+    handle->frame_size = hdl_config->conv_frame_size;
+    host_adc_continuous = handle;
+    *ret_handle = handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config)
+{
+    (void)handle;
+    bool valid = (0U < config->pattern_num) && (SOC_ADC_PATT_LEN_MAX >= config->pattern_num) &&
+                 (SOC_ADC_SAMPLE_FREQ_THRES_LOW <= config->sample_freq_hz) &&
+                 (SOC_ADC_SAMPLE_FREQ_THRES_HIGH >= config->sample_freq_hz);
+    return valid ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle,
+                                                  const adc_continuous_evt_cbs_t *cbs, void *user_data)
+{
+    handle->callbacks = *cbs;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle)
+{
+    if(handle->started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->started = true;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle)
+{
+    if(!handle->started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->started = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max,
+                              uint32_t *out_length, uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    uint32_t length = (handle->pool_length < length_max) ? handle->pool_length : length_max;
+    if(0U == length)
+    {
+        *out_length = 0;
+        return ESP_ERR_TIMEOUT;
+    }
+    memcpy(buf, handle->pool, length);
+    handle->pool_length -= length;
+    memmove(handle->pool, &handle->pool[length], handle->pool_length);
+    *out_length = length;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle)
+{
+    if(handle->started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if(host_adc_continuous == handle)
+    {
+        host_adc_continuous = NULL;
+    }
+    free(handle);
+    return ESP_OK;
+}
+
+uint32_t host_adc_continuous_feed(const uint8_t *results, uint32_t length)
+{
+    adc_continuous_handle_t handle = host_adc_continuous;
+    if((NULL == handle) || !handle->started)
+    {
+        return 0;
+    }
+
+    uint32_t room = handle->pool_size - handle->pool_length;
+    uint32_t stored = (length < room) ? length : room;
+    memcpy(&handle->pool[handle->pool_length], results, stored);
+    handle->pool_length += stored;
+
+    adc_continuous_evt_data_t event = {
+        .conv_frame_buffer = handle->pool,
+        .size = handle->pool_length,
+    };
+    if((stored < length) && (NULL != handle->callbacks.on_pool_ovf))
+    {
+        handle->callbacks.on_pool_ovf(handle, &event, handle->user_data);
+    }
+    if((0U < stored) && (NULL != handle->callbacks.on_conv_done))
+    {
+        handle->callbacks.on_conv_done(handle, &event, handle->user_data);
+    }
+    return stored;
+}
+
+esp_err_t adc_cali_create_scheme_line_fitting(const adc_cali_line_fitting_config_t *config,
+                                              adc_cali_handle_t *ret_handle)
+{
+    static adc_atten_t atten;
+    atten = config->atten;
+    *ret_handle = &atten;
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_delete_scheme_line_fitting(adc_cali_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage)
+{
+    /* Same shape as the ESP32 line fitting scheme: a Q16 gain from eFuse and an offset, in 64-bit math. */
+    static const uint32_t gain_q16[SOC_ADC_ATTEN_NUM] = {57431U, 76236U, 107116U, 184222U};
+    static const int32_t offset_mv[SOC_ADC_ATTEN_NUM] = {75, 78, 88, 142};
+    adc_atten_t atten = *(const adc_atten_t *)handle;
+
+    *voltage = (int)(((uint64_t)(uint32_t)raw * gain_q16[atten] + 32768U) >> 16) + offset_mv[atten];
+    return ESP_OK;
+}
+
+bool storage_mount(void)
+{
+    mkdir(STORAGE_BASE_PATH, 0755);
+    return true;
+}
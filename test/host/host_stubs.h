@@ -0,0 +1,39 @@
+/**
+* @file host_stubs.h
+*
+* @brief See the source file.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __HOST_STUBS_H__
+#define __HOST_STUBS_H__
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+
+//------------------------------- GLOBAL DATA ---------------------------------
+/* Last value written by dac_output_voltage(). */
+extern volatile uint8_t host_dac_value;
+
+/* Called by vTaskDelay(), so a test can run the timer callback a task is waiting for. */
+extern void (*host_task_delay_hook)(void);
+
+/* Notifications given by vTaskNotifyGiveFromISR(). */
+extern uint32_t host_task_notifications;
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief Puts conversion results into the pool of the started continuous ADC driver, as its DMA does, and calls
+ *        the conversion done callback. What does not fit in the pool is lost and the pool overflow callback is
+ *        called instead, as by the driver.
+ *
+ * @param[in] results Raw conversion results.
+ * @param[in] length Length of `results` in bytes.
+ *
+ * @return Bytes put into the pool. 0 if the driver is not started.
+ */
+uint32_t host_adc_continuous_feed(const uint8_t *results, uint32_t length);
+
+#endif // __HOST_STUBS_H__
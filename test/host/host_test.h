@@ -0,0 +1,64 @@
+/**
+* @file host_test.h
+*
+* @brief Checks and timing shared by the host tests. Every test is one program: it prints what it measured,
+*        and exits with a failure if any check did not hold.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//---------------------------------- MACROS -----------------------------------
+/* Records a failed check and carries on, so one run reports every failure. */
+#define HOST_CHECK(condition)                                                          \
+    do                                                                                 \
+    {                                                                                  \
+        if(!(condition))                                                               \
+        {                                                                              \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);       \
+            host_test_failures++;                                                      \
+        }                                                                              \
+    } while(0)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static unsigned host_test_failures = 0;
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+/**
+ * @brief Monotonic time for the benchmarks.
+ *
+ * @return Nanoseconds since an arbitrary start.
+ */
+static inline int64_t host_time_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Ends a test.
+ *
+ * @return Exit status of the test program.
+ */
+static inline int host_test_result(void)
+{
+    if(0U != host_test_failures)
+    {
+        printf("FAILED: %u check(s)\n", host_test_failures);
+        return EXIT_FAILURE;
+    }
+    printf("PASSED\n");
+    return EXIT_SUCCESS;
+}
+
+#endif // __HOST_TEST_H__
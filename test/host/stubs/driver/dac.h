@@ -0,0 +1,14 @@
+/* Host stand-in for driver/dac.h. The last written value is in host_dac_value, see host_stubs.c. */
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    DAC_CHANNEL_1,
+    DAC_CHANNEL_2,
+    DAC_CHANNEL_MAX
+} dac_channel_t;
+
+esp_err_t dac_output_enable(dac_channel_t channel);
+esp_err_t dac_output_voltage(dac_channel_t channel, uint8_t dac_value);
@@ -0,0 +1,3 @@
+/* Host stand-in for driver/gpio.h. */
+#pragma once
+#include <stdint.h>
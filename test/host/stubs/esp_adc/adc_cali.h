@@ -0,0 +1,7 @@
+/* Host stand-in for esp_adc/adc_cali.h. */
+#pragma once
+#include "adc_oneshot.h"
+
+typedef void *adc_cali_handle_t;
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage);
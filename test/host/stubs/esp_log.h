@@ -0,0 +1,9 @@
+/* Host stand-in for esp_log.h: every level goes to stderr. */
+#pragma once
+#include <stdio.h>
+#include "esp_err.h"
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) fprintf(stderr, "I %s " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
@@ -0,0 +1,6 @@
+/* Host stand-in for esp_timer.h: the monotonic clock only. */
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,22 @@
+/* Host stand-in for FreeRTOS.h. */
+#pragma once
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE             (1)
+#define pdFALSE            (0)
+#define pdPASS             (1)
+#define pdFAIL             (0)
+#define portMAX_DELAY      (0xffffffffU)
+#define portTICK_PERIOD_MS (10U)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms) / portTICK_PERIOD_MS)
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
@@ -0,0 +1,11 @@
+/* Host stand-in for FreeRTOS event_groups.h. */
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks);
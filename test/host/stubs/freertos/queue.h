@@ -0,0 +1,10 @@
+/* Host stand-in for FreeRTOS queue.h: a copying queue that never blocks, see host_stubs.c. */
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+void vQueueDelete(QueueHandle_t queue);
@@ -0,0 +1,14 @@
+/* Host stand-in for FreeRTOS task.h. vTaskDelay() runs the test's hook and
+   vTaskNotifyGiveFromISR() counts notifications, see host_stubs.c. */
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken);
@@ -0,0 +1,5 @@
+/* Host stand-in for FreeRTOS timers.h. */
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *TimerHandle_t;
@@ -0,0 +1,22 @@
+/* Host stand-in for the LVGL types used by the hardware independent modules. */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int16_t lv_coord_t;
+
+#define LV_COORD_MAX        ((1 << 13) - 1)   // Without LV_USE_LARGE_COORD
+#define LV_CHART_POINT_NONE (LV_COORD_MAX)
+
+typedef union
+{
+    struct
+    {
+        uint8_t blue;
+        uint8_t green;
+        uint8_t red;
+        uint8_t alpha;
+    } ch;
+    uint32_t full;
+} lv_color32_t;
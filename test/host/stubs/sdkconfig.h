@@ -0,0 +1,2 @@
+/* Host build: no PSRAM, every Kconfig option at its default. */
+#pragma once
@@ -0,0 +1,9 @@
+/* Host stand-in for soc/soc_caps.h (ESP32). */
+#pragma once
+
+#define SOC_ADC_ATTEN_NUM (4)
+#define SOC_ADC_PATT_LEN_MAX           (16)
+#define SOC_ADC_DIGI_MAX_BITWIDTH      (12)
+#define SOC_ADC_DIGI_RESULT_BYTES      (2)
+#define SOC_ADC_SAMPLE_FREQ_THRES_HIGH (2 * 1000 * 1000)
+#define SOC_ADC_SAMPLE_FREQ_THRES_LOW  (20 * 1000)
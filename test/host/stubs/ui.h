@@ -0,0 +1,3 @@
+/* Host stand-in for the SquareLine screen objects; only the LVGL types are needed. */
+#pragma once
+#include "lvgl.h"
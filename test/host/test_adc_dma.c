@@ -0,0 +1,197 @@
+/**
+* @file test_adc_dma.c
+*
+* @brief DMA acquisition: synthetic conversion results go through the stub continuous driver in host_stubs.c,
+*        the reader's parse and the ping-pong frames. Checks the samples and timestamps of delivered frames,
+*        the frames dropped while the consumer holds one, a lost conversion, a pool overflow, and the rate the
+*        frame path keeps up with.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "host_stubs.h"
+/* The module itself, for the parse the reader task runs. */
+#include "adc_dma.c"
+
+//---------------------------------- MACROS -----------------------------------
+#define CHANNELS      (2U)
+#define SCAN_RATE_HZ  (100000U)
+#define FRAME_SCANS   (256U)
+#define FRAME_BYTES   (FRAME_SCANS * CHANNELS * SOC_ADC_DIGI_RESULT_BYTES)
+#define NO_LOSS       (UINT64_MAX)
+#define BENCH_FRAMES  (20000U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static const adc_dma_config_t config = {
+    .channels = {ADC_CHANNEL_6, ADC_CHANNEL_7},
+    .channel_count = CHANNELS,
+    .scan_rate_hz = SCAN_RATE_HZ,
+    .frame_scans = FRAME_SCANS,
+};
+
+static uint8_t results[ADC_DMA_POOL_SIZE * 2U];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+/* Raw reading of a channel in a scan: the scan number, with the top bit telling the channels apart. */
+static uint32_t _raw(uint64_t scan, uint32_t slot)
+{
+    return (uint32_t)(scan & 0x7FFU) | (slot << 11);
+}
+
+/* TYPE1 results of `scans` scans from `first_scan` on, without conversion number `lost` (counted from there). */
+static uint32_t _results(uint64_t first_scan, uint32_t scans, uint64_t lost)
+{
+    uint32_t length = 0;
+    for(uint64_t conversion = 0; conversion < (uint64_t)scans * CHANNELS; conversion++)
+    {
+        if(lost != conversion)
+        {
+            uint32_t slot = conversion % CHANNELS;
+            adc_digi_output_data_t *output = (adc_digi_output_data_t *)&results[length];
+            output->type1.channel = config.channels[slot];
+            output->type1.data = _raw(first_scan + conversion / CHANNELS, slot);
+            length += SOC_ADC_DIGI_RESULT_BYTES;
+        }
+    }
+    return length;
+}
+
+/* What the reader task does on a conversion done notification. */
+static void _reader(void)
+{
+    static uint8_t result[ADC_DMA_READ_LEN];
+    uint32_t length = 0;
+    if(0U < ulTaskNotifyTake(pdTRUE, portMAX_DELAY))
+    {
+        while(ESP_OK == adc_continuous_read(adc_dma_handle, result, ADC_DMA_READ_LEN, &length, 0))
+        {
+            _adc_dma_parse(result, length);
+        }
+    }
+}
+
+/* The DMA fills the pool a conversion frame at a time, and the reader drains it after each one. */
+static void _acquire(uint32_t length)
+{
+    for(uint32_t offset = 0; offset < length; offset += ADC_DMA_READ_LEN)
+    {
+        uint32_t chunk = (length - offset < ADC_DMA_READ_LEN) ? length - offset : ADC_DMA_READ_LEN;
+        host_adc_continuous_feed(&results[offset], chunk);
+        _reader();
+    }
+}
+
+/* Takes a frame and checks it holds the scans from `first_scan` on, except `skipped`, in millivolts. */
+static bool _take(uint64_t first_scan, uint64_t skipped, int64_t *timestamp_us)
+{
+    adc_dma_frame_t frame;
+    if(!adc_dma_frame_take(&frame, 0))
+    {
+        return false;
+    }
+
+    uint32_t mismatches = 0;
+    uint64_t scan = first_scan;
+    for(uint32_t n = 0; n < frame.scan_count; n++, scan++)
+    {
+        scan += (skipped == scan);
+        for(uint32_t slot = 0; slot < CHANNELS; slot++)
+        {
+            mismatches += (adc_raw_to_voltage((int)_raw(scan, slot)) != frame.samples[n * CHANNELS + slot]);
+        }
+    }
+    *timestamp_us = frame.timestamp_us;
+    return (FRAME_SCANS == frame.scan_count) && (0U == mismatches);
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    adc_dma_stats_t stats;
+    int64_t timestamp_us = 0;
+
+    HOST_CHECK(ADC_INITIALIZATION_SUCCESS == adc_initialize(ADC_TO_USE, ADC_CALIBRATION_ENABLE));
+    adc_dma_config_t slow = config;
+    slow.scan_rate_hz = SOC_ADC_SAMPLE_FREQ_THRES_LOW / CHANNELS - 1U;
+    HOST_CHECK(ADC_INITIALIZATION_FAIL == adc_dma_init(&slow));
+    HOST_CHECK(ADC_INITIALIZATION_SUCCESS == adc_dma_init(&config));
+    HOST_CHECK(ADC_OK == adc_dma_start());
+
+    /* A consumer that keeps up gets every frame, stamped with the time of its first scan. */
+    bool delivered = true;
+    for(uint32_t n = 0; n < 8U; n++)
+    {
+        _acquire(_results((uint64_t)n * FRAME_SCANS, FRAME_SCANS, NO_LOSS));
+        delivered = delivered && _take((uint64_t)n * FRAME_SCANS, NO_LOSS, &timestamp_us);
+        delivered = delivered && (timestamp_us - adc_dma_stats.start_time_us ==
+                                  (int64_t)n * FRAME_SCANS * 1000000 / SCAN_RATE_HZ);
+        adc_dma_frame_release();
+    }
+    adc_dma_get_stats(&stats);
+    printf("consumer keeping up: %u frames delivered, %u dropped\n", stats.frames_delivered, stats.frames_dropped);
+    HOST_CHECK(delivered);
+    HOST_CHECK((8U == stats.frames_delivered) && (0U == stats.frames_dropped));
+    HOST_CHECK(8U * FRAME_SCANS * CHANNELS == stats.samples_delivered);
+
+    /* While the consumer holds a frame, complete frames are dropped and it gets the latest one after release. */
+    _acquire(_results(8U * FRAME_SCANS, FRAME_SCANS, NO_LOSS));
+    HOST_CHECK(_take(8U * FRAME_SCANS, NO_LOSS, &timestamp_us));
+    _acquire(_results(9U * FRAME_SCANS, 5U * FRAME_SCANS, NO_LOSS));
+    HOST_CHECK(!adc_dma_frame_take(&(adc_dma_frame_t){0}, 0));
+    adc_dma_frame_release();
+    _acquire(_results(14U * FRAME_SCANS, FRAME_SCANS, NO_LOSS));
+    HOST_CHECK(_take(14U * FRAME_SCANS, NO_LOSS, &timestamp_us));
+    HOST_CHECK(timestamp_us - adc_dma_stats.start_time_us == (int64_t)14 * FRAME_SCANS * 1000000 / SCAN_RATE_HZ);
+    adc_dma_frame_release();
+    adc_dma_get_stats(&stats);
+    printf("consumer holding a frame: %u frames delivered, %u dropped\n", stats.frames_delivered,
+           stats.frames_dropped);
+    HOST_CHECK((10U == stats.frames_delivered) && (5U == stats.frames_dropped));
+
+    /* A lost conversion costs its scan only: the frame goes on with the next scan, channels still in place. */
+    _acquire(_results(15U * FRAME_SCANS, FRAME_SCANS + 1U, 2U * 100U + 1U));
+    HOST_CHECK(_take(15U * FRAME_SCANS, 15U * FRAME_SCANS + 100U, &timestamp_us));
+    adc_dma_frame_release();
+
+    /* Results that do not fit in the pool are lost and counted. The pool holds frames, of which the consumer
+       gets the first and the rest are dropped, as it does not take it. */
+    HOST_CHECK((ADC_OK == adc_dma_stop()) && (ADC_OK == adc_dma_start()));
+    uint32_t length = _results(0, sizeof(results) / (CHANNELS * SOC_ADC_DIGI_RESULT_BYTES), NO_LOSS);
+    HOST_CHECK(ADC_DMA_POOL_SIZE == host_adc_continuous_feed(results, length));
+    _reader();
+    adc_dma_get_stats(&stats);
+    printf("pool overflow: %u reported, %u frames delivered, %u dropped\n", stats.pool_overflows,
+           stats.frames_delivered, stats.frames_dropped);
+    HOST_CHECK(1U == stats.pool_overflows);
+    HOST_CHECK((1U == stats.frames_delivered) && (ADC_DMA_POOL_SIZE / FRAME_BYTES - 1U == stats.frames_dropped));
+    HOST_CHECK(_take(0, NO_LOSS, &timestamp_us));
+    adc_dma_frame_release();
+
+    /* Nothing is converted while stopped. */
+    HOST_CHECK(ADC_OK == adc_dma_stop());
+    HOST_CHECK(0U == host_adc_continuous_feed(results, FRAME_BYTES));
+
+    /* The whole path per frame: the pool, the parse, the millivolt conversion and the hand-off. */
+    HOST_CHECK(ADC_OK == adc_dma_start());
+    length = _results(0, FRAME_SCANS, NO_LOSS);
+    int64_t start = host_time_ns();
+    for(uint32_t n = 0; n < BENCH_FRAMES; n++)
+    {
+        _acquire(length);
+        adc_dma_frame_take(&(adc_dma_frame_t){0}, 0);
+        adc_dma_frame_release();
+    }
+    double seconds = (double)(host_time_ns() - start) / 1e9;
+    adc_dma_get_stats(&stats);
+    double ksps = stats.samples_delivered / seconds / 1000.0;
+    printf("frame path: %u frames delivered, %u dropped, %.0f kS/s (ADC at most %u kS/s)\n",
+           stats.frames_delivered, stats.frames_dropped, ksps, SOC_ADC_SAMPLE_FREQ_THRES_HIGH / 1000U);
+    HOST_CHECK((BENCH_FRAMES == stats.frames_delivered) && (0U == stats.frames_dropped));
+    HOST_CHECK(ksps > SOC_ADC_SAMPLE_FREQ_THRES_HIGH / 1000U);
+
+    HOST_CHECK(ADC_OK == adc_dma_deinitialize());
+    return host_test_result();
+}
@@ -0,0 +1,116 @@
+/**
+* @file test_average.c
+*
+* @brief Averaging and high resolution acquisition: how much of 30 mV RMS noise is left on a sine, and the cost
+*        of averaging one frame.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_decimation.h"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define COLUMNS        (200U)
+#define NOISE_RMS_MV   (30.0)
+#define AVERAGE_WEIGHT (16U)
+#define AVERAGE_FRAMES (64U)
+#define HIGH_RES_TICKS (25U)    // Ticks per column of the high resolution box filter
+#define BENCH_ROUNDS   (100000U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static int32_t accumulator[COLUMNS];
+static lv_coord_t frame[COLUMNS];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+/* Gaussian noise from the sum of 12 uniform samples. */
+static double _noise_mv(void)
+{
+    double sum = 0.0;
+    for(uint32_t i = 0; i < 12U; i++)
+    {
+        sum += rand() / (double)RAND_MAX;
+    }
+    return (sum - 6.0) * NOISE_RMS_MV;
+}
+
+static double _ideal_mv(uint32_t column)
+{
+    return 1650.0 + 1000.0 * sin(column / 20.0);
+}
+
+static double _rms_error_mv(void)
+{
+    double sum = 0.0;
+    for(uint32_t c = 0; c < COLUMNS; c++)
+    {
+        double error = frame[c] - _ideal_mv(c);
+        sum += error * error;
+    }
+    return sqrt(sum / COLUMNS);
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    srand(12);
+
+    double plain_error = 0.0;
+    for(uint32_t f = 0; f < AVERAGE_FRAMES; f++)
+    {
+        for(uint32_t c = 0; c < COLUMNS; c++)
+        {
+            frame[c] = (lv_coord_t)lrint(_ideal_mv(c) + _noise_mv());
+        }
+        if(0U == f)
+        {
+            plain_error = _rms_error_mv();
+        }
+        oscilloscope_average_update(accumulator, frame, COLUMNS, f, AVERAGE_WEIGHT);
+    }
+    double average_error = _rms_error_mv();
+
+    /* High resolution: every column is the rounded mean of its ticks, as _oscilloscope_decimate() stores it. */
+    for(uint32_t c = 0; c < COLUMNS; c++)
+    {
+        uint32_t sum = 0;
+        for(uint32_t tick = 0; tick < HIGH_RES_TICKS; tick++)
+        {
+            sum += (uint32_t)lrint(_ideal_mv(c) + _noise_mv());
+        }
+        frame[c] = (lv_coord_t)((sum + HIGH_RES_TICKS / 2U) / HIGH_RES_TICKS);
+    }
+    double high_res_error = _rms_error_mv();
+
+    printf("residual noise: single frame %.1f mV, average x%u after %u frames %.1f mV, high res x%u %.1f mV\n",
+           plain_error, AVERAGE_WEIGHT, AVERAGE_FRAMES, average_error, HIGH_RES_TICKS, high_res_error);
+    HOST_CHECK(plain_error > 25.0);
+    HOST_CHECK(average_error < NOISE_RMS_MV / sqrt(AVERAGE_WEIGHT));
+    HOST_CHECK(high_res_error < 1.2 * NOISE_RMS_MV / sqrt(HIGH_RES_TICKS));
+
+    /* Up to the weight the average is the plain mean: two frames 100 mV apart meet in the middle. */
+    for(uint32_t c = 0; c < COLUMNS; c++)
+    {
+        frame[c] = 1000;
+    }
+    oscilloscope_average_update(accumulator, frame, COLUMNS, 0U, AVERAGE_WEIGHT);
+    for(uint32_t c = 0; c < COLUMNS; c++)
+    {
+        frame[c] = 1100;
+    }
+    oscilloscope_average_update(accumulator, frame, COLUMNS, 1U, AVERAGE_WEIGHT);
+    HOST_CHECK((1050 == frame[0]) && (1050 == frame[COLUMNS - 1U]));
+
+    int64_t start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        oscilloscope_average_update(accumulator, frame, COLUMNS, AVERAGE_WEIGHT, AVERAGE_WEIGHT);
+    }
+    printf("averaging one %u column frame: %.0f ns\n", COLUMNS,
+           (double)(host_time_ns() - start) / BENCH_ROUNDS);
+
+    return host_test_result();
+}
@@ -0,0 +1,186 @@
+/**
+* @file test_awg.c
+*
+* @brief Arbitrary waveforms: images uploaded in chunks, stored to and loaded from a directory that stands in
+*        for the storage partition, every kind of invalid image, and the hand-off of a loaded table to the ISR.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "host_stubs.h"
+/* The generator itself, for the table hand-off and the timer callback. */
+#include "waveform_generator.c"
+#include "storage.h"
+#include "esp_rom_crc.h"
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define CHUNK        (1000U)
+#define PATH_LENGTH  (sizeof(STORAGE_BASE_PATH) + 16U)
+#define BENCH_ROUNDS (1000U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint8_t image[WAVEFORM_AWG_IMAGE_MAX];
+static uint8_t points[WAVEFORM_AWG_MAX_POINTS];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _field(uint8_t *data, uint32_t value, uint32_t size)
+{
+    for(uint32_t i = 0; i < size; i++)
+    {
+        data[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/* A ramp image of `length` points, in the format of waveform_awg.h. */
+static uint32_t _image(uint32_t length)
+{
+    for(uint32_t i = 0; i < length; i++)
+    {
+        image[WAVEFORM_AWG_HEADER_SIZE + i] = (uint8_t)(28U + (200U * i) / length);
+    }
+    _field(&image[0], WAVEFORM_AWG_MAGIC, 4);
+    _field(&image[4], length, 2);
+    _field(&image[6], 0, 2);
+    _field(&image[8], esp_rom_crc32_le(0, &image[WAVEFORM_AWG_HEADER_SIZE], length), 4);
+    return WAVEFORM_AWG_HEADER_SIZE + length;
+}
+
+/* The file waveform_awg.c keeps a slot in. */
+static void _slot_path(char *path, uint32_t slot)
+{
+    snprintf(path, PATH_LENGTH, STORAGE_BASE_PATH "/awg%02u.bin", (unsigned)slot);
+}
+
+static void _clear_slots(void)
+{
+    char path[PATH_LENGTH];
+    for(uint32_t slot = 0; slot < WAVEFORM_AWG_SLOTS; slot++)
+    {
+        _slot_path(path, slot);
+        remove(path);
+    }
+}
+
+/* Selects a slot on a running output and runs the ISR until it takes the table over. */
+static bool _play(uint32_t slot, uint32_t *samples)
+{
+    waveform_generator[DAC_CHANNEL_TO_USE].waveform = WAVEFORM_ARBITRARY;
+    awg_slot = slot;
+    awg_reload = true;
+    if(ESP_OK != _genarate_waveform(DAC_CHANNEL_TO_USE, true))
+    {
+        return false;
+    }
+
+    bool boundary = false;
+    for(*samples = 0; table_pending && (*samples < SAMPLE_RATE_HZ); (*samples)++)
+    {
+        uint32_t previous = phase;
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+        boundary = (phase < previous);
+    }
+    return boundary && !table_pending;
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    uint32_t length = 0;
+    storage_mount();
+    _clear_slots();
+
+    /* A full size image in chunks, as it arrives over MQTT. */
+    uint32_t size = _image(WAVEFORM_AWG_MAX_POINTS);
+    esp_err_t err = ESP_OK;
+    for(uint32_t offset = 0; offset < size; offset += CHUNK)
+    {
+        uint32_t chunk = (size - offset < CHUNK) ? size - offset : CHUNK;
+        err = (ESP_OK == err) ? waveform_awg_receive(3U, offset, &image[offset], chunk, size) : err;
+    }
+    HOST_CHECK(ESP_OK == err);
+    HOST_CHECK(ESP_OK == waveform_awg_load(3U, points, &length));
+    HOST_CHECK(WAVEFORM_AWG_MAX_POINTS == length);
+    HOST_CHECK(0 == memcmp(points, &image[WAVEFORM_AWG_HEADER_SIZE], WAVEFORM_AWG_MAX_POINTS));
+    HOST_CHECK(ESP_ERR_NOT_FOUND == waveform_awg_load(5U, points, &length));
+
+    /* Invalid images are refused before anything is written. */
+    image[100] ^= 1U;
+    HOST_CHECK(ESP_ERR_INVALID_ARG == waveform_awg_store(1U, image, size));
+    image[100] ^= 1U;
+    HOST_CHECK(!waveform_awg_validate(image, size - 1U));
+    image[5] ^= 0x20U;
+    HOST_CHECK(!waveform_awg_validate(image, size));
+    image[5] ^= 0x20U;
+    HOST_CHECK(waveform_awg_validate(image, size));
+    HOST_CHECK(ESP_ERR_INVALID_ARG == waveform_awg_receive(2U, 500U, image, 10U, size));
+    HOST_CHECK(ESP_ERR_NOT_FOUND == waveform_awg_load(1U, points, &length));
+
+    /* A file damaged on flash fails its CRC when loaded. */
+    char path[PATH_LENGTH];
+    _slot_path(path, 3U);
+    FILE *file = fopen(path, "r+b");
+    HOST_CHECK(NULL != file);
+    if(NULL != file)
+    {
+        fseek(file, 2000, SEEK_SET);
+        fputc(7, file);
+        fclose(file);
+    }
+    HOST_CHECK(ESP_FAIL == waveform_awg_load(3U, points, &length));
+
+    size = _image(WAVEFORM_AWG_MIN_POINTS);
+    HOST_CHECK(ESP_OK == waveform_awg_store(2U, image, size));
+    int64_t start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        waveform_awg_load(2U, points, &length);
+    }
+    double min_us = (double)(host_time_ns() - start) / BENCH_ROUNDS / 1000.0;
+    size = _image(WAVEFORM_AWG_MAX_POINTS);
+    HOST_CHECK(ESP_OK == waveform_awg_store(4U, image, size));
+    start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        waveform_awg_load(4U, points, &length);
+    }
+    double max_us = (double)(host_time_ns() - start) / BENCH_ROUNDS / 1000.0;
+    printf("loading a slot from the host file system: %.1f us for %u points, %.1f us for %u\n", min_us,
+           WAVEFORM_AWG_MIN_POINTS, max_us, WAVEFORM_AWG_MAX_POINTS);
+
+    /* A running sine hands over to the stored tables at a period boundary, at their own length. */
+    waveform_generator[DAC_CHANNEL_TO_USE].waveform = WAVEFORM_SINE;
+    waveform_generator[DAC_CHANNEL_TO_USE].frequency = 1000U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, false));
+    for(uint32_t i = 0; i < 37U; i++)
+    {
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+    }
+
+    uint32_t samples = 0;
+    size = _image(1000U);
+    HOST_CHECK(ESP_OK == waveform_awg_store(6U, image, size));
+    HOST_CHECK(_play(6U, &samples));
+    printf("1000 point table taken over at a period boundary after %u samples\n", samples);
+    uint32_t first = ((uint64_t)phase * 1000U) >> 32;
+    HOST_CHECK((1000U == table_front.length) && (image[WAVEFORM_AWG_HEADER_SIZE + first] == host_dac_value));
+    HOST_CHECK(first < 1000U / (SAMPLE_RATE_HZ / 1000U));
+
+    size = _image(4000U);
+    HOST_CHECK(ESP_OK == waveform_awg_store(7U, image, size));
+    HOST_CHECK(_play(7U, &samples));
+    uint32_t last_index = 0;
+    for(uint32_t i = 0; i < SAMPLE_RATE_HZ / 1000U; i++)
+    {
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+        uint32_t index = ((uint64_t)phase * table_front.length) >> 32;
+        last_index = (index > last_index) ? index : last_index;
+    }
+    printf("4000 point table indexed up to point %u\n", last_index);
+    HOST_CHECK((4000U == table_front.length) && (last_index >= 4000U - 4000U / (SAMPLE_RATE_HZ / 1000U)));
+
+    return host_test_result();
+}
@@ -0,0 +1,141 @@
+/**
+* @file test_ets.c
+*
+* @brief Equivalent-time sampling: a 10 kHz sine sampled at 100 kS/s with a random trigger phase is rebuilt at
+*        2 us per column, the same way the sampler places every acquisition. Reports how many acquisitions
+*        fill the frame and the error against the ideal waveform.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_ets.h"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define SIGNAL_HZ          (10000.0)
+#define LEVEL_MV           (1650)
+#define SAMPLE_PERIOD_NS   (10000U)    // 100 kS/s scan
+#define COLUMN_NS          (2000U)     // Fastest timebase divided by OSCILLOSCOPE_ETS_FACTOR
+#define PRE_TRIGGER_PCT    (50U)
+#define CAPTURE_POINTS     (OSCILLOSCOPE_ETS_COLUMNS * COLUMN_NS / SAMPLE_PERIOD_NS + 1U)
+#define PRE_TRIGGER_POINTS (CAPTURE_POINTS / 2U)
+#define MAX_ACQUISITIONS   (64U)       // OSCILLOSCOPE_ETS_MAX_ACQUISITIONS
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static oscilloscope_ets_t ets;
+static uint16_t capture[CAPTURE_POINTS];
+static lv_coord_t columns[OSCILLOSCOPE_ETS_COLUMNS];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static double _signal_mv(double t_ns)
+{
+    return LEVEL_MV + 1000.0 * sin(2.0 * M_PI * SIGNAL_HZ * t_ns * 1e-9);
+}
+
+/**
+ * @brief Assemble one frame from acquisitions with a random ADC phase.
+ *
+ * @param[in] interpolate_phase Use the interpolated level crossing, as the sampler does, instead of only the
+ *                              trigger sample.
+ * @param[out] rms_mv RMS error of the frame.
+ * @param[out] max_mv Largest error of the frame.
+ *
+ * @return Number of acquisitions used.
+ */
+static uint32_t _assemble(bool interpolate_phase, double *rms_mv, double *max_mv)
+{
+    uint32_t acquisitions = 0;
+
+    oscilloscope_ets_reset(&ets);
+    while(!oscilloscope_ets_complete(&ets) && (MAX_ACQUISITIONS > acquisitions))
+    {
+        /* Free running scan with a random phase to the signal, triggered on the first rising crossing. */
+        double t_ns = (rand() / (double)RAND_MAX) * 1e6;
+        double previous = _signal_mv(t_ns);
+        for(;;)
+        {
+            t_ns += SAMPLE_PERIOD_NS;
+            double now = _signal_mv(t_ns);
+            if((previous < LEVEL_MV) && (now >= LEVEL_MV))
+            {
+                break;
+            }
+            previous = now;
+        }
+
+        /* Same interpolation as _oscilloscope_trigger_phase(), on the quantised millivolt samples. */
+        int32_t voltage = (int32_t)lrint(_signal_mv(t_ns));
+        int32_t before = (int32_t)lrint(_signal_mv(t_ns - SAMPLE_PERIOD_NS));
+        uint32_t phase_ns = 0;
+        if(interpolate_phase)
+        {
+            phase_ns = (uint32_t)(((int64_t)(voltage - LEVEL_MV) * SAMPLE_PERIOD_NS) / (voltage - before));
+        }
+
+        for(uint32_t n = 0; n < CAPTURE_POINTS; n++)
+        {
+            capture[n] = (uint16_t)lrint(_signal_mv(t_ns + ((int32_t)n - (int32_t)PRE_TRIGGER_POINTS) *
+                                                     (double)SAMPLE_PERIOD_NS));
+        }
+
+        /* Same placement as _oscilloscope_ets_collect(). */
+        int64_t pre_trigger_ns = ((int64_t)COLUMN_NS * OSCILLOSCOPE_ETS_COLUMNS * PRE_TRIGGER_PCT) / 100;
+        int32_t first_offset_ns = (int32_t)(pre_trigger_ns + phase_ns -
+                                            (int64_t)PRE_TRIGGER_POINTS * SAMPLE_PERIOD_NS);
+        oscilloscope_ets_add(&ets, capture, CAPTURE_POINTS, 0U, first_offset_ns, SAMPLE_PERIOD_NS, COLUMN_NS);
+        acquisitions++;
+    }
+
+    /* Column c is centred (c + 0.5) columns after the left edge, which is the pre-trigger time before the
+     * level crossing. */
+    oscilloscope_ets_resolve(&ets, columns);
+    double sum = 0.0;
+    *max_mv = 0.0;
+    for(uint32_t c = 0; c < OSCILLOSCOPE_ETS_COLUMNS; c++)
+    {
+        double t_ns = (c + 0.5) * COLUMN_NS - COLUMN_NS * OSCILLOSCOPE_ETS_COLUMNS * PRE_TRIGGER_PCT / 100.0;
+        double error = fabs(columns[c] - _signal_mv(t_ns));
+        sum += error * error;
+        *max_mv = (error > *max_mv) ? error : *max_mv;
+    }
+    *rms_mv = sqrt(sum / OSCILLOSCOPE_ETS_COLUMNS);
+
+    return acquisitions;
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    double rms_mv;
+    double max_mv;
+    double worst_rms_mv = 0.0;
+    uint32_t most_acquisitions = 0;
+
+    srand(13);
+    for(uint32_t run = 0; run < 20U; run++)
+    {
+        uint32_t acquisitions = _assemble(true, &rms_mv, &max_mv);
+        if(0U == run)
+        {
+            printf("%u acquisitions, %.0f kS/s effective from %.0f kS/s, error %.1f mV RMS, %.1f mV max\n",
+                   acquisitions, 1e6 / COLUMN_NS, 1e6 / SAMPLE_PERIOD_NS, rms_mv, max_mv);
+        }
+        most_acquisitions = (acquisitions > most_acquisitions) ? acquisitions : most_acquisitions;
+        worst_rms_mv = (rms_mv > worst_rms_mv) ? rms_mv : worst_rms_mv;
+    }
+    printf("20 frames: at most %u acquisitions, worst error %.1f mV RMS\n", most_acquisitions, worst_rms_mv);
+
+    /* The slope of this sine is 44 mV/us RMS, so a sample anywhere in a 2 us column is off by 26 mV RMS from the
+     * column centre. The reconstruction can not do much better than that, a misplaced acquisition does worse. */
+    HOST_CHECK(most_acquisitions < MAX_ACQUISITIONS);
+    HOST_CHECK(worst_rms_mv < 35.0);
+
+    _assemble(false, &rms_mv, &max_mv);
+    printf("without the interpolated crossing: %.1f mV RMS, %.1f mV max\n", rms_mv, max_mv);
+    HOST_CHECK(rms_mv > 2.0 * worst_rms_mv);
+
+    return host_test_result();
+}
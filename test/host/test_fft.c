@@ -0,0 +1,98 @@
+/**
+* @file test_fft.c
+*
+* @brief FFT spectrum: a sine reads its level in the right bin for every transform size, a full scale square
+*        pulse train does not overflow, and the cost of one transform. Built with OSCILLOSCOPE_FFT_MAX_POINTS 4096 so
+*        the sizes a PSRAM build can select are covered too.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_fft.h"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define COLUMNS       (200U)
+#define FULL_SCALE_MV (3300.0)
+#define BENCH_ROUNDS  (200U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint16_t samples[OSCILLOSCOPE_FFT_MAX_POINTS];
+static lv_coord_t columns_db[COLUMNS];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+/* Mirrors the column reduction of oscilloscope_fft_spectrum(). */
+static uint32_t _column_of(uint32_t bin, uint32_t points)
+{
+    uint32_t bins = points / 2U;
+    uint32_t c = 0;
+    while(((c + 1U) * bins + COLUMNS - 1U) / COLUMNS <= bin)
+    {
+        c++;
+    }
+    return c;
+}
+
+static lv_coord_t _max_column(void)
+{
+    lv_coord_t max = OSCILLOSCOPE_FFT_DB_FLOOR;
+    for(uint32_t c = 0; c < COLUMNS; c++)
+    {
+        max = (columns_db[c] > max) ? columns_db[c] : max;
+    }
+    return max;
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    oscilloscope_fft_init();
+
+    /* From the smallest size the spectrum view selects. */
+    for(uint32_t points = 256U; points <= OSCILLOSCOPE_FFT_MAX_POINTS; points *= 2U)
+    {
+        /* Sine over half the range, between two bins, where only the flat top window reads the true level. The
+         * display clamps at 0 dBFS, so a full scale sine would hide a gain error. */
+        double cycles = points / 16.0 + 0.3;
+        HOST_CHECK(oscilloscope_fft_configure(OSCILLOSCOPE_FFT_WINDOW_FLAT_TOP, points));
+        for(uint32_t n = 0; n < points; n++)
+        {
+            samples[n] = (uint16_t)lrint(FULL_SCALE_MV / 4.0 * (2.0 + sin(2.0 * M_PI * cycles * n / points)));
+        }
+
+        int64_t start = host_time_ns();
+        uint32_t peak = 0;
+        for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+        {
+            peak = oscilloscope_fft_spectrum(samples, columns_db, COLUMNS);
+        }
+        double us = (double)(host_time_ns() - start) / BENCH_ROUNDS / 1000.0;
+        lv_coord_t sine_db = _max_column();
+
+        /* Full scale pulses, 1/16 duty, 16 periods. The pulses are 3.1 V above the mean, which wraps an input that
+         * only fits a 1650 mV deviation. The fundamental in bin 16 is 2 sin(pi / 16) / pi of full scale, -12.1 dBFS,
+         * and the third harmonic in bin 48 is at most 0.6 dB lower. */
+        for(uint32_t n = 0; n < points; n++)
+        {
+            samples[n] = ((n % (points / 16U)) < (points / 256U)) ? (uint16_t)FULL_SCALE_MV : 0U;
+        }
+        oscilloscope_fft_spectrum(samples, columns_db, COLUMNS);
+        lv_coord_t fundamental_db = columns_db[_column_of(16U, points)];
+        lv_coord_t harmonic_db = columns_db[_column_of(48U, points)];
+
+        printf("%4u points: sine peak bin %u (%.1f), %+.1f dBFS; pulses %+.1f, %+.1f dBFS; %.1f us per spectrum\n",
+               points, peak, cycles, sine_db / 10.0, fundamental_db / 10.0, harmonic_db / 10.0, us);
+        HOST_CHECK(lrint(cycles) == (long)peak);
+        HOST_CHECK((sine_db >= -65) && (sine_db <= -55));
+        HOST_CHECK((fundamental_db >= -126) && (fundamental_db <= -116));
+        HOST_CHECK((harmonic_db >= -130) && (harmonic_db <= -116));
+    }
+
+    HOST_CHECK(!oscilloscope_fft_configure(OSCILLOSCOPE_FFT_WINDOW_HANN, OSCILLOSCOPE_FFT_MAX_POINTS * 2U));
+    HOST_CHECK(!oscilloscope_fft_configure(OSCILLOSCOPE_FFT_WINDOW_HANN, 1000U));
+
+    return host_test_result();
+}
@@ -0,0 +1,165 @@
+/**
+* @file test_filter.c
+*
+* @brief Streaming filters: every filter type against a double precision run of the same design, block against
+*        per-sample processing, the 50 Hz notch depth and the cost per sample.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_filter.h"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define SAMPLES      (20000U)
+#define Q30          (1073741824.0)
+#define Q15          (32768.0)
+#define MAX_ERROR_MV (1.0)      // Output rounding is 0.5 mV, the rest is coefficient and state quantisation
+
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    const char *name;
+    oscilloscope_filter_config_t config;
+    uint32_t sample_rate_hz;
+} filter_case_t;
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static const filter_case_t filter_cases[] = {
+    {"IIR LP 1k@10k", {OSCILLOSCOPE_FILTER_LOWPASS, OSCILLOSCOPE_FILTER_IIR, 1000U, 0U}, 10000U},
+    {"IIR LP 100@100k", {OSCILLOSCOPE_FILTER_LOWPASS, OSCILLOSCOPE_FILTER_IIR, 100U, 0U}, 100000U},
+    {"IIR HP 1k@10k", {OSCILLOSCOPE_FILTER_HIGHPASS, OSCILLOSCOPE_FILTER_IIR, 1000U, 0U}, 10000U},
+    {"IIR BP 2k@20k", {OSCILLOSCOPE_FILTER_BANDPASS, OSCILLOSCOPE_FILTER_IIR, 2000U, 1000U}, 20000U},
+    {"notch 50@5k", {OSCILLOSCOPE_FILTER_NOTCH_50HZ, OSCILLOSCOPE_FILTER_IIR, 50U, 0U}, 5000U},
+    {"FIR LP 1k@10k", {OSCILLOSCOPE_FILTER_LOWPASS, OSCILLOSCOPE_FILTER_FIR, 1000U, 0U}, 10000U},
+    {"FIR HP 1k@10k", {OSCILLOSCOPE_FILTER_HIGHPASS, OSCILLOSCOPE_FILTER_FIR, 1000U, 0U}, 10000U},
+    {"FIR BP 2k@20k", {OSCILLOSCOPE_FILTER_BANDPASS, OSCILLOSCOPE_FILTER_FIR, 2000U, 1000U}, 20000U},
+};
+
+static uint16_t input[SAMPLES];
+static uint16_t output[SAMPLES];
+static double reference[SAMPLES];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static double _clamp_mv(double v)
+{
+    return fmin(OSCILLOSCOPE_FILTER_MAX_MV, fmax(0.0, v));
+}
+
+/* The designed filter run in double precision from its quantised coefficients, primed the same way. */
+static void _reference(const oscilloscope_filter_t *filter)
+{
+    if(filter->fir)
+    {
+        for(uint32_t n = 0; n < SAMPLES; n++)
+        {
+            double sum = 0.0;
+            for(uint32_t k = 0; k < OSCILLOSCOPE_FILTER_FIR_TAPS; k++)
+            {
+                sum += filter->fir_coefficient[k] / Q15 * input[(n >= k) ? n - k : 0U];
+            }
+            reference[n] = _clamp_mv(sum + filter->offset_mv);
+        }
+        return;
+    }
+
+    double state[OSCILLOSCOPE_FILTER_SECTIONS][4];
+    double x = input[0];
+    for(uint32_t s = 0; s < filter->sections; s++)
+    {
+        const oscilloscope_biquad_t *b = &filter->biquad[s];
+        double gain = (b->b0 + b->b1 + b->b2) / Q30 / (1.0 + (b->a1 + b->a2) / Q30);
+        state[s][0] = state[s][1] = x;
+        x *= gain;
+        state[s][2] = state[s][3] = x;
+    }
+
+    for(uint32_t n = 0; n < SAMPLES; n++)
+    {
+        x = input[n];
+        for(uint32_t s = 0; s < filter->sections; s++)
+        {
+            const oscilloscope_biquad_t *b = &filter->biquad[s];
+            double y = (b->b0 * x + b->b1 * state[s][0] + b->b2 * state[s][1] - b->a1 * state[s][2] -
+                        b->a2 * state[s][3]) / Q30;
+            state[s][1] = state[s][0];
+            state[s][0] = x;
+            state[s][3] = state[s][2];
+            state[s][2] = y;
+            x = y;
+        }
+        reference[n] = _clamp_mv(x + filter->offset_mv);
+    }
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    srand(18);
+
+    for(uint32_t i = 0; i < sizeof(filter_cases) / sizeof(filter_cases[0]); i++)
+    {
+        const filter_case_t *test = &filter_cases[i];
+        oscilloscope_filter_t filter;
+        HOST_CHECK(oscilloscope_filter_design(&filter, &test->config, test->sample_rate_hz));
+
+        /* Tones below and above the cutoff, mains hum and +/-20 mV of noise. */
+        double f = test->config.frequency_hz;
+        for(uint32_t n = 0; n < SAMPLES; n++)
+        {
+            double t = (double)n / test->sample_rate_hz;
+            double v = 1650.0 + 800.0 * sin(2.0 * M_PI * 0.7 * f * t) + 500.0 * sin(2.0 * M_PI * 2.3 * f * t) +
+                       300.0 * sin(2.0 * M_PI * 50.0 * t) + (rand() % 41) - 20;
+            input[n] = (uint16_t)_clamp_mv(v);
+        }
+
+        _reference(&filter);
+        oscilloscope_filter_t stream = filter;
+
+        int64_t start = host_time_ns();
+        oscilloscope_filter_block(&filter, input, output, SAMPLES);
+        double ns = (double)(host_time_ns() - start) / SAMPLES;
+
+        double max_error = 0.0;
+        uint32_t differences = 0;
+        for(uint32_t n = 0; n < SAMPLES; n++)
+        {
+            double error = fabs(output[n] - reference[n]);
+            max_error = (error > max_error) ? error : max_error;
+            differences += (oscilloscope_filter_sample(&stream, input[n]) != output[n]);
+        }
+
+        printf("%-16s %5.1f ns per sample, max error against double %.2f mV, block/stream differences %u\n",
+               test->name, ns, max_error, differences);
+        HOST_CHECK(max_error <= MAX_ERROR_MV);
+        HOST_CHECK(0U == differences);
+    }
+
+    /* Depth of the notch on a 1000 mV, 50 Hz tone, after it settles. */
+    oscilloscope_filter_t notch;
+    oscilloscope_filter_config_t notch_config = {OSCILLOSCOPE_FILTER_NOTCH_50HZ, OSCILLOSCOPE_FILTER_IIR, 0U, 0U};
+    oscilloscope_filter_design(&notch, &notch_config, 5000U);
+    double residual = 0.0;
+    for(uint32_t n = 0; n < SAMPLES; n++)
+    {
+        uint16_t tone = (uint16_t)lrint(1650.0 + 1000.0 * sin(2.0 * M_PI * n / 100.0));
+        uint16_t out = oscilloscope_filter_sample(&notch, tone);
+        if(n > SAMPLES / 2U)
+        {
+            residual = fmax(residual, fabs(out - 1650.0));
+        }
+    }
+    printf("50 Hz notch leaves %.0f mV of a 1000 mV tone\n", residual);
+    HOST_CHECK(residual <= 2.0);
+
+    /* Above 0.45 of the sample rate the filter is bypassed. */
+    oscilloscope_filter_t bypass;
+    oscilloscope_filter_config_t high = {OSCILLOSCOPE_FILTER_LOWPASS, OSCILLOSCOPE_FILTER_IIR, 6000U, 0U};
+    HOST_CHECK(!oscilloscope_filter_design(&bypass, &high, 10000U));
+    HOST_CHECK(1234U == oscilloscope_filter_sample(&bypass, 1234U));
+
+    return host_test_result();
+}
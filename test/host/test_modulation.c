@@ -0,0 +1,123 @@
+/**
+* @file test_modulation.c
+*
+* @brief AM, FM and PWM by the internal modulating waveform: the output ISR runs a 1 kHz carrier and the test
+*        measures the envelope, the frequency and the duty it produces, and the cost of a sample.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "host_stubs.h"
+/* The module itself, for the timer callback and its phase. */
+#include "waveform_generator.c"
+
+//---------------------------------- MACROS -----------------------------------
+#define CARRIER_HZ       (1000U)
+#define PERIOD_SAMPLES   (SAMPLE_RATE_HZ / CARRIER_HZ)
+#define HZ_PER_INCREMENT (SAMPLE_RATE_HZ / 4294967296.0)
+#define BENCH_SAMPLES    (10000000U)
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _delay_hook(void)
+{
+    _on_timer_alarm_cb(NULL, NULL, NULL);
+}
+
+/* Starts the output, as START does with the modulation of a preset. */
+static void _start(waveform_t waveform, waveform_modulation_t modulation, waveform_modulation_shape_t shape,
+                   uint32_t rate, uint32_t depth)
+{
+    waveform_generator_t *generator = &waveform_generator[DAC_CHANNEL_TO_USE];
+    generator->waveform = waveform;
+    generator->frequency = CARRIER_HZ;
+    generator->amplitude_mv = 3300U;
+    generator->duty_cycle_percentage = 50U;
+    waveform_generator_set_modulation_source(DAC_CHANNEL_TO_USE, shape, rate);
+    waveform_generator_set_modulation(DAC_CHANNEL_TO_USE, modulation, depth);
+    _genarate_waveform(DAC_CHANNEL_TO_USE, false);
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    host_task_delay_hook = _delay_hook;
+
+    /* AM: peak-to-peak of every carrier period, from the top of the modulating sine to its bottom. */
+    _start(WAVEFORM_SINE, WAVEFORM_MODULATION_AM, WAVEFORM_MODULATION_SHAPE_SINE, 5U, 50U);
+    int32_t smallest = 255;
+    int32_t largest = 0;
+    for(uint32_t period = 0; period < 200U; period++)
+    {
+        int32_t low = 255;
+        int32_t high = 0;
+        for(uint32_t i = 0; i < PERIOD_SAMPLES; i++)
+        {
+            _on_timer_alarm_cb(NULL, NULL, NULL);
+            low = (host_dac_value < low) ? host_dac_value : low;
+            high = (host_dac_value > high) ? host_dac_value : high;
+        }
+        smallest = (high - low < smallest) ? high - low : smallest;
+        largest = (high - low > largest) ? high - low : largest;
+    }
+    double envelope = (double)smallest / largest;
+    printf("AM 50%%: carrier peak-to-peak %d to %d codes, %.3f\n", smallest, largest, envelope);
+    HOST_CHECK(fabs(envelope - 0.5) < 0.02);
+
+    /* FM: frequency of every sample over one period of a 2 Hz triangle. */
+    _start(WAVEFORM_SINE, WAVEFORM_MODULATION_FM, WAVEFORM_MODULATION_SHAPE_TRIANGLE, 2U, 20U);
+    double lowest_hz = 1e9;
+    double highest_hz = 0.0;
+    uint32_t previous = phase;
+    for(uint32_t i = 0; i < SAMPLE_RATE_HZ / 2U; i++)
+    {
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+        double hz = (uint32_t)(phase - previous) * HZ_PER_INCREMENT;
+        previous = phase;
+        lowest_hz = fmin(lowest_hz, hz);
+        highest_hz = fmax(highest_hz, hz);
+    }
+    printf("FM 20%%: %.1f to %.1f Hz\n", lowest_hz, highest_hz);
+    HOST_CHECK((fabs(lowest_hz - 0.8 * CARRIER_HZ) < 1.0) && (fabs(highest_hz - 1.2 * CARRIER_HZ) < 1.0));
+
+    /* PWM: the high part of every carrier period over one period of a 1 Hz sine. */
+    _start(WAVEFORM_SQUARE, WAVEFORM_MODULATION_PWM, WAVEFORM_MODULATION_SHAPE_SINE, 1U, 30U);
+    double lowest_duty = 1.0;
+    double highest_duty = 0.0;
+    uint32_t high = 0;
+    for(uint32_t i = 0; i < SAMPLE_RATE_HZ; i++)
+    {
+        uint32_t before = phase;
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+        if(phase < before)
+        {
+            lowest_duty = fmin(lowest_duty, (double)high / PERIOD_SAMPLES);
+            highest_duty = fmax(highest_duty, (double)high / PERIOD_SAMPLES);
+            high = 0;
+        }
+        high += (0U != host_dac_value);
+    }
+    printf("PWM 50%% +/-30: duty %.2f to %.2f\n", lowest_duty, highest_duty);
+    HOST_CHECK((fabs(lowest_duty - 0.2) <= 0.01) && (fabs(highest_duty - 0.8) <= 0.01));
+
+    const waveform_modulation_t modulations[] = {WAVEFORM_MODULATION_OFF, WAVEFORM_MODULATION_AM,
+                                                 WAVEFORM_MODULATION_FM, WAVEFORM_MODULATION_PWM};
+    const char *names[] = {"off", "AM", "FM", "PWM"};
+    printf("ns per sample:");
+    for(uint32_t i = 0; i < sizeof(modulations) / sizeof(modulations[0]); i++)
+    {
+        waveform_t waveform = (WAVEFORM_MODULATION_PWM == modulations[i]) ? WAVEFORM_SQUARE : WAVEFORM_SINE;
+        _start(waveform, modulations[i], WAVEFORM_MODULATION_SHAPE_SINE, 5U, 40U);
+        int64_t start = host_time_ns();
+        for(uint32_t n = 0; n < BENCH_SAMPLES; n++)
+        {
+            _on_timer_alarm_cb(NULL, NULL, NULL);
+        }
+        printf(" %s %.1f", names[i], (double)(host_time_ns() - start) / BENCH_SAMPLES);
+    }
+    printf("\n");
+
+    return host_test_result();
+}
@@ -0,0 +1,151 @@
+/**
+* @file test_persistence.c
+*
+* @brief Persistence image: fading matches a per-pixel reference, edges stay connected, hits saturate, how long
+*        a single hit stays visible, and the cost of accumulating and fading.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_persistence.h"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define WIDTH         (200U)
+#define HEIGHT        (110U)
+#define PIXELS        (WIDTH * HEIGHT)
+#define CAPTURE       (1000U)
+#define FADE_SHORT    (192U)    // PERSISTENCE_FADE_SHORT, x/256 per frame
+#define FADE_LONG     (243U)    // PERSISTENCE_FADE_LONG
+#define BENCH_ROUNDS  (1000U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint32_t memory[PIXELS / 4U];
+static uint8_t reference[PIXELS];
+static uint16_t capture[CAPTURE];
+static oscilloscope_persistence_buffer_t image;
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint8_t *_pixels(void)
+{
+    return (uint8_t *)memory;
+}
+
+static uint32_t _lit_pixels(void)
+{
+    uint32_t lit = 0;
+    for(uint32_t i = 0; i < PIXELS; i++)
+    {
+        lit += (0U != _pixels()[i]);
+    }
+    return lit;
+}
+
+static double _accumulate_ns_per_sample(void)
+{
+    int64_t start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        oscilloscope_persistence_accumulate(&image, capture, CAPTURE, 0U);
+    }
+    return (double)(host_time_ns() - start) / ((double)BENCH_ROUNDS * CAPTURE);
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    oscilloscope_persistence_configure(&image, _pixels(), WIDTH, HEIGHT, 0, 3300);
+
+    /* Fading four pixels per word gives the same bytes as fading every pixel on its own. */
+    uint32_t mismatches = 0;
+    for(uint32_t i = 0; i < PIXELS; i++)
+    {
+        _pixels()[i] = (uint8_t)(i * 37U);
+        reference[i] = (uint8_t)((_pixels()[i] * FADE_SHORT) >> 8);
+    }
+    oscilloscope_persistence_fade(&image, OSCILLOSCOPE_PERSISTENCE_SHORT);
+    for(uint32_t i = 0; i < PIXELS; i++)
+    {
+        mismatches += (reference[i] != _pixels()[i]);
+        reference[i] = (uint8_t)((_pixels()[i] * FADE_LONG) >> 8);
+    }
+    oscilloscope_persistence_fade(&image, OSCILLOSCOPE_PERSISTENCE_LONG);
+    for(uint32_t i = 0; i < PIXELS; i++)
+    {
+        mismatches += (reference[i] != _pixels()[i]);
+    }
+    printf("fade against per-pixel reference: %u mismatches\n", mismatches);
+    HOST_CHECK(0U == mismatches);
+
+    /* A step inside one column lights every row between the two levels. */
+    oscilloscope_persistence_clear(&image);
+    const uint16_t step[4] = {300U, 300U, 3000U, 3000U};
+    oscilloscope_persistence_accumulate(&image, step, 4U, 0U);
+    uint32_t low_row = (uint32_t)lrint((3300.0 - 300.0) * (HEIGHT - 1U) / 3300.0);
+    uint32_t high_row = (uint32_t)lrint((3300.0 - 3000.0) * (HEIGHT - 1U) / 3300.0);
+    uint32_t gaps = 0;
+    for(uint32_t row = high_row + 1U; row < low_row; row++)
+    {
+        bool lit = false;
+        for(uint32_t column = 0; column < WIDTH; column++)
+        {
+            lit = lit || (0U != _pixels()[row * WIDTH + column]);
+        }
+        gaps += !lit;
+    }
+    printf("step from 300 to 3000 mV: %u unlit rows between the levels, %u pixels lit\n", gaps, _lit_pixels());
+    HOST_CHECK(0U == gaps);
+
+    /* Hits saturate instead of wrapping. */
+    oscilloscope_persistence_clear(&image);
+    const uint16_t flat[2] = {1650U, 1650U};
+    for(uint32_t i = 0; i < 20U; i++)
+    {
+        oscilloscope_persistence_accumulate(&image, flat, 2U, 0U);
+    }
+    uint8_t saturated = 0;
+    for(uint32_t i = 0; i < PIXELS; i++)
+    {
+        saturated = (_pixels()[i] > saturated) ? _pixels()[i] : saturated;
+    }
+    HOST_CHECK(255U == saturated);
+
+    /* One hit fades below visibility after a number of frames. */
+    oscilloscope_persistence_clear(&image);
+    const uint16_t glitch[2] = {3300U, 3300U};
+    oscilloscope_persistence_accumulate(&image, glitch, 2U, 0U);
+    uint32_t frames = 0;
+    while((0U != _lit_pixels()) && (1000U > frames))
+    {
+        oscilloscope_persistence_fade(&image, OSCILLOSCOPE_PERSISTENCE_LONG);
+        frames++;
+    }
+    printf("a single hit stays visible for %u frames in long persistence\n", frames);
+    HOST_CHECK((frames >= 20U) && (frames <= 40U));
+
+    for(uint32_t n = 0; n < CAPTURE; n++)
+    {
+        capture[n] = ((n / 100U) % 2U) ? 3000U : 300U;
+    }
+    double square_ns = _accumulate_ns_per_sample();
+    for(uint32_t n = 0; n < CAPTURE; n++)
+    {
+        capture[n] = (uint16_t)lrint(1650.0 + 1500.0 * sin(n * 0.05));
+    }
+    double sine_ns = _accumulate_ns_per_sample();
+
+    int64_t start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        oscilloscope_persistence_fade(&image, OSCILLOSCOPE_PERSISTENCE_LONG);
+    }
+    double fade_us = (double)(host_time_ns() - start) / BENCH_ROUNDS / 1000.0;
+
+    printf("accumulate %.1f ns per sample (square), %.1f ns (sine); fade %ux%u %.1f us per frame\n", square_ns,
+           sine_ns, WIDTH, HEIGHT, fade_us);
+
+    return host_test_result();
+}
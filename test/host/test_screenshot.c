@@ -0,0 +1,197 @@
+/**
+* @file test_screenshot.c
+*
+* @brief Screenshot format: screenshots decode bit-exact, truncated and corrupt input is refused, and the size
+*        and codec time stay at the figures measured when the format was introduced.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_screenshot.h"
+#include <math.h>
+#include <string.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define RAW_CHANNEL_SIZE  (OSCILLOSCOPE_SCREENSHOT_COLUMNS * sizeof(lv_coord_t))
+#define CHANNEL_HEADER    (10U)
+#define BENCH_ROUNDS      (4000U)
+#define BENCH_RUNS        (10U)
+
+/* Measured on the host with the format: sine + square on 2 channels, and DC on 1. */
+#define MEASURED_SIZE      (435U)  // 1.84x smaller than the 800 raw bytes
+#define MEASURED_DC_SIZE   (32U)
+#define MEASURED_ENCODE_US (0.7)
+#define MEASURED_DECODE_US (1.6)
+#define TIMING_MARGIN      (1.5)   // Host timings vary with load, a slower codec still fails
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static oscilloscope_screenshot_t screenshot;
+static oscilloscope_screenshot_t decoded;
+static uint8_t buffer[OSCILLOSCOPE_SCREENSHOT_ENCODED_MAX];
+static uint8_t corrupt[OSCILLOSCOPE_SCREENSHOT_ENCODED_MAX + 1U];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+/* Every field of `decoded` equals `screenshot`, stored channels column by column and the others empty. */
+static bool _same(void)
+{
+    bool same = (decoded.sequence == screenshot.sequence) && (decoded.channel_mask == screenshot.channel_mask) &&
+                (decoded.acquisition == screenshot.acquisition) &&
+                (decoded.chart_min_mv == screenshot.chart_min_mv) &&
+                (decoded.chart_max_mv == screenshot.chart_max_mv);
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        bool stored = (0 != (screenshot.channel_mask & (1U << i)));
+        same = same && (decoded.sampling_rate[i] == (stored ? screenshot.sampling_rate[i] : 0U));
+        same = same && (decoded.column_ns[i] == (stored ? screenshot.column_ns[i] : 0U));
+        for(uint32_t c = 0; c < OSCILLOSCOPE_SCREENSHOT_COLUMNS; c++)
+        {
+            same = same && (decoded.column[i][c] == (stored ? screenshot.column[i][c] : LV_CHART_POINT_NONE));
+        }
+    }
+    return same;
+}
+
+/* Encodes, decodes and compares. Every truncation of the encoded screenshot must be refused. */
+static size_t _round_trip(const char *name)
+{
+    memset(&decoded, 0x5A, sizeof(decoded));
+    size_t length = oscilloscope_screenshot_encode(&screenshot, buffer);
+    bool exact = oscilloscope_screenshot_decode(buffer, length, &decoded) && _same();
+
+    uint32_t accepted = 0;
+    for(size_t truncated = 0; truncated < length; truncated++)
+    {
+        accepted += oscilloscope_screenshot_decode(buffer, truncated, &decoded);
+    }
+
+    uint32_t raw = 0;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        raw += (0 != (screenshot.channel_mask & (1U << i))) ? RAW_CHANNEL_SIZE : 0U;
+    }
+    printf("%-22s %4zu bytes (raw %4u, %5.2fx), %s, %u of %zu truncations accepted\n", name, length, raw,
+           (double)raw / length, exact ? "bit-exact" : "DIFFERENT", accepted, length);
+    HOST_CHECK(exact);
+    HOST_CHECK(0U == accepted);
+    HOST_CHECK(OSCILLOSCOPE_SCREENSHOT_ENCODED_MAX >= length);
+    return length;
+}
+
+/* A copy of the encoded screenshot with `count` bytes from `offset` on replaced. */
+static bool _decode_corrupt(size_t length, size_t offset, const uint8_t *bytes, size_t count)
+{
+    memcpy(corrupt, buffer, length);
+    memcpy(&corrupt[offset], bytes, count);
+    return oscilloscope_screenshot_decode(corrupt, length, &decoded);
+}
+
+static void _header(uint8_t channel_mask)
+{
+    memset(&screenshot, 0, sizeof(screenshot));
+    screenshot.sequence = 7U;
+    screenshot.channel_mask = channel_mask;
+    screenshot.acquisition = OSCILLOSCOPE_ACQUISITION_PEAK_DETECT;
+    screenshot.chart_min_mv = -500;
+    screenshot.chart_max_mv = 3300;
+    for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+    {
+        screenshot.sampling_rate[i] = 1000U * (i + 1U);
+        screenshot.column_ns[i] = 1000000U * (i + 1U);
+    }
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    /* The data of the measurement: a noisy sine and a square. The noise is glibc's rand() sequence. */
+    _header(0x3U);
+    srand(1);
+    for(uint32_t c = 0; c < OSCILLOSCOPE_SCREENSHOT_COLUMNS; c++)
+    {
+        screenshot.column[0][c] = (lv_coord_t)(1650 + 1500 * sin(c * 2 * M_PI / 67) + (rand() % 21 - 10));
+        screenshot.column[1][c] = ((c / 25U) % 2U) ? 3000 : 200;
+    }
+    size_t length = _round_trip("sine + square, 2 ch");
+    HOST_CHECK(MEASURED_SIZE >= length);
+
+    /* Best of several runs, so a run the host scheduler interrupted does not count. */
+    double encode_us = 1e9;
+    double decode_us = 1e9;
+    for(uint32_t run = 0; run < BENCH_RUNS; run++)
+    {
+        int64_t start = host_time_ns();
+        for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+        {
+            oscilloscope_screenshot_encode(&screenshot, buffer);
+        }
+        encode_us = fmin(encode_us, (double)(host_time_ns() - start) / BENCH_ROUNDS / 1000.0);
+        start = host_time_ns();
+        for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+        {
+            oscilloscope_screenshot_decode(buffer, length, &decoded);
+        }
+        decode_us = fmin(decode_us, (double)(host_time_ns() - start) / BENCH_ROUNDS / 1000.0);
+    }
+    printf("encode %.2f us, decode %.2f us (measured %.1f us and %.1f us)\n", encode_us, decode_us,
+           MEASURED_ENCODE_US, MEASURED_DECODE_US);
+    HOST_CHECK(encode_us <= MEASURED_ENCODE_US * TIMING_MARGIN);
+    HOST_CHECK(decode_us <= MEASURED_DECODE_US * TIMING_MARGIN);
+
+    /* Payload length of the first channel one off: the columns end before or after it. */
+    size_t payload_length = OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE + 8U;
+    uint8_t field = buffer[payload_length] + 1U;
+    HOST_CHECK(!_decode_corrupt(length, payload_length, &field, 1U));
+    field -= 2U;
+    HOST_CHECK(!_decode_corrupt(length, payload_length, &field, 1U));
+
+    /* Header fields of another format. */
+    const uint8_t zero[2] = {0, 0};
+    const uint8_t other_version = 2U;
+    HOST_CHECK(!_decode_corrupt(length, 0U, zero, 1U));
+    HOST_CHECK(!_decode_corrupt(length, 4U, &other_version, 1U));
+    HOST_CHECK(!_decode_corrupt(length, 16U, zero, 2U));
+    uint32_t sequence = 0;
+    HOST_CHECK(oscilloscope_screenshot_sequence(buffer, length, &sequence) && (7U == sequence));
+    memcpy(corrupt, buffer, length);
+    corrupt[3] ^= 0x10U;
+    HOST_CHECK(!oscilloscope_screenshot_sequence(corrupt, length, &sequence));
+
+    /* DC on one channel: the first column, then a run of the other 199. */
+    _header(0x1U);
+    for(uint32_t c = 0; c < OSCILLOSCOPE_SCREENSHOT_COLUMNS; c++)
+    {
+        screenshot.column[0][c] = 1650;
+    }
+    length = _round_trip("DC, 1 ch");
+    HOST_CHECK(MEASURED_DC_SIZE == length);
+
+    /* Its payload is 4 bytes: a 2 byte difference token, then a 2 byte run token. */
+    size_t payload = OSCILLOSCOPE_SCREENSHOT_HEADER_SIZE + CHANNEL_HEADER;
+    const uint8_t long_run[2] = {0x8FU, 0x03U};      // 200 columns, one past the end
+    const uint8_t short_run[2] = {0x8BU, 0x03U};     // 198 columns, the payload ends one short
+    const uint8_t endless[4] = {0xFFU, 0xFFU, 0xFFU, 0x7FU};  // A varint longer than any column
+    HOST_CHECK(!_decode_corrupt(length, payload + 2U, long_run, sizeof(long_run)));
+    HOST_CHECK(!_decode_corrupt(length, payload + 2U, short_run, sizeof(short_run)));
+    HOST_CHECK(!_decode_corrupt(length, payload, endless, sizeof(endless)));
+
+    /* A byte after the last column, counted in the payload. */
+    memcpy(corrupt, buffer, length);
+    corrupt[payload_length]++;
+    corrupt[length] = 0;
+    HOST_CHECK(!oscilloscope_screenshot_decode(corrupt, length + 1U, &decoded));
+
+    /* Every channel, empty columns and the largest differences between columns. */
+    _header((1U << OSCILLOSCOPE_CHANNEL_COUNT) - 1U);
+    for(uint32_t c = 0; c < OSCILLOSCOPE_SCREENSHOT_COLUMNS; c++)
+    {
+        screenshot.column[0][c] = (c % 2U) ? INT16_MAX : INT16_MIN;
+        screenshot.column[1][c] = ((c / 10U) % 2U) ? LV_CHART_POINT_NONE : (lv_coord_t)(c * 13U);
+        screenshot.column[2][c] = LV_CHART_POINT_NONE;
+    }
+    _round_trip("extremes, all channels");
+
+    return host_test_result();
+}
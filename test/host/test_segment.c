@@ -0,0 +1,159 @@
+/**
+* @file test_segment.c
+*
+* @brief Segmented memory: a loop that mirrors the sampler's capture, trigger and completion path runs a burst
+*        of pulses through the segment store. Compares re-arming in the same tick with the restart the sampler
+*        used before, and checks what a segment holds.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_segment.h"
+#include "oscilloscope_trigger.h"
+
+//---------------------------------- MACROS -----------------------------------
+#define POINTS        (OSCILLOSCOPE_SEGMENT_POINTS)
+#define PRE_TRIGGER   (POINTS / 2U)
+#define PULSES        (16U)
+#define PULSE_WIDTH   (20U)
+#define PULSE_HIGH_MV (3000U)
+#define PULSE_LOW_MV  (300U)
+#define TICK_US       (10)      // 100 kS/s
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint16_t capture[OSCILLOSCOPE_CHANNEL_COUNT][POINTS];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+/**
+ * @brief Run a sequence of PULSES pulses, `spacing` samples apart.
+ *
+ * @param[in] rearm Re-arm in the tick the segment completes, keeping the circular capture. Otherwise restart
+ *                  the capture and refill the pre-trigger part first, as a normal frame does.
+ * @param[in] spacing Samples from one pulse to the next.
+ * @param[out] store_ns Mean time to store a segment and re-arm.
+ *
+ * @return Segments captured.
+ */
+static uint32_t _run(bool rearm, uint32_t spacing, double *store_ns)
+{
+    oscilloscope_trigger_t trigger;
+    uint32_t index = 0;
+    uint32_t filled = 0;
+    uint32_t post_trigger = 0;
+    bool armed = true;
+    bool triggered = false;
+    int64_t timestamp_us = 0;
+    int64_t store_total_ns = 0;
+    uint32_t stores = 0;
+
+    oscilloscope_segment_reset(PULSES);
+    oscilloscope_trigger_configure(&trigger, OSCILLOSCOPE_TRIGGER_RISING, 1650U, 50U);
+
+    uint32_t samples = POINTS + spacing * PULSES + POINTS;
+    for(uint32_t t = 0; t < samples; t++)
+    {
+        /* Low for one frame, then the pulses. */
+        uint32_t u = t - POINTS;
+        bool high = (t >= POINTS) && ((u % spacing) < PULSE_WIDTH) && ((u / spacing) < PULSES);
+        uint16_t voltage = high ? PULSE_HIGH_MV : PULSE_LOW_MV;
+
+        if(armed && oscilloscope_trigger_process(&trigger, voltage) && (filled >= PRE_TRIGGER))
+        {
+            armed = false;
+            triggered = true;
+            post_trigger = POINTS - PRE_TRIGGER;
+            timestamp_us = (int64_t)t * TICK_US;
+        }
+
+        for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+        {
+            capture[i][index] = (uint16_t)(voltage >> i);
+        }
+        index = (index + 1U) % POINTS;
+        filled = (filled < POINTS) ? filled + 1U : POINTS;
+
+        if(triggered && (0U == --post_trigger))
+        {
+            int64_t start_ns = host_time_ns();
+            const uint16_t *captures[OSCILLOSCOPE_CHANNEL_COUNT];
+            uint32_t starts[OSCILLOSCOPE_CHANNEL_COUNT];
+            for(uint32_t i = 0; i < OSCILLOSCOPE_CHANNEL_COUNT; i++)
+            {
+                captures[i] = capture[i];
+                starts[i] = index;
+            }
+
+            triggered = false;
+            if(oscilloscope_segment_store(captures, starts, timestamp_us))
+            {
+                break;
+            }
+            if(!rearm)
+            {
+                index = 0;
+                filled = 0;
+            }
+            armed = true;
+            store_total_ns += host_time_ns() - start_ns;
+            stores++;
+        }
+    }
+
+    *store_ns = (stores > 0U) ? (double)store_total_ns / stores : 0.0;
+    return oscilloscope_segment_count();
+}
+
+static uint32_t _closest_spacing(bool rearm)
+{
+    double store_ns;
+    for(uint32_t spacing = PULSE_WIDTH + 1U; spacing < 2U * POINTS; spacing++)
+    {
+        if(PULSES == _run(rearm, spacing, &store_ns))
+        {
+            return spacing;
+        }
+    }
+    return 0;
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    HOST_CHECK(oscilloscope_segment_init());
+
+    const uint32_t spacings[] = {150U, 200U, 300U, 1000U};
+    for(uint32_t i = 0; i < sizeof(spacings) / sizeof(spacings[0]); i++)
+    {
+        double rearm_ns;
+        double restart_ns;
+        uint32_t rearm = _run(true, spacings[i], &rearm_ns);
+        uint32_t restart = _run(false, spacings[i], &restart_ns);
+        printf("pulses %4u samples apart: re-arm keeps %2u/%u (%.0f ns per segment), restart keeps %2u/%u\n",
+               spacings[i], rearm, PULSES, rearm_ns, restart, PULSES);
+        HOST_CHECK(PULSES == rearm);
+    }
+
+    uint32_t rearm_spacing = _closest_spacing(true);
+    uint32_t restart_spacing = _closest_spacing(false);
+    printf("every pulse kept down to %u samples apart with re-arm, %u with restart\n", rearm_spacing,
+           restart_spacing);
+    /* Re-arming loses nothing after the post-trigger part, restarting also refills the pre-trigger part. */
+    HOST_CHECK(POINTS - PRE_TRIGGER + 1U == rearm_spacing);
+    HOST_CHECK(restart_spacing >= POINTS);
+
+    /* Every segment has its trigger sample after the pre-trigger part, and its own trigger time. */
+    double store_ns;
+    _run(true, 300U, &store_ns);
+    for(uint32_t segment = 0; segment < PULSES; segment++)
+    {
+        const uint16_t *data = oscilloscope_segment_data(segment, (oscilloscope_channel_id_t)0);
+        HOST_CHECK((PULSE_LOW_MV == data[PRE_TRIGGER - 1U]) && (PULSE_HIGH_MV == data[PRE_TRIGGER]));
+        HOST_CHECK((int64_t)segment * 300 * TICK_US ==
+                   oscilloscope_segment_timestamp_us(segment) - oscilloscope_segment_timestamp_us(0U));
+    }
+
+    return host_test_result();
+}
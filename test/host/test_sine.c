@@ -0,0 +1,104 @@
+/**
+* @file test_sine.c
+*
+* @brief Quarter-wave sine table: every entry against libm, the lookup error over a full period, the generator's
+*        sine table against one built from exact sin(), and the time to build it against the sin() build it
+*        replaced.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+/* The module itself, for _prepare_data(). */
+#include "waveform_generator.c"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define OLD_PERIOD_2_PI (6.2832)     // The constant the sin() build used
+#define DAC_LSB         (127.5)      // Q15 full scale is half the DAC range
+#define BENCH_ROUNDS    (100000U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint8_t table[POINT_ARR_LEN];
+static uint8_t exact[POINT_ARR_LEN];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint32_t _amplitude_dac(void)
+{
+    return (uint32_t)(((float)waveform_generator[DAC_CHANNEL_TO_USE].amplitude_mv / VDD) * AMP_DAC_MAX_VALUE);
+}
+
+/* The sine case of _prepare_data() before the table, with the period constant it used or with 2 pi. */
+static void __attribute__((noinline)) _prepare_sin(uint8_t *data, double period)
+{
+    uint32_t amplitude_dac = _amplitude_dac();
+    for(int i = 0; i < POINT_ARR_LEN; i++)
+    {
+        data[i] = (int)((sin(i * period / POINT_ARR_LEN) + 1) * (double)(amplitude_dac) / 2 + 0.5);
+    }
+}
+
+static void __attribute__((noinline)) _prepare_table(uint8_t *data)
+{
+    _prepare_data(DAC_CHANNEL_TO_USE, data);
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    uint32_t entry_errors = 0;
+    for(uint32_t i = 0; i <= WAVEFORM_SINE_QUARTER; i++)
+    {
+        int32_t expected = (int32_t)lrint(sin(i * M_PI / (2.0 * WAVEFORM_SINE_QUARTER)) * WAVEFORM_SINE_MAX);
+        entry_errors += (expected != waveform_sine_quarter[i]);
+    }
+    printf("quarter table: %u of %u entries differ from round(sin() x %d)\n", entry_errors,
+           WAVEFORM_SINE_QUARTER + 1U, WAVEFORM_SINE_MAX);
+    HOST_CHECK(0U == entry_errors);
+
+    /* Nearest of 1024 steps: at most half a step, pi / 1024, off in phase. */
+    double lookup_error = 0.0;
+    for(uint64_t phase = 0; phase < (1ULL << 32); phase += 997U * 4099U)
+    {
+        double error = fabs(waveform_sine_q15((uint32_t)phase) / (double)WAVEFORM_SINE_MAX -
+                            sin(phase * 2.0 * M_PI / 4294967296.0));
+        lookup_error = fmax(lookup_error, error);
+    }
+    printf("lookup error %.4f, %.2f DAC LSB\n", lookup_error, lookup_error * DAC_LSB);
+    HOST_CHECK(lookup_error <= M_PI / 1024.0);
+
+    waveform_generator[DAC_CHANNEL_TO_USE].waveform = WAVEFORM_SINE;
+    waveform_generator[DAC_CHANNEL_TO_USE].amplitude_mv = 3000U;
+    _prepare_table(table);
+    _prepare_sin(exact, 2.0 * M_PI);
+    uint32_t differences = 0;
+    int32_t largest = 0;
+    for(uint32_t i = 0; i < POINT_ARR_LEN; i++)
+    {
+        int32_t difference = abs((int32_t)table[i] - (int32_t)exact[i]);
+        differences += (0 != difference);
+        largest = (difference > largest) ? difference : largest;
+    }
+    printf("%u-point table: %u points differ from exact sin(), by %d LSB at most\n", POINT_ARR_LEN, differences,
+           largest);
+    HOST_CHECK(1 >= largest);
+
+    int64_t start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        _prepare_sin(exact, OLD_PERIOD_2_PI);
+    }
+    double sin_ns = (double)(host_time_ns() - start) / BENCH_ROUNDS;
+    start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        _prepare_table(table);
+    }
+    double table_ns = (double)(host_time_ns() - start) / BENCH_ROUNDS;
+    printf("building the %u-point sine: %.0f ns with sin(), %.0f ns with the table (%.1fx)\n", POINT_ARR_LEN,
+           sin_ns, table_ns, sin_ns / table_ns);
+
+    return host_test_result();
+}
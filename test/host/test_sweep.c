@@ -0,0 +1,132 @@
+/**
+* @file test_sweep.c
+*
+* @brief Frequency sweep: the output ISR runs linear and log sweeps, up and down, fast and slow. The frequency of
+*        every sample is read from the phase it advanced by and checked at the end and the middle of the sweep,
+*        for its largest change between samples, for phase jumps and for the restart at the start frequency.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "host_stubs.h"
+/* The module itself, for the timer callback and its phase. */
+#include "waveform_generator.c"
+
+//---------------------------------- MACROS -----------------------------------
+#define HZ_PER_INCREMENT (SAMPLE_RATE_HZ / 4294967296.0)
+
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    waveform_sweep_t sweep;
+    uint32_t start_frequency;
+    uint32_t stop_frequency;
+    uint32_t sweep_time_ms;
+    uint32_t dwell_time_ms;
+} sweep_case_t;
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static const sweep_case_t sweep_cases[] = {
+    {WAVEFORM_SWEEP_LINEAR, 1000U, 10000U, MIN_SWEEP_TIME_MS, 10U},
+    {WAVEFORM_SWEEP_LINEAR, 10000U, 1000U, MAX_SWEEP_TIME_MS, 0U},
+    {WAVEFORM_SWEEP_LINEAR, 1000U, 1001U, MAX_SWEEP_TIME_MS, 0U},
+    {WAVEFORM_SWEEP_LOG, 1000U, 10000U, MIN_SWEEP_TIME_MS, 10U},
+    {WAVEFORM_SWEEP_LOG, 10000U, 1000U, MIN_SWEEP_TIME_MS, 0U},
+    {WAVEFORM_SWEEP_LOG, 1000U, 10000U, MAX_SWEEP_TIME_MS, 1000U},
+    {WAVEFORM_SWEEP_LOG, 1000U, 1001U, MAX_SWEEP_TIME_MS, 0U},
+    {WAVEFORM_SWEEP_LOG, 10000U, 9999U, MAX_SWEEP_TIME_MS, 0U},
+};
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _delay_hook(void)
+{
+    _on_timer_alarm_cb(NULL, NULL, NULL);
+}
+
+/* Frequency of one sample, from the phase it advanced by. */
+static double _step_hz(uint32_t *previous)
+{
+    _on_timer_alarm_cb(NULL, NULL, NULL);
+    uint32_t increment = phase - *previous;
+    *previous = phase;
+    return increment * HZ_PER_INCREMENT;
+}
+
+static void _run(const sweep_case_t *test)
+{
+    waveform_generator_t *generator = &waveform_generator[DAC_CHANNEL_TO_USE];
+    generator->waveform = WAVEFORM_SINE;
+    generator->frequency = 3000U;
+    waveform_generator_set_sweep(DAC_CHANNEL_TO_USE, WAVEFORM_SWEEP_OFF, 0U, 0U, 0U, 0U);
+    _genarate_waveform(DAC_CHANNEL_TO_USE, false);
+    for(uint32_t i = 0; i < 1000U; i++)
+    {
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+    }
+
+    /* Set on a running output, as an MQTT command does. */
+    waveform_generator_set_sweep(DAC_CHANNEL_TO_USE, test->sweep, test->start_frequency, test->stop_frequency,
+                                 test->sweep_time_ms, test->dwell_time_ms);
+    _genarate_waveform(DAC_CHANNEL_TO_USE, true);
+
+    double f0 = test->start_frequency;
+    double f1 = test->stop_frequency;
+    uint32_t dwell = test->dwell_time_ms * (SAMPLE_RATE_HZ / 1000U);
+    uint32_t samples = test->sweep_time_ms * (SAMPLE_RATE_HZ / 1000U);
+    uint32_t previous = phase;
+    double last = _step_hz(&previous);
+    double dwell_hz = last;
+    double middle_hz = 0.0;
+    double end_hz = 0.0;
+    double restart_hz = 0.0;
+    double largest_step = 0.0;
+    bool in_range = true;
+    for(uint32_t i = 1; i < dwell + samples + 1000U; i++)
+    {
+        double hz = _step_hz(&previous);
+        /* The first sample after the dwell is one step up, the last one is all steps up. */
+        middle_hz = (dwell + samples / 2U - 1U == i) ? hz : middle_hz;
+        end_hz = (dwell + samples - 1U == i) ? hz : end_hz;
+        restart_hz = (dwell + samples == i) ? hz : restart_hz;
+        if(dwell + samples != i)
+        {
+            largest_step = fmax(largest_step, fabs(hz - last));
+        }
+        /* A phase that jumped, also at the restart, would show as a frequency out of the swept range. */
+        in_range = in_range && (hz > fmin(f0, f1) - 0.01) && (hz < fmax(f0, f1) + 0.01);
+        last = hz;
+    }
+
+    bool linear = (WAVEFORM_SWEEP_LINEAR == test->sweep);
+    double want_middle = linear ? (f0 + f1) / 2.0 : sqrt(f0 * f1);
+    /* Linear: the sweep rate. Log: the rate at the high end, where the frequency changes fastest. */
+    double rate = linear ? fabs(f1 - f0) / samples : fmax(f0, f1) * fabs(log(f1 / f0)) / samples;
+    printf("%-3s %5.0f -> %5.0f Hz in %6u ms: middle %8.2f Hz (want %8.2f), end %.4f%% off, step %.6f Hz/sample"
+           " (rate %.6f)\n", linear ? "lin" : "log", f0, f1, test->sweep_time_ms, middle_hz, want_middle,
+           100.0 * (end_hz - f1) / f1, largest_step, rate);
+
+    HOST_CHECK((0U == dwell) || (fabs(dwell_hz - f0) < 0.01));
+    HOST_CHECK(fabs(end_hz - f1) <= 1e-5 * f1);
+    HOST_CHECK(fabs(middle_hz - want_middle) <= 1e-4 * want_middle);
+    /* Plus two steps of the phase increment, which is coarser than the rate of the slowest sweeps. */
+    HOST_CHECK(largest_step <= 1.001 * rate + 2.0 * HZ_PER_INCREMENT);
+    HOST_CHECK(fabs(restart_hz - f0) < 0.01);
+    HOST_CHECK(in_range);
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    host_task_delay_hook = _delay_hook;
+    waveform_generator[DAC_CHANNEL_TO_USE].amplitude_mv = 3000U;
+
+    for(uint32_t i = 0; i < sizeof(sweep_cases) / sizeof(sweep_cases[0]); i++)
+    {
+        _run(&sweep_cases[i]);
+    }
+
+    return host_test_result();
+}
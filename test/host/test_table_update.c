@@ -0,0 +1,111 @@
+/**
+* @file test_table_update.c
+*
+* @brief Double-buffered waveform tables: an UPDATE waits for the ISR to adopt the previous table, and a START
+*        after an UPDATE and a STOP returns with the new table instead of waiting for a stopped timer.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "host_stubs.h"
+/* The module itself, for the table state and the timer callback. */
+#include "waveform_generator.c"
+
+//---------------------------------- MACROS -----------------------------------
+#define MAX_DELAYS (1000U)      // A waiting task gives up here instead of hanging the test
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint32_t delays = 0;
+static bool timer_running = false;
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+/* A tick of task delay is 125 DAC samples, if the timer runs. */
+static void _delay_hook(void)
+{
+    delays++;
+    for(uint32_t i = 0; timer_running && (i < 125U); i++)
+    {
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+    }
+    if(MAX_DELAYS <= delays)
+    {
+        printf("task still waiting after %u ticks\n", delays);
+        HOST_CHECK(false);
+        exit(host_test_result());
+    }
+}
+
+static uint8_t _peak(void)
+{
+    uint8_t peak = 0;
+    for(uint32_t i = 0; i < table_front.length; i++)
+    {
+        peak = (table_front.data[i] > peak) ? table_front.data[i] : peak;
+    }
+    return peak;
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    waveform_generator_t *generator = &waveform_generator[DAC_CHANNEL_TO_USE];
+    host_task_delay_hook = _delay_hook;
+
+    /* START */
+    generator->waveform = WAVEFORM_SINE;
+    generator->frequency = 1000U;
+    generator->amplitude_mv = 3000U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, false));
+    uint8_t full = _peak();
+    timer_running = true;
+    for(uint32_t i = 0; i < 10U; i++)
+    {
+        _on_timer_alarm_cb(NULL, NULL, NULL);
+    }
+
+    /* UPDATE: published for the next period boundary. */
+    generator->amplitude_mv = 1000U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, true));
+    HOST_CHECK(table_pending);
+
+    /* A second UPDATE before the boundary waits for the ISR to adopt the first one. */
+    generator->amplitude_mv = 2000U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, true));
+    printf("second update waited %u ticks for the period boundary\n", delays);
+    HOST_CHECK((0U < delays) && table_pending);
+
+    /* STOP before the boundary, as the task handles it. */
+    timer_running = false;
+    if(table_pending)
+    {
+        table_front = table_back;
+        table_pending = false;
+    }
+    uint8_t stopped = _peak();
+
+    /* START with new settings returns at once and outputs them from the start of a period. */
+    delays = 0;
+    generator->amplitude_mv = 500U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, false));
+    uint8_t restarted = _peak();
+    printf("peak %u at 3000 mV, %u after the stop, %u after the restart, %u ticks waited\n", full, stopped,
+           restarted, delays);
+    HOST_CHECK(0U == delays);
+    HOST_CHECK(!table_pending && (0U == phase));
+    HOST_CHECK((restarted < stopped) && (stopped < full));
+
+    /* The same restart with a table still pending, as before the STOP adopted it. */
+    timer_running = true;
+    generator->amplitude_mv = 1500U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, true));
+    timer_running = false;
+    HOST_CHECK(table_pending);
+    generator->amplitude_mv = 3000U;
+    HOST_CHECK(ESP_OK == _genarate_waveform(DAC_CHANNEL_TO_USE, false));
+    HOST_CHECK(!table_pending && (full == _peak()));
+
+    return host_test_result();
+}
@@ -0,0 +1,81 @@
+/**
+* @file test_trigger.c
+*
+* @brief Trigger comparator: one trigger per edge of a noisy signal, and the per-sample cost of the comparator.
+*
+* COPYRIGHT NOTICE: (c) 2024 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "host_test.h"
+#include "oscilloscope_trigger.h"
+#include <math.h>
+
+//---------------------------------- MACROS -----------------------------------
+#define SAMPLES       (100000U)
+#define PERIOD        (1000U)   // Samples per period of the test sine
+#define NOISE_MV      (40)      // Peak noise, larger than the distance between two samples on the edge
+#define LEVEL_MV      (1650U)
+#define HYSTERESIS_MV (100U)
+#define BENCH_ROUNDS  (200U)
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static uint16_t signal_mv[SAMPLES];
+
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint32_t _count_triggers(oscilloscope_trigger_type_t type, uint16_t hysteresis)
+{
+    oscilloscope_trigger_t trigger;
+    uint32_t triggers = 0;
+
+    oscilloscope_trigger_configure(&trigger, type, LEVEL_MV, hysteresis);
+    for(uint32_t n = 0; n < SAMPLES; n++)
+    {
+        triggers += oscilloscope_trigger_process(&trigger, signal_mv[n]);
+    }
+    return triggers;
+}
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+int main(void)
+{
+    srand(3);
+    for(uint32_t n = 0; n < SAMPLES; n++)
+    {
+        double v = LEVEL_MV - 1000.0 * cos(2.0 * M_PI * n / PERIOD) + (rand() % (2 * NOISE_MV + 1)) - NOISE_MV;
+        signal_mv[n] = (uint16_t)lrint(v);
+    }
+
+    uint32_t rising = _count_triggers(OSCILLOSCOPE_TRIGGER_RISING, HYSTERESIS_MV);
+    uint32_t falling = _count_triggers(OSCILLOSCOPE_TRIGGER_FALLING, HYSTERESIS_MV);
+    uint32_t rising_bare = _count_triggers(OSCILLOSCOPE_TRIGGER_RISING, 0U);
+    uint32_t high = _count_triggers(OSCILLOSCOPE_TRIGGER_LEVEL_HIGH, HYSTERESIS_MV);
+    uint32_t none = _count_triggers(OSCILLOSCOPE_TRIGGER_NONE, HYSTERESIS_MV);
+    printf("%u periods: rising %u, falling %u, rising without hysteresis %u\n", SAMPLES / PERIOD, rising, falling,
+           rising_bare);
+
+    HOST_CHECK(SAMPLES / PERIOD == rising);
+    HOST_CHECK(SAMPLES / PERIOD == falling);
+    HOST_CHECK(rising_bare > rising);
+    HOST_CHECK((high > SAMPLES * 45U / 100U) && (high < SAMPLES * 55U / 100U));
+    HOST_CHECK(SAMPLES == none);
+
+    oscilloscope_trigger_t trigger;
+    volatile uint32_t sink = 0;
+    oscilloscope_trigger_configure(&trigger, OSCILLOSCOPE_TRIGGER_RISING, LEVEL_MV, HYSTERESIS_MV);
+    int64_t start = host_time_ns();
+    for(uint32_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        uint32_t triggers = 0;
+        for(uint32_t n = 0; n < SAMPLES; n++)
+        {
+            triggers += oscilloscope_trigger_process(&trigger, signal_mv[n]);
+        }
+        sink += triggers;
+    }
+    double ns = (double)(host_time_ns() - start) / ((double)BENCH_ROUNDS * SAMPLES);
+    printf("rising edge comparator: %.2f ns per sample\n", ns);
+
+    return host_test_result();
+}